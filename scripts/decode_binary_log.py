@@ -0,0 +1,158 @@
+# SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+# Converts a binary log (logType = "binary") back into the usual text log.
+# usage: decode_binary_log.py shad_log.bin [output.txt]
+
+import struct
+import sys
+
+MAGIC = b"\x7fSHADLOG"
+STRING_TAG = 1
+MESSAGE_TAG = 2
+NO_STRING = 0xFFFFFFFF
+
+LEVEL_NAMES = ["Trace", "Debug", "Info", "Warning", "Error", "Critical"]
+
+# Matches LogArg::Type
+ARG_BOOL, ARG_CHAR, ARG_INT, ARG_UINT, ARG_FLOAT, ARG_DOUBLE, ARG_POINTER, ARG_STRING = range(8)
+
+
+class Bool:
+    def __init__(self, value):
+        self.value = value
+
+    def __format__(self, spec):
+        if spec:
+            return format(int(self.value), spec)
+        return "true" if self.value else "false"
+
+
+class Float:
+    """float arguments are printed with the shortest representation that round trips."""
+
+    def __init__(self, value):
+        self.value = value
+
+    def __format__(self, spec):
+        if spec:
+            return format(self.value, spec)
+        for precision in range(1, 10):
+            text = "%.*g" % (precision, self.value)
+            if struct.unpack("<f", struct.pack("<f", float(text)))[0] == self.value:
+                return text
+        return repr(self.value)
+
+
+class Pointer:
+    def __init__(self, value):
+        self.value = value
+
+    def __format__(self, spec):
+        return format("0x%x" % self.value, spec)
+
+
+def format_message(fmt, args):
+    try:
+        return fmt.format(*args)
+    except (ValueError, IndexError, KeyError):
+        # Specs that only fmt understands, keep the arguments around at least.
+        return fmt + " " + " ".join(str(getattr(arg, "value", arg)) for arg in args)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read(self, fmt):
+        values = struct.unpack_from("<" + fmt, self.data, self.pos)
+        self.pos += struct.calcsize("<" + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def read_bytes(self, size):
+        value = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return value
+
+    def done(self):
+        return self.pos >= len(self.data)
+
+
+def read_args(reader, count):
+    args = []
+    for _ in range(count):
+        arg_type = reader.read("B")
+        if arg_type == ARG_STRING:
+            size = reader.read("I")
+            args.append(reader.read_bytes(size).decode("utf-8", "replace"))
+            continue
+        raw = reader.read_bytes(8)
+        if arg_type == ARG_BOOL:
+            args.append(Bool(raw[0] != 0))
+        elif arg_type == ARG_CHAR:
+            args.append(chr(raw[0]))
+        elif arg_type == ARG_INT:
+            args.append(struct.unpack("<q", raw)[0])
+        elif arg_type == ARG_UINT:
+            args.append(struct.unpack("<Q", raw)[0])
+        elif arg_type == ARG_FLOAT:
+            args.append(Float(struct.unpack("<f", raw[:4])[0]))
+        elif arg_type == ARG_DOUBLE:
+            args.append(struct.unpack("<d", raw)[0])
+        elif arg_type == ARG_POINTER:
+            args.append(Pointer(struct.unpack("<Q", raw)[0]))
+        else:
+            raise ValueError("unknown argument type %d" % arg_type)
+    return args
+
+
+def decode(data, out):
+    reader = Reader(data)
+    classes = []
+    strings = {}
+    while not reader.done():
+        if data.startswith(MAGIC, reader.pos):
+            # Every session, including appended ones, starts with a header.
+            reader.read_bytes(len(MAGIC))
+            version = reader.read("I")
+            if version != 1:
+                raise ValueError("unsupported binary log version %d" % version)
+            classes = [reader.read_bytes(reader.read("B")).decode() for _ in range(reader.read("H"))]
+            strings = {}
+            continue
+
+        tag = reader.read("B")
+        if tag == STRING_TAG:
+            string_id, size = reader.read("II")
+            strings[string_id] = reader.read_bytes(size).decode("utf-8", "replace")
+        elif tag == MESSAGE_TAG:
+            _, log_class, level, line, file_id, function_id, format_id, num_args = reader.read(
+                "QBBIIIIH")
+            args = read_args(reader, num_args)
+            if format_id == NO_STRING:
+                message = args[0] if args else ""
+            else:
+                message = format_message(strings[format_id], args)
+            out.write("[%s] <%s> %s:%d %s: %s\n" % (classes[log_class], LEVEL_NAMES[level],
+                                                     strings[file_id], line, strings[function_id],
+                                                     message))
+        else:
+            raise ValueError("bad record tag %d at offset %d" % (tag, reader.pos - 1))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: %s shad_log.bin [output.txt]" % sys.argv[0])
+        sys.exit(1)
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "w", encoding="utf-8") as out:
+            decode(data, out)
+    else:
+        decode(data, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
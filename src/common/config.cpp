@@ -143,6 +143,8 @@ static ConfigEntry<string> chooseHomeTab("General");
 static ConfigEntry<bool> isShowSplash(false);
 static ConfigEntry<string> isSideTrophy("right");
 static ConfigEntry<bool> isConnectedToNetwork(false);
+static ConfigEntry<u32> saveMemoryFlushDelay(1000); // milliseconds
+static ConfigEntry<u32> playGoInstallBandwidth(0); // KiB/s, 0 = fully installed
 static bool enableDiscordRPC = false;
 static bool checkCompatibilityOnStartup = false;
 static bool compatibilityData = false;
@@ -162,6 +164,7 @@ static ConfigEntry<bool> backgroundControllerInput(false);
 static ConfigEntry<string> micDevice("Default Device");
 static ConfigEntry<string> mainOutputDevice("Default Device");
 static ConfigEntry<string> padSpkOutputDevice("Default Device");
+static ConfigEntry<string> audioBackend("SDL");
 
 // GPU
 static ConfigEntry<u32> windowWidth(1280);
@@ -175,10 +178,14 @@ static ConfigEntry<bool> readbackLinearImagesEnabled(false);
 static ConfigEntry<bool> directMemoryAccessEnabled(false);
 static ConfigEntry<bool> shouldDumpShaders(false);
 static ConfigEntry<bool> shouldPatchShaders(false);
+static ConfigEntry<bool> pipelineCacheEnabled(true);
+static ConfigEntry<bool> asyncShaderCompileEnabled(false);
 static ConfigEntry<u32> vblankFrequency(60);
 static ConfigEntry<bool> isFullscreen(false);
 static ConfigEntry<string> fullscreenMode("Windowed");
 static ConfigEntry<string> presentMode("Mailbox");
+static ConfigEntry<bool> isHeadless(false);
+static ConfigEntry<string> frameCaptureMode("None");
 static ConfigEntry<bool> isHDRAllowed(false);
 static ConfigEntry<bool> fsrEnabled(true);
 static ConfigEntry<bool> rcasEnabled(true);
@@ -197,6 +204,7 @@ static ConfigEntry<bool> rdocEnable(false);
 
 // Debug
 static ConfigEntry<bool> isDebugDump(false);
+static ConfigEntry<bool> isHleProfilerEnabled(false);
 static ConfigEntry<bool> isShaderDebug(false);
 static ConfigEntry<bool> isSeparateLogFilesEnabled(false);
 static ConfigEntry<bool> isFpsColor(true);
@@ -325,6 +333,14 @@ std::string getPresentMode() {
     return presentMode.get();
 }
 
+bool getIsHeadless() {
+    return isHeadless.get();
+}
+
+std::string getFrameCaptureMode() {
+    return frameCaptureMode.get();
+}
+
 bool getisTrophyPopupDisabled() {
     return isTrophyPopupDisabled.get();
 }
@@ -353,10 +369,22 @@ std::string getPadSpkOutputDevice() {
     return padSpkOutputDevice.get();
 }
 
+std::string getAudioBackend() {
+    return audioBackend.get();
+}
+
 double getTrophyNotificationDuration() {
     return trophyNotificationDuration.get();
 }
 
+u32 getSaveMemoryFlushDelay() {
+    return saveMemoryFlushDelay.get();
+}
+
+u32 getPlayGoInstallBandwidth() {
+    return playGoInstallBandwidth.get();
+}
+
 u32 getWindowWidth() {
     return windowWidth.get();
 }
@@ -409,6 +437,10 @@ bool debugDump() {
     return isDebugDump.get();
 }
 
+bool hleProfilerEnabled() {
+    return isHleProfilerEnabled.get();
+}
+
 bool collectShadersForDebug() {
     return isShaderDebug.get();
 }
@@ -449,6 +481,14 @@ bool patchShaders() {
     return shouldPatchShaders.get();
 }
 
+bool pipelineCacheEnable() {
+    return pipelineCacheEnabled.get();
+}
+
+bool asyncShaderCompile() {
+    return asyncShaderCompileEnabled.get();
+}
+
 bool isRdocEnabled() {
     return rdocEnable.get();
 }
@@ -548,6 +588,10 @@ void setDebugDump(bool enable, bool is_game_specific) {
     isDebugDump.set(enable, is_game_specific);
 }
 
+void setHleProfilerEnabled(bool enable, bool is_game_specific) {
+    isHleProfilerEnabled.set(enable, is_game_specific);
+}
+
 void setLoggingEnabled(bool enable, bool is_game_specific) {
     logEnabled.set(enable, is_game_specific);
 }
@@ -588,6 +632,14 @@ void setDirectMemoryAccess(bool enable, bool is_game_specific) {
     directMemoryAccessEnabled.set(enable, is_game_specific);
 }
 
+void setPipelineCacheEnable(bool enable, bool is_game_specific) {
+    pipelineCacheEnabled.set(enable, is_game_specific);
+}
+
+void setAsyncShaderCompile(bool enable, bool is_game_specific) {
+    asyncShaderCompileEnabled.set(enable, is_game_specific);
+}
+
 void setDumpShaders(bool enable, bool is_game_specific) {
     shouldDumpShaders.set(enable, is_game_specific);
 }
@@ -620,6 +672,14 @@ void setPresentMode(std::string mode, bool is_game_specific) {
     presentMode.set(mode, is_game_specific);
 }
 
+void setIsHeadless(bool enable, bool is_game_specific) {
+    isHeadless.set(enable, is_game_specific);
+}
+
+void setFrameCaptureMode(std::string mode, bool is_game_specific) {
+    frameCaptureMode.set(mode, is_game_specific);
+}
+
 void setisTrophyPopupDisabled(bool disable, bool is_game_specific) {
     isTrophyPopupDisabled.set(disable, is_game_specific);
 }
@@ -648,10 +708,22 @@ void setPadSpkOutputDevice(std::string device, bool is_game_specific) {
     padSpkOutputDevice.set(device, is_game_specific);
 }
 
+void setAudioBackend(const std::string& backend, bool is_game_specific) {
+    audioBackend.set(backend, is_game_specific);
+}
+
 void setTrophyNotificationDuration(double newTrophyNotificationDuration, bool is_game_specific) {
     trophyNotificationDuration.set(newTrophyNotificationDuration, is_game_specific);
 }
 
+void setSaveMemoryFlushDelay(u32 delay_ms, bool is_game_specific) {
+    saveMemoryFlushDelay.set(delay_ms, is_game_specific);
+}
+
+void setPlayGoInstallBandwidth(u32 kib_per_second, bool is_game_specific) {
+    playGoInstallBandwidth.set(kib_per_second, is_game_specific);
+}
+
 void setLanguage(u32 language, bool is_game_specific) {
     m_language.set(language, is_game_specific);
 }
@@ -879,6 +951,8 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
                                                           checkCompatibilityOnStartup);
 
         isConnectedToNetwork.setFromToml(general, "isConnectedToNetwork", is_game_specific);
+        saveMemoryFlushDelay.setFromToml(general, "saveMemoryFlushDelay", is_game_specific);
+        playGoInstallBandwidth.setFromToml(general, "playGoInstallBandwidth", is_game_specific);
         chooseHomeTab.setFromToml(general, "chooseHomeTab", is_game_specific);
         defaultControllerID.setFromToml(general, "defaultControllerID", is_game_specific);
         sys_modules_path = toml::find_fs_path_or(general, "sysModulesPath", sys_modules_path);
@@ -902,6 +976,7 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         micDevice.setFromToml(audio, "micDevice", is_game_specific);
         mainOutputDevice.setFromToml(audio, "mainOutputDevice", is_game_specific);
         padSpkOutputDevice.setFromToml(audio, "padSpkOutputDevice", is_game_specific);
+        audioBackend.setFromToml(audio, "audioBackend", is_game_specific);
     }
 
     if (data.contains("GPU")) {
@@ -918,10 +993,14 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         directMemoryAccessEnabled.setFromToml(gpu, "directMemoryAccess", is_game_specific);
         shouldDumpShaders.setFromToml(gpu, "dumpShaders", is_game_specific);
         shouldPatchShaders.setFromToml(gpu, "patchShaders", is_game_specific);
+        pipelineCacheEnabled.setFromToml(gpu, "pipelineCacheEnable", is_game_specific);
+        asyncShaderCompileEnabled.setFromToml(gpu, "asyncShaderCompile", is_game_specific);
         vblankFrequency.setFromToml(gpu, "vblankFrequency", is_game_specific);
         isFullscreen.setFromToml(gpu, "Fullscreen", is_game_specific);
         fullscreenMode.setFromToml(gpu, "FullscreenMode", is_game_specific);
         presentMode.setFromToml(gpu, "presentMode", is_game_specific);
+        isHeadless.setFromToml(gpu, "headless", is_game_specific);
+        frameCaptureMode.setFromToml(gpu, "frameCaptureMode", is_game_specific);
         isHDRAllowed.setFromToml(gpu, "allowHDR", is_game_specific);
         fsrEnabled.setFromToml(gpu, "fsrEnabled", is_game_specific);
         rcasEnabled.setFromToml(gpu, "rcasEnabled", is_game_specific);
@@ -947,6 +1026,7 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         const toml::value& debug = data.at("Debug");
 
         isDebugDump.setFromToml(debug, "DebugDump", is_game_specific);
+        isHleProfilerEnabled.setFromToml(debug, "hleProfiler", is_game_specific);
         isSeparateLogFilesEnabled.setFromToml(debug, "isSeparateLogFilesEnabled", is_game_specific);
         isShaderDebug.setFromToml(debug, "CollectShader", is_game_specific);
         isFpsColor.setFromToml(debug, "FPSColor", is_game_specific);
@@ -1072,6 +1152,9 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     }
     isPSNSignedIn.setTomlValue(data, "General", "isPSNSignedIn", is_game_specific);
     isConnectedToNetwork.setTomlValue(data, "General", "isConnectedToNetwork", is_game_specific);
+    saveMemoryFlushDelay.setTomlValue(data, "General", "saveMemoryFlushDelay", is_game_specific);
+    playGoInstallBandwidth.setTomlValue(data, "General", "playGoInstallBandwidth",
+                                        is_game_specific);
 
     cursorState.setTomlValue(data, "Input", "cursorState", is_game_specific);
     cursorHideTimeout.setTomlValue(data, "Input", "cursorHideTimeout", is_game_specific);
@@ -1083,6 +1166,7 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     micDevice.setTomlValue(data, "Audio", "micDevice", is_game_specific);
     mainOutputDevice.setTomlValue(data, "Audio", "mainOutputDevice", is_game_specific);
     padSpkOutputDevice.setTomlValue(data, "Audio", "padSpkOutputDevice", is_game_specific);
+    audioBackend.setTomlValue(data, "Audio", "audioBackend", is_game_specific);
 
     windowWidth.setTomlValue(data, "GPU", "screenWidth", is_game_specific);
     windowHeight.setTomlValue(data, "GPU", "screenHeight", is_game_specific);
@@ -1095,11 +1179,15 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     isFullscreen.setTomlValue(data, "GPU", "Fullscreen", is_game_specific);
     fullscreenMode.setTomlValue(data, "GPU", "FullscreenMode", is_game_specific);
     presentMode.setTomlValue(data, "GPU", "presentMode", is_game_specific);
+    isHeadless.setTomlValue(data, "GPU", "headless", is_game_specific);
+    frameCaptureMode.setTomlValue(data, "GPU", "frameCaptureMode", is_game_specific);
     isHDRAllowed.setTomlValue(data, "GPU", "allowHDR", is_game_specific);
     fsrEnabled.setTomlValue(data, "GPU", "fsrEnabled", is_game_specific);
     rcasEnabled.setTomlValue(data, "GPU", "rcasEnabled", is_game_specific);
     rcasAttenuation.setTomlValue(data, "GPU", "rcasAttenuation", is_game_specific);
     directMemoryAccessEnabled.setTomlValue(data, "GPU", "directMemoryAccess", is_game_specific);
+    pipelineCacheEnabled.setTomlValue(data, "GPU", "pipelineCacheEnable", is_game_specific);
+    asyncShaderCompileEnabled.setTomlValue(data, "GPU", "asyncShaderCompile", is_game_specific);
 
     gpuId.setTomlValue(data, "Vulkan", "gpuId", is_game_specific);
     vkValidation.setTomlValue(data, "Vulkan", "validation", is_game_specific);
@@ -1110,6 +1198,7 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     rdocEnable.setTomlValue(data, "Vulkan", "rdocEnable", is_game_specific);
 
     isDebugDump.setTomlValue(data, "Debug", "DebugDump", is_game_specific);
+    isHleProfilerEnabled.setTomlValue(data, "Debug", "hleProfiler", is_game_specific);
     isShaderDebug.setTomlValue(data, "Debug", "CollectShader", is_game_specific);
     isSeparateLogFilesEnabled.setTomlValue(data, "Debug", "isSeparateLogFilesEnabled",
                                            is_game_specific);
@@ -1202,6 +1291,8 @@ void setDefaultValues(bool is_game_specific) {
     volumeSlider.set(100, is_game_specific);
     isTrophyPopupDisabled.set(false, is_game_specific);
     trophyNotificationDuration.set(6.0, is_game_specific);
+    saveMemoryFlushDelay.set(1000, is_game_specific);
+    playGoInstallBandwidth.set(0, is_game_specific);
     logFilter.set("", is_game_specific);
     logType.set("sync", is_game_specific);
     userName.set("shadPS4", is_game_specific);
@@ -1217,6 +1308,7 @@ void setDefaultValues(bool is_game_specific) {
 
     // GS - Audio
     micDevice.set("Default Device", is_game_specific);
+    audioBackend.set("SDL", is_game_specific);
 
     // GS - GPU
     windowWidth.set(1280, is_game_specific);
@@ -1228,10 +1320,14 @@ void setDefaultValues(bool is_game_specific) {
     isFullscreen.set(false, is_game_specific);
     fullscreenMode.set("Windowed", is_game_specific);
     presentMode.set("Mailbox", is_game_specific);
+    isHeadless.set(false, is_game_specific);
+    frameCaptureMode.set("None", is_game_specific);
     isHDRAllowed.set(false, is_game_specific);
     fsrEnabled.set(true, is_game_specific);
     rcasEnabled.set(true, is_game_specific);
     rcasAttenuation.set(250, is_game_specific);
+    pipelineCacheEnabled.set(true, is_game_specific);
+    asyncShaderCompileEnabled.set(false, is_game_specific);
 
     // GS - Vulkan
     gpuId.set(-1, is_game_specific);
@@ -1246,6 +1342,7 @@ void setDefaultValues(bool is_game_specific) {
 
     // GS - Debug
     isDebugDump.set(false, is_game_specific);
+    isHleProfilerEnabled.set(false, is_game_specific);
     isShaderDebug.set(false, is_game_specific);
     isSeparateLogFilesEnabled.set(false, is_game_specific);
     logEnabled.set(true, is_game_specific);
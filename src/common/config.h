@@ -37,6 +37,10 @@ std::string getFullscreenMode();
 void setFullscreenMode(std::string mode, bool is_game_specific = false);
 std::string getPresentMode();
 void setPresentMode(std::string mode, bool is_game_specific = false);
+bool getIsHeadless();
+void setIsHeadless(bool enable, bool is_game_specific = false);
+std::string getFrameCaptureMode(); // "None", "Hash" or "Png", only used when headless
+void setFrameCaptureMode(std::string mode, bool is_game_specific = false);
 u32 getWindowWidth();
 u32 getWindowHeight();
 void setWindowWidth(u32 width, bool is_game_specific = false);
@@ -47,6 +51,8 @@ void setInternalScreenWidth(u32 width);
 void setInternalScreenHeight(u32 height);
 bool debugDump();
 void setDebugDump(bool enable, bool is_game_specific = false);
+bool hleProfilerEnabled(); // counts HLE calls and their host time, needs a restart
+void setHleProfilerEnabled(bool enable, bool is_game_specific = false);
 s32 getGpuId();
 void setGpuId(s32 selectedGpuId, bool is_game_specific = false);
 bool allowHDR();
@@ -67,6 +73,10 @@ bool readbackLinearImages();
 void setReadbackLinearImages(bool enable, bool is_game_specific = false);
 bool directMemoryAccess();
 void setDirectMemoryAccess(bool enable, bool is_game_specific = false);
+bool pipelineCacheEnable();
+void setPipelineCacheEnable(bool enable, bool is_game_specific = false);
+bool asyncShaderCompile();
+void setAsyncShaderCompile(bool enable, bool is_game_specific = false);
 bool dumpShaders();
 void setDumpShaders(bool enable, bool is_game_specific = false);
 u32 vblankFreq();
@@ -93,6 +103,10 @@ std::string getLogType();
 void setLogType(const std::string& type, bool is_game_specific = false);
 std::string getLogFilter();
 void setLogFilter(const std::string& type, bool is_game_specific = false);
+u32 getSaveMemoryFlushDelay();
+void setSaveMemoryFlushDelay(u32 delay_ms, bool is_game_specific = false);
+u32 getPlayGoInstallBandwidth(); // KiB/s of the simulated PlayGo install, 0 to disable
+void setPlayGoInstallBandwidth(u32 kib_per_second, bool is_game_specific = false);
 double getTrophyNotificationDuration();
 void setTrophyNotificationDuration(double newTrophyNotificationDuration,
                                    bool is_game_specific = false);
@@ -102,6 +116,8 @@ std::string getMainOutputDevice();
 void setMainOutputDevice(std::string device);
 std::string getPadSpkOutputDevice();
 void setPadSpkOutputDevice(std::string device);
+std::string getAudioBackend(); // "SDL" or "Null"
+void setAudioBackend(const std::string& backend, bool is_game_specific = false);
 std::string getMicDevice();
 void setCursorHideTimeout(int newcursorHideTimeout, bool is_game_specific = false);
 void setMicDevice(std::string device, bool is_game_specific = false);
@@ -1,17 +1,25 @@
 // SPDX-FileCopyrightText: Copyright 2014 Citra Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <vector>
 
+#include <fmt/args.h>
 #include <fmt/format.h>
+#include <tsl/robin_map.h>
 
 #ifdef _WIN32
 #include <windows.h> // For OutputDebugStringW
 #endif
 
-#include "common/bounded_threadsafe_queue.h"
 #include "common/config.h"
 #include "common/debug.h"
 #include "common/io_file.h"
@@ -20,6 +28,7 @@
 #include "common/logging/log_entry.h"
 #include "common/logging/text_formatter.h"
 #include "common/path_util.h"
+#include "common/ring_buffer.h"
 #include "common/string_util.h"
 #include "common/thread.h"
 
@@ -29,6 +38,194 @@ using namespace Common::FS;
 
 namespace {
 
+enum class LogMode {
+    Sync,   // Written by the calling thread
+    Async,  // Queued and written by the logging thread
+    Binary, // Like async, with the log file in the compact binary format
+};
+
+/// Header of a queued message, followed by its encoded arguments. Pointers are to string
+/// literals, so they stay valid until the message is written.
+struct RecordHeader {
+    u64 timestamp;
+    const char* filename;
+    const char* function;
+    const char* format; // nullptr when the caller already formatted the message
+    u32 size;           // of the whole record
+    u32 line_num;
+    Class log_class;
+    Level log_level;
+    u16 num_args;
+};
+
+template <typename T>
+void AppendBytes(std::vector<u8>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+/// Encodes arguments as a type byte followed by 8 bytes of value, or a length and the
+/// characters for strings.
+void EncodeArgs(std::vector<u8>& out, std::span<const LogArg> args) {
+    for (const LogArg& arg : args) {
+        out.push_back(static_cast<u8>(arg.type));
+        if (arg.type == LogArg::Type::String) {
+            AppendBytes(out, static_cast<u32>(arg.str.size));
+            out.insert(out.end(), arg.str.data, arg.str.data + arg.str.size);
+        } else {
+            AppendBytes(out, arg.u);
+        }
+    }
+}
+
+template <typename T>
+T ReadBytes(const u8*& ptr) {
+    T value;
+    std::memcpy(&value, ptr, sizeof(T));
+    ptr += sizeof(T);
+    return value;
+}
+
+std::string FormatRecord(const RecordHeader& header, std::span<const u8> args) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    std::string_view preformatted;
+    const u8* ptr = args.data();
+    for (u16 i = 0; i < header.num_args; i++) {
+        const auto type = static_cast<LogArg::Type>(*ptr++);
+        if (type == LogArg::Type::String) {
+            const u32 size = ReadBytes<u32>(ptr);
+            preformatted = {reinterpret_cast<const char*>(ptr), size};
+            store.push_back(preformatted);
+            ptr += size;
+            continue;
+        }
+        const u8* value = ptr;
+        ptr += sizeof(u64);
+        switch (type) {
+        case LogArg::Type::Bool:
+            store.push_back(ReadBytes<bool>(value));
+            break;
+        case LogArg::Type::Char:
+            store.push_back(ReadBytes<char>(value));
+            break;
+        case LogArg::Type::Int:
+            store.push_back(ReadBytes<s64>(value));
+            break;
+        case LogArg::Type::UInt:
+            store.push_back(ReadBytes<u64>(value));
+            break;
+        case LogArg::Type::Float:
+            store.push_back(ReadBytes<float>(value));
+            break;
+        case LogArg::Type::Double:
+            store.push_back(ReadBytes<double>(value));
+            break;
+        case LogArg::Type::Pointer:
+            store.push_back(ReadBytes<const void*>(value));
+            break;
+        default:
+            break;
+        }
+    }
+    if (header.format == nullptr) {
+        return std::string{preformatted};
+    }
+    try {
+        return fmt::vformat(header.format, store);
+    } catch (const fmt::format_error& e) {
+        return fmt::format("<bad log format \"{}\": {}>", header.format, e.what());
+    }
+}
+
+/**
+ * Backend that writes records in a compact binary form, leaving all formatting to the
+ * decoder in scripts/decode_binary_log.py.
+ *
+ * The file starts with a header holding the log class names. It is followed by string
+ * records, which define file, function and format strings the first time they are used, and
+ * message records, which refer to them by id and carry the encoded arguments.
+ */
+class BinaryFileBackend {
+public:
+    static constexpr std::array<char, 8> Magic = {'\x7f', 'S', 'H', 'A', 'D', 'L', 'O', 'G'};
+    static constexpr u32 Version = 1;
+    static constexpr u8 StringTag = 1;
+    static constexpr u8 MessageTag = 2;
+    static constexpr u32 NoString = 0xFFFFFFFF;
+
+    explicit BinaryFileBackend(const std::filesystem::path& filename, bool should_append = false)
+        : file{filename, should_append ? FS::FileAccessMode::Append : FS::FileAccessMode::Write,
+               FS::FileType::BinaryFile} {
+        // Appended sessions start with their own header, which resets the string table.
+        buffer.insert(buffer.end(), Magic.begin(), Magic.end());
+        AppendBytes(buffer, Version);
+        AppendBytes(buffer, static_cast<u16>(Class::Count));
+        for (u16 i = 0; i < static_cast<u16>(Class::Count); i++) {
+            const std::string_view name = GetLogClassName(static_cast<Class>(i));
+            buffer.push_back(static_cast<u8>(name.size()));
+            buffer.insert(buffer.end(), name.begin(), name.end());
+        }
+        bytes_written += file.WriteSpan<u8>(buffer);
+    }
+
+    ~BinaryFileBackend() = default;
+
+    void Write(const RecordHeader& header, std::span<const u8> args) {
+        if (!enabled) {
+            return;
+        }
+
+        buffer.clear();
+        const u32 file_id = InternString(header.filename);
+        const u32 function_id = InternString(header.function);
+        const u32 format_id = header.format ? InternString(header.format) : NoString;
+        buffer.push_back(MessageTag);
+        AppendBytes(buffer, header.timestamp);
+        buffer.push_back(static_cast<u8>(header.log_class));
+        buffer.push_back(static_cast<u8>(header.log_level));
+        AppendBytes(buffer, header.line_num);
+        AppendBytes(buffer, file_id);
+        AppendBytes(buffer, function_id);
+        AppendBytes(buffer, format_id);
+        AppendBytes(buffer, header.num_args);
+        buffer.insert(buffer.end(), args.begin(), args.end());
+        bytes_written += file.WriteSpan<u8>(buffer);
+
+        const auto write_limit = 100_MB;
+        const bool write_limit_exceeded = bytes_written > write_limit;
+        if (header.log_level >= Level::Error || write_limit_exceeded) {
+            if (write_limit_exceeded) {
+                enabled = false;
+            }
+            file.Flush();
+        }
+    }
+
+    void Flush() {
+        file.Flush();
+    }
+
+private:
+    u32 InternString(const char* str) {
+        const auto [it, inserted] = string_ids.try_emplace(str, next_string_id);
+        if (inserted) {
+            const std::string_view view{str};
+            buffer.push_back(StringTag);
+            AppendBytes(buffer, next_string_id++);
+            AppendBytes(buffer, static_cast<u32>(view.size()));
+            buffer.insert(buffer.end(), view.begin(), view.end());
+        }
+        return it->second;
+    }
+
+    Common::FS::IOFile file;
+    tsl::robin_map<const char*, u32> string_ids;
+    std::vector<u8> buffer;
+    u32 next_string_id = 0;
+    bool enabled = true;
+    std::size_t bytes_written = 0;
+};
+
 /**
  * Backend that writes to stderr and with color
  */
@@ -52,6 +249,10 @@ public:
         enabled = enabled_;
     }
 
+    bool IsEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
 private:
     std::atomic_bool enabled{true};
 };
@@ -119,6 +320,30 @@ public:
 
 bool initialization_in_progress_suppress_logging = true;
 
+// Each thread queues its messages into its own ring, which the logging thread drains.
+constexpr std::size_t ThreadQueueSize = 256_KB;
+constexpr std::size_t MaxQueuedRecordSize = ThreadQueueSize / 4;
+constexpr auto BackendPollInterval = std::chrono::milliseconds(5);
+
+struct ThreadQueue {
+    Common::RingBuffer<u8> ring{ThreadQueueSize};
+    std::atomic_bool retired{};
+};
+
+struct ThreadQueueRef {
+    std::shared_ptr<ThreadQueue> queue;
+    u64 generation{};
+
+    ~ThreadQueueRef() {
+        if (queue) {
+            queue->retired = true;
+        }
+    }
+};
+
+thread_local ThreadQueueRef thread_queue;
+thread_local std::vector<u8> thread_record;
+
 /**
  * Static state as a singleton.
  */
@@ -181,11 +406,39 @@ public:
         color_console_backend.SetEnabled(enabled);
     }
 
+    bool CanLog(Class log_class, Level log_level) const {
+        return (filter.CheckMessage(log_class, log_level) && Config::getLoggingEnabled()) ||
+               (log_level >= Level::Warning && IsProfilerConnected());
+    }
+
     void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
-                   const char* function, std::string message) {
+                   const char* function, const char* format, std::span<const LogArg> args) {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::steady_clock;
+
+        std::vector<u8>& record = thread_record;
+        record.resize(sizeof(RecordHeader));
+        EncodeArgs(record, args);
+        const RecordHeader header = {
+            .timestamp = static_cast<u64>(
+                duration_cast<microseconds>(steady_clock::now() - time_origin).count()),
+            .filename = filename,
+            .function = function,
+            .format = format,
+            .size = static_cast<u32>(record.size()),
+            .line_num = line_num,
+            .log_class = log_class,
+            .log_level = log_level,
+            .num_args = static_cast<u16>(args.size()),
+        };
+        std::memcpy(record.data(), &header, sizeof(header));
+        const std::span<const u8> encoded_args{record.begin() + sizeof(header), record.end()};
+
         // Propagate important log messages to the profiler
-        if (IsProfilerConnected()) {
-            const auto& msg_str = fmt::format("[{}] {}", GetLogClassName(log_class), message);
+        if (IsProfilerConnected() && log_level >= Level::Warning) {
+            const auto& msg_str = fmt::format("[{}] {}", GetLogClassName(log_class),
+                                              FormatRecord(header, encoded_args));
             switch (log_level) {
             case Level::Warning:
                 TRACE_WARN(msg_str);
@@ -205,68 +458,184 @@ public:
             return;
         }
 
-        using std::chrono::duration_cast;
-        using std::chrono::microseconds;
-        using std::chrono::steady_clock;
-
-        const Entry entry = {
-            .timestamp = duration_cast<microseconds>(steady_clock::now() - time_origin),
-            .log_class = log_class,
-            .log_level = log_level,
-            .filename = filename,
-            .line_num = line_num,
-            .function = function,
-            .message = std::move(message),
-        };
-        if (Config::getLogType() == "async") {
-            message_queue.EmplaceWait(entry);
-        } else {
-            ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
-            std::fflush(stdout);
+        if (mode != LogMode::Sync && record.size() <= MaxQueuedRecordSize &&
+            Enqueue(record, log_level)) {
+            return;
         }
+        std::scoped_lock lk{write_mutex};
+        WriteRecord(header, encoded_args);
+        std::fflush(stdout);
     }
 
 private:
     Impl(const std::filesystem::path& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename, should_append} {}
+        : filter{filter_}, mode{GetLogMode()} {
+        if (mode == LogMode::Binary) {
+            auto binary_filename = file_backend_filename;
+            binary_backend.emplace(binary_filename.replace_extension(".bin"), should_append);
+        } else {
+            file_backend.emplace(file_backend_filename, should_append);
+        }
+    }
 
     ~Impl() = default;
 
+    static LogMode GetLogMode() {
+        const auto log_type = Config::getLogType();
+        if (log_type == "async") {
+            return LogMode::Async;
+        }
+        if (log_type == "binary") {
+            return LogMode::Binary;
+        }
+        return LogMode::Sync;
+    }
+
+    ThreadQueue& GetThreadQueue() {
+        if (thread_queue.generation != generation) {
+            auto queue = std::make_shared<ThreadQueue>();
+            {
+                std::scoped_lock lk{queues_mutex};
+                queues.push_back(queue);
+            }
+            if (thread_queue.queue) {
+                thread_queue.queue->retired = true;
+            }
+            thread_queue.queue = std::move(queue);
+            thread_queue.generation = generation;
+        }
+        return *thread_queue.queue;
+    }
+
+    /// Queues a record for the logging thread. Fails if the thread isn't running.
+    bool Enqueue(std::span<const u8> record, Level log_level) {
+        if (!backend_running.load(std::memory_order_acquire)) {
+            return false;
+        }
+        auto& ring = GetThreadQueue().ring;
+        while (ring.Capacity() - ring.Size() < record.size()) {
+            // The logging thread is behind, wait for it like the old bounded queue did.
+            Wake();
+            std::this_thread::yield();
+            if (!backend_running.load(std::memory_order_acquire)) {
+                return false;
+            }
+        }
+        ring.Push(record);
+        if (log_level >= Level::Error || ring.Size() > ring.Capacity() / 2) {
+            Wake();
+        }
+        return true;
+    }
+
+    void Wake() {
+        wake_pending.store(true, std::memory_order_release);
+        wake_cv.notify_one();
+    }
+
+    void WriteRecord(const RecordHeader& header, std::span<const u8> args) {
+        if (binary_backend) {
+            binary_backend->Write(header, args);
+        }
+        if (!file_backend && !color_console_backend.IsEnabled()) {
+            return;
+        }
+        const Entry entry = {
+            .timestamp = std::chrono::microseconds(header.timestamp),
+            .log_class = header.log_class,
+            .log_level = header.log_level,
+            .filename = header.filename,
+            .line_num = header.line_num,
+            .function = header.function,
+            .message = FormatRecord(header, args),
+        };
+        ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
+    }
+
+    /// Writes out everything the threads queued so far, in timestamp order, up to `max_logs`.
+    std::size_t DrainQueues(std::size_t max_logs) {
+        batch.clear();
+        {
+            std::scoped_lock lk{queues_mutex};
+            std::erase_if(queues, [this](const std::shared_ptr<ThreadQueue>& queue) {
+                // Check retirement first, a retired queue won't receive anything new.
+                const bool retired = queue->retired.load(std::memory_order_acquire);
+                const std::size_t size = queue->ring.Size();
+                if (size != 0) {
+                    const std::size_t offset = batch.size();
+                    batch.resize(offset + size);
+                    queue->ring.Pop(std::span{batch}.subspan(offset));
+                }
+                return retired && size == 0;
+            });
+        }
+
+        records.clear();
+        for (std::size_t offset = 0; offset < batch.size();) {
+            RecordHeader header;
+            std::memcpy(&header, batch.data() + offset, sizeof(header));
+            records.emplace_back(header, offset + sizeof(header));
+            offset += header.size;
+        }
+        std::ranges::stable_sort(records, {}, [](const auto& record) {
+            return record.first.timestamp;
+        });
+
+        const std::size_t count = std::min(records.size(), max_logs);
+        std::scoped_lock lk{write_mutex};
+        for (std::size_t i = 0; i < count; i++) {
+            const auto& [header, args_offset] = records[i];
+            WriteRecord(header, std::span{batch}.subspan(
+                                    args_offset, header.size - sizeof(RecordHeader)));
+        }
+        return count;
+    }
+
     void StartBackendThread() {
+        if (mode == LogMode::Sync) {
+            return;
+        }
+        backend_running = true;
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("shadPS4:Log");
-            Entry entry;
-            const auto write_logs = [this, &entry]() {
-                ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
-            };
             while (!stop_token.stop_requested()) {
-                message_queue.PopWait(entry, stop_token);
-                if (entry.filename != nullptr) {
-                    write_logs();
+                if (DrainQueues(std::numeric_limits<std::size_t>::max()) == 0) {
+                    std::unique_lock lk{wake_mutex};
+                    wake_cv.wait_for(lk, stop_token, BackendPollInterval, [this] {
+                        return wake_pending.exchange(false, std::memory_order_acquire);
+                    });
                 }
             }
             // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a
             // case where a system is repeatedly spamming logs even on close.
-            int max_logs_to_write = filter.IsDebug() ? std::numeric_limits<s32>::max() : 100;
-            while (max_logs_to_write-- && message_queue.TryPop(entry)) {
-                write_logs();
-            }
+            DrainQueues(filter.IsDebug() ? std::numeric_limits<s32>::max() : 100);
         });
     }
 
     void StopBackendThread() {
+        // Anything logged from now on is written directly by the calling thread.
+        backend_running = false;
         backend_thread.request_stop();
         if (backend_thread.joinable()) {
             backend_thread.join();
         }
+        // Threads that saw the backend running just before the flag was cleared may have
+        // queued records after the final drain of the logging thread, write those out too.
+        DrainQueues(std::numeric_limits<std::size_t>::max());
 
+        std::scoped_lock lk{write_mutex};
         ForEachBackend([](auto& backend) { backend.Flush(); });
+        if (binary_backend) {
+            binary_backend->Flush();
+        }
     }
 
     void ForEachBackend(auto lambda) {
         // lambda(debugger_backend);
         lambda(color_console_backend);
-        lambda(file_backend);
+        if (file_backend) {
+            lambda(*file_backend);
+        }
     }
 
     static void Deleter(Impl* ptr) {
@@ -275,13 +644,26 @@ private:
 
     static inline std::unique_ptr<Impl, decltype(&Deleter)> instance{nullptr, Deleter};
     static inline bool should_append{false};
+    static inline std::atomic<u64> next_generation{0};
 
     Filter filter;
+    LogMode mode;
     DebuggerBackend debugger_backend{};
     ColorConsoleBackend color_console_backend{};
-    FileBackend file_backend;
-
-    MPSCQueue<Entry> message_queue{};
+    std::optional<FileBackend> file_backend;
+    std::optional<BinaryFileBackend> binary_backend;
+    std::mutex write_mutex;
+
+    const u64 generation{++next_generation};
+    std::mutex queues_mutex;
+    std::vector<std::shared_ptr<ThreadQueue>> queues;
+    std::vector<u8> batch;
+    std::vector<std::pair<RecordHeader, std::size_t>> records;
+
+    std::atomic_bool backend_running{};
+    std::atomic_bool wake_pending{};
+    std::mutex wake_mutex;
+    std::condition_variable_any wake_cv;
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
     std::jthread backend_thread;
 };
@@ -320,12 +702,30 @@ void SetAppend() {
     Impl::SetAppend();
 }
 
+bool CanLog(Class log_class, Level log_level) {
+    if (initialization_in_progress_suppress_logging) [[unlikely]] {
+        return false;
+    }
+    return Impl::Instance().CanLog(log_class, log_level);
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args) {
     if (!initialization_in_progress_suppress_logging) [[likely]] {
-        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function,
-                                   fmt::vformat(format, args));
+        const std::string message = fmt::vformat(format, args);
+        const LogArg arg = MakeLogArg(message);
+        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function, nullptr,
+                                   {&arg, 1});
+    }
+}
+
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            std::span<const LogArg> args) {
+    if (!initialization_in_progress_suppress_logging) [[likely]] {
+        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function, format,
+                                   args);
     }
 }
 } // namespace Common::Log
@@ -5,7 +5,10 @@
 
 #include <algorithm>
 #include <array>
+#include <span>
+#include <string>
 #include <string_view>
+#include <type_traits>
 
 #include "common/logging/formatter.h"
 #include "common/logging/types.h"
@@ -20,16 +23,123 @@ constexpr const char* TrimSourcePath(std::string_view source) {
     return source.data() + idx;
 }
 
+/// Returns true if a message of this class and level would be written anywhere.
+bool CanLog(Class log_class, Level log_level);
+
+/// A log argument captured by value, so that formatting can happen on the logging thread.
+struct LogArg {
+    enum class Type : u8 {
+        Bool,
+        Char,
+        Int,
+        UInt,
+        Float,
+        Double,
+        Pointer,
+        String,
+    };
+
+    Type type;
+    union {
+        bool b;
+        char c;
+        s64 i;
+        u64 u;
+        float f;
+        double d;
+        const void* p;
+        struct {
+            const char* data;
+            std::size_t size;
+        } str;
+    };
+};
+
+/// Whether an argument can be captured into a LogArg and formatted later with the same result.
+template <typename T>
+constexpr bool IsDeferrableLogArg() {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char>) {
+        return true;
+    } else if constexpr (std::is_same_v<U, wchar_t> || std::is_same_v<U, char8_t> ||
+                         std::is_same_v<U, char16_t> || std::is_same_v<U, char32_t>) {
+        return false;
+    } else if constexpr (std::is_integral_v<U>) {
+        return sizeof(U) <= sizeof(u64);
+    } else if constexpr (std::is_floating_point_v<U>) {
+        return std::is_same_v<U, float> || std::is_same_v<U, double>;
+    } else if constexpr (std::is_enum_v<U>) {
+        // Only enums printed as their value, anything with its own formatter is formatted eagerly.
+        return std::is_base_of_v<fmt::formatter<std::underlying_type_t<U>>, fmt::formatter<U>>;
+    } else if constexpr (std::is_array_v<U>) {
+        return std::is_same_v<std::remove_cv_t<std::remove_extent_t<U>>, char>;
+    } else {
+        return std::is_same_v<U, const void*> || std::is_same_v<U, void*> ||
+               std::is_same_v<U, const char*> || std::is_same_v<U, char*> ||
+               std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>;
+    }
+}
+
+template <typename T>
+LogArg MakeLogArg(const T& value) {
+    using U = std::remove_cvref_t<T>;
+    LogArg arg;
+    if constexpr (std::is_same_v<U, bool>) {
+        arg.type = LogArg::Type::Bool;
+        arg.b = value;
+    } else if constexpr (std::is_same_v<U, char>) {
+        arg.type = LogArg::Type::Char;
+        arg.c = value;
+    } else if constexpr (std::is_enum_v<U>) {
+        return MakeLogArg(static_cast<std::underlying_type_t<U>>(value));
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        arg.type = LogArg::Type::Int;
+        arg.i = value;
+    } else if constexpr (std::is_integral_v<U>) {
+        arg.type = LogArg::Type::UInt;
+        arg.u = value;
+    } else if constexpr (std::is_same_v<U, float>) {
+        arg.type = LogArg::Type::Float;
+        arg.f = value;
+    } else if constexpr (std::is_same_v<U, double>) {
+        arg.type = LogArg::Type::Double;
+        arg.d = value;
+    } else if constexpr (std::is_same_v<U, const void*> || std::is_same_v<U, void*>) {
+        arg.type = LogArg::Type::Pointer;
+        arg.p = value;
+    } else {
+        const std::string_view str{value};
+        arg.type = LogArg::Type::String;
+        arg.str = {str.data(), str.size()};
+    }
+    return arg;
+}
+
 /// Logs a message to the global logger, using fmt
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+/// Logs a message whose arguments are formatted by the logging thread. `format` must be a
+/// string literal.
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            std::span<const LogArg> args);
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
-    FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
-                      fmt::make_format_args(args...));
+    if (!CanLog(log_class, log_level)) {
+        return;
+    }
+    if constexpr ((IsDeferrableLogArg<Args>() && ...)) {
+        const std::array<LogArg, sizeof...(Args)> log_args{MakeLogArg(args)...};
+        DeferredLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                               log_args);
+    } else {
+        FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                          fmt::make_format_args(args...));
+    }
 }
 
 } // namespace Common::Log
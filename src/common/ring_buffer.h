@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Common {
+
+/**
+ * Lock-free ring buffer for one producer and one consumer thread, moving elements in bulk.
+ * Indices grow monotonically and are masked on access, so full and empty are never ambiguous.
+ */
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(std::size_t capacity)
+        : buffer(std::bit_ceil(capacity)), mask{buffer.size() - 1} {}
+
+    /// Producer side. Copies as much of `data` as fits and returns the number of elements written.
+    std::size_t Push(std::span<const T> data) {
+        const std::size_t write = write_index.load(std::memory_order_relaxed);
+        const std::size_t read = read_index.load(std::memory_order_acquire);
+        const std::size_t count = std::min(data.size(), buffer.size() - (write - read));
+        const std::size_t offset = write & mask;
+        const std::size_t first = std::min(count, buffer.size() - offset);
+        std::copy_n(data.begin(), first, buffer.begin() + offset);
+        std::copy_n(data.begin() + first, count - first, buffer.begin());
+        write_index.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    /// Consumer side. Fills as much of `data` as is available and returns the number of elements.
+    std::size_t Pop(std::span<T> data) {
+        const std::size_t read = read_index.load(std::memory_order_relaxed);
+        const std::size_t write = write_index.load(std::memory_order_acquire);
+        const std::size_t count = std::min(data.size(), write - read);
+        const std::size_t offset = read & mask;
+        const std::size_t first = std::min(count, buffer.size() - offset);
+        std::copy_n(buffer.begin() + offset, first, data.begin());
+        std::copy_n(buffer.begin(), count - first, data.begin() + first);
+        read_index.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    /// Number of queued elements. Exact from either side for the side's own purposes.
+    [[nodiscard]] std::size_t Size() const {
+        return write_index.load(std::memory_order_acquire) -
+               read_index.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] std::size_t Capacity() const {
+        return buffer.size();
+    }
+
+    /// Consumer side. Drops everything queued so far.
+    void Clear() {
+        read_index.store(write_index.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    // Keeps the producer and consumer indices from sharing a cache line.
+    static constexpr std::size_t CacheLineSize = 64;
+
+    std::vector<T> buffer;
+    std::size_t mask;
+    alignas(CacheLineSize) std::atomic<std::size_t> read_index{0};
+    alignas(CacheLineSize) std::atomic<std::size_t> write_index{0};
+};
+
+} // namespace Common
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: Copyright 2020 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
+#include "common/unique_function.h"
+
+namespace Common {
+
+/// Fixed size pool of worker threads consuming a shared FIFO of tasks.
+class ThreadWorker {
+    using Task = UniqueFunction<void>;
+
+public:
+    explicit ThreadWorker(std::size_t num_workers, std::string name) : thread_name{std::move(name)} {
+        const auto lambda = [this](std::stop_token stop_token) {
+            SetCurrentThreadName(thread_name.c_str());
+            while (!stop_token.stop_requested()) {
+                Task task;
+                {
+                    std::unique_lock lock{queue_mutex};
+                    if (requests.empty()) {
+                        wait_condition.notify_all();
+                    }
+                    CondvarWait(condition, lock, stop_token, [this] { return !requests.empty(); });
+                    if (stop_token.stop_requested()) {
+                        break;
+                    }
+                    task = std::move(requests.front());
+                    requests.pop();
+                }
+                task();
+                ++work_done;
+            }
+            ++workers_stopped;
+            wait_condition.notify_all();
+        };
+        threads.reserve(num_workers);
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            threads.emplace_back(lambda);
+        }
+    }
+
+    ThreadWorker& operator=(const ThreadWorker&) = delete;
+    ThreadWorker(const ThreadWorker&) = delete;
+
+    ThreadWorker& operator=(ThreadWorker&&) = delete;
+    ThreadWorker(ThreadWorker&&) = delete;
+
+    /// Drains every queued task before joining the workers.
+    ~ThreadWorker() {
+        WaitForRequests();
+        for (auto& thread : threads) {
+            thread.request_stop();
+        }
+    }
+
+    template <typename Func>
+    void QueueWork(Func&& work) {
+        {
+            std::unique_lock lock{queue_mutex};
+            requests.emplace(std::forward<Func>(work));
+            ++work_scheduled;
+        }
+        condition.notify_one();
+    }
+
+    void WaitForRequests() {
+        std::unique_lock lock{queue_mutex};
+        wait_condition.wait(lock, [this] {
+            return workers_stopped >= threads.size() || work_done >= work_scheduled;
+        });
+    }
+
+private:
+    std::string thread_name;
+    std::queue<Task> requests;
+    std::mutex queue_mutex;
+    std::condition_variable_any condition;
+    std::condition_variable wait_condition;
+    std::atomic<std::size_t> work_scheduled{};
+    std::atomic<std::size_t> work_done{};
+    std::atomic<std::size_t> workers_stopped{};
+    std::vector<std::jthread> threads;
+};
+
+} // namespace Common
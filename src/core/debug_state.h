@@ -143,6 +143,12 @@ class DebugStateImpl {
     std::atomic_int32_t flip_frame_count = 0;
     std::atomic_int32_t gnm_frame_count = 0;
 
+    // Graphics pipeline key refreshes counted by the GPU thread, latched on every flip.
+    std::atomic_uint32_t pipeline_key_rebuilds = 0;
+    std::atomic_uint32_t pipeline_key_reuses = 0;
+    std::atomic_uint32_t last_pipeline_key_rebuilds = 0;
+    std::atomic_uint32_t last_pipeline_key_reuses = 0;
+
     s32 gnm_frame_dump_request_count = -1;
     std::unordered_map<size_t, FrameDump*> waiting_reg_dumps;
     std::unordered_map<size_t, std::string> waiting_reg_dumps_dbg;
@@ -187,6 +193,14 @@ public:
 
     void IncFlipFrameNum() {
         ++flip_frame_count;
+        last_pipeline_key_rebuilds = pipeline_key_rebuilds.exchange(0, std::memory_order_relaxed);
+        last_pipeline_key_reuses = pipeline_key_reuses.exchange(0, std::memory_order_relaxed);
+    }
+
+    /// Counts a draw whose pipeline key was rebuilt or taken over unchanged from the last one.
+    void CountPipelineKeyRefresh(bool rebuilt) {
+        auto& counter = rebuilt ? pipeline_key_rebuilds : pipeline_key_reuses;
+        counter.fetch_add(1, std::memory_order_relaxed);
     }
 
     void IncGnmFrameNum() {
@@ -17,6 +17,7 @@
 #include "video_core/renderer_vulkan/vk_presenter.h"
 #include "widget/frame_dump.h"
 #include "widget/frame_graph.h"
+#include "widget/hle_call_list.h"
 #include "widget/memory_map.h"
 #include "widget/module_list.h"
 #include "widget/shader_list.h"
@@ -44,6 +45,7 @@ static bool just_opened_options = false;
 static Widget::MemoryMapViewer memory_map;
 static Widget::ShaderList shader_list;
 static Widget::ModuleList module_list;
+static Widget::HleCallList hle_call_list;
 
 // clang-format off
 static std::string help_text =
@@ -125,6 +127,9 @@ void L::DrawMenuBar() {
             if (MenuItem("Module list")) {
                 module_list.open = true;
             }
+            if (MenuItem("HLE calls", nullptr, false, ::Core::HleProfiler::IsEnabled())) {
+                hle_call_list.open = true;
+            }
             ImGui::EndMenu();
         }
 
@@ -269,6 +274,9 @@ void L::DrawAdvanced() {
     if (module_list.open) {
         module_list.Draw();
     }
+    if (hle_call_list.open) {
+        hle_call_list.Draw();
+    }
 }
 
 void L::DrawSimple() {
@@ -6,8 +6,12 @@
 #include "common/config.h"
 #include "common/singleton.h"
 #include "core/debug_state.h"
+#include "core/libraries/audio/audioout.h"
 #include "imgui.h"
 #include "imgui_internal.h"
+#include "video_core/amdgpu/liverpool.h"
+
+extern std::unique_ptr<AmdGpu::Liverpool> liverpool;
 
 using namespace ImGui;
 
@@ -96,11 +100,39 @@ void FrameGraph::Draw() {
         Text("Presenter time: %.3f ms (%.1f FPS)", io.DeltaTime * 1000.0f, 1.0f / io.DeltaTime);
         Text("Flip frame: %d Gnm submit frame: %d", DebugState.flip_frame_count.load(),
              DebugState.gnm_frame_count.load());
+        Text("Pipeline keys: %u rebuilt %u reused", DebugState.last_pipeline_key_rebuilds.load(),
+             DebugState.last_pipeline_key_reuses.load());
         Text("Game Res: %dx%d", DebugState.game_resolution.first,
              DebugState.game_resolution.second);
         Text("Output Res: %dx%d", DebugState.output_resolution.first,
              DebugState.output_resolution.second);
         Text("FSR: %s", DebugState.is_using_fsr ? "on" : "off");
+
+        if (liverpool) {
+            SeparatorText("GPU queues");
+            for (u32 qid = 0; qid < liverpool->GetNumMappedQueues(); ++qid) {
+                const auto stats = liverpool->GetQueueStats(qid);
+                if (stats.num_submitted == 0) {
+                    continue;
+                }
+                const double avg_ms =
+                    stats.num_completed != 0
+                        ? stats.total_process_us / 1000.0 / static_cast<double>(stats.num_completed)
+                        : 0.0;
+                Text("Queue %u: depth %u (max %u), %llu submitted, %.3f ms per submit", qid,
+                     stats.depth, stats.max_depth,
+                     static_cast<unsigned long long>(stats.num_submitted), avg_ms);
+            }
+        }
+
+        const auto audio_ports = Libraries::AudioOut::GetPortOutStats();
+        if (!audio_ports.empty()) {
+            SeparatorText("Audio info");
+            for (const auto& port : audio_ports) {
+                Text("Port %d: latency %.1f ms, %llu underruns", port.handle,
+                     port.latency_us / 1000.0f, static_cast<unsigned long long>(port.underruns));
+            }
+        }
     }
     End();
 }
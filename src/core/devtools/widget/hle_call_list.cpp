@@ -0,0 +1,80 @@
+//  SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+//  SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hle_call_list.h"
+
+#include <imgui.h>
+
+using namespace ImGui;
+
+namespace Core::Devtools::Widget {
+
+// Merging the counters of every thread is cheap, but not worth doing each frame.
+constexpr double RefreshInterval = 0.5;
+
+void HleCallList::Draw() {
+    SetNextWindowSize({750.0f, 500.0f}, ImGuiCond_FirstUseEver);
+    if (!Begin("HLE Calls", &open)) {
+        End();
+        return;
+    }
+
+    if (GetTime() - last_refresh > RefreshInterval) {
+        stats = HleProfiler::Collect();
+        last_refresh = GetTime();
+    }
+
+    if (Button("Reset")) {
+        HleProfiler::Reset();
+        stats.clear();
+    }
+    SameLine();
+    if (Button("Save report")) {
+        HleProfiler::WriteReport(HleProfiler::ReportPath());
+    }
+    SameLine();
+    InputTextWithHint("##search_hle_call", "Search by name", search_box, sizeof(search_box));
+
+    u64 total_ticks = 0;
+    for (const auto& entry : stats) {
+        total_ticks += entry.ticks;
+    }
+
+    if (BeginTable("HleCallTable", 6,
+                   ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg |
+                       ImGuiTableFlags_ScrollY)) {
+        TableSetupScrollFreeze(0, 1);
+        TableSetupColumn("Function", ImGuiTableColumnFlags_WidthStretch);
+        TableSetupColumn("Library");
+        TableSetupColumn("Calls");
+        TableSetupColumn("Total ms");
+        TableSetupColumn("Avg us");
+        TableSetupColumn("Share");
+        TableHeadersRow();
+
+        for (const auto& entry : stats) {
+            if (search_box[0] != '\0' && !entry.function.contains(search_box)) {
+                continue;
+            }
+            const double total_ms = HleProfiler::TicksToMs(entry.ticks);
+            TableNextRow();
+            TableSetColumnIndex(0);
+            TextUnformatted(entry.function.data(), entry.function.data() + entry.function.size());
+            TableSetColumnIndex(1);
+            TextUnformatted(entry.library.data(), entry.library.data() + entry.library.size());
+            TableSetColumnIndex(2);
+            Text("%llu", static_cast<unsigned long long>(entry.calls));
+            TableSetColumnIndex(3);
+            Text("%.3f", total_ms);
+            TableSetColumnIndex(4);
+            Text("%.3f", total_ms * 1000.0 / entry.calls);
+            TableSetColumnIndex(5);
+            Text("%.2f%%", total_ticks != 0 ? 100.0 * entry.ticks / total_ticks : 0.0);
+        }
+        EndTable();
+    }
+
+    End();
+}
+
+} // namespace Core::Devtools::Widget
@@ -0,0 +1,23 @@
+//  SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+//  SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <vector>
+
+#include "core/hle_profiler.h"
+
+namespace Core::Devtools::Widget {
+
+class HleCallList {
+    std::vector<HleProfiler::FunctionStats> stats{};
+    double last_refresh{};
+    char search_box[128]{};
+
+public:
+    bool open = false;
+
+    void Draw();
+};
+
+} // namespace Core::Devtools::Widget
@@ -1,75 +1,156 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <cstring>
+#include "common/assert.h"
 #include "playgo_chunk.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+PlaygoFile::~PlaygoFile() {
+    Unmap();
+}
+
 bool PlaygoFile::Open(const std::filesystem::path& filepath) {
-    Common::FS::IOFile file(filepath, Common::FS::FileAccessMode::Read);
-    if (file.IsOpen()) {
-        file.Read(playgoHeader);
-        if (LoadChunks(file)) {
-            return true;
-        }
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return false;
+    }
+    // The view keeps the mapping alive on its own.
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        return false;
     }
-    return false;
+    data_size = size.QuadPart;
+#else
+    const int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    data_size = st.st_size;
+#endif
+    data = static_cast<const u8*>(view);
+
+    if (!LoadChunks()) {
+        playgoHeader = {};
+        chunks.clear();
+        chunk_parsed.clear();
+        Unmap();
+        return false;
+    }
+    return true;
 }
 
-bool PlaygoFile::LoadChunks(const Common::FS::IOFile& file) {
-    if (file.IsOpen()) {
-        if (playgoHeader.magic == PLAYGO_MAGIC) {
-            bool ret = true;
+void PlaygoFile::Unmap() {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<u8*>(data), data_size);
+#endif
+    data = nullptr;
+    data_size = 0;
+}
+
+bool PlaygoFile::IsInFile(const chunk_t& table, u64 entry_offset, u64 entry_size) const {
+    return entry_offset + entry_size <= table.length &&
+           u64(table.offset) + table.length <= data_size;
+}
 
-            std::string chunk_attrs_data, chunk_mchunks_data, chunk_labels_data, mchunk_attrs_data;
-            ret = ret && load_chunk_data(file, playgoHeader.chunk_attrs, chunk_attrs_data);
-            ret = ret && load_chunk_data(file, playgoHeader.chunk_mchunks, chunk_mchunks_data);
-            ret = ret && load_chunk_data(file, playgoHeader.chunk_labels, chunk_labels_data);
-            ret = ret && load_chunk_data(file, playgoHeader.mchunk_attrs, mchunk_attrs_data);
+bool PlaygoFile::LoadChunks() {
+    if (data_size < sizeof(PlaygoHeader)) {
+        return false;
+    }
+    std::memcpy(&playgoHeader, data, sizeof(PlaygoHeader));
+    if (playgoHeader.magic != PLAYGO_MAGIC) {
+        return false;
+    }
 
-            if (ret) {
-                chunks.resize(playgoHeader.chunk_count);
+    // Only check that the tables are where the header says, entries are parsed on demand.
+    const u64 chunk_count = playgoHeader.chunk_count;
+    if (!IsInFile(playgoHeader.chunk_attrs, 0,
+                  chunk_count * sizeof(playgo_chunk_attr_entry_t)) ||
+        !IsInFile(playgoHeader.chunk_mchunks, 0, 0) || !IsInFile(playgoHeader.chunk_labels, 0, 0) ||
+        !IsInFile(playgoHeader.mchunk_attrs, 0, 0)) {
+        return false;
+    }
 
-                auto chunk_attrs =
-                    reinterpret_cast<playgo_chunk_attr_entry_t*>(&chunk_attrs_data[0]);
-                auto chunk_mchunks = reinterpret_cast<u16*>(&chunk_mchunks_data[0]);
-                auto chunk_labels = reinterpret_cast<char*>(&chunk_labels_data[0]);
-                auto mchunk_attrs =
-                    reinterpret_cast<playgo_mchunk_attr_entry_t*>(&mchunk_attrs_data[0]);
+    chunks.resize(chunk_count);
+    chunk_parsed.assign(chunk_count, false);
+    return true;
+}
 
-                for (u16 i = 0; i < playgoHeader.chunk_count; i++) {
-                    chunks[i].req_locus = chunk_attrs[i].req_locus;
-                    chunks[i].language_mask = chunk_attrs[i].language_mask;
-                    chunks[i].label_name = std::string(chunk_labels + chunk_attrs[i].label_offset);
+const PlaygoChunk& PlaygoFile::GetChunk(OrbisPlayGoChunkId chunk_id) {
+    ASSERT(chunk_id < chunks.size());
+    std::scoped_lock lk{chunk_mutex};
+    PlaygoChunk& chunk = chunks[chunk_id];
+    if (chunk_parsed[chunk_id]) {
+        return chunk;
+    }
+    chunk_parsed[chunk_id] = true;
 
-                    u64 total_size = 0;
-                    u16 mchunk_count = chunk_attrs[i].mchunk_count;
-                    if (mchunk_count != 0) {
-                        auto mchunks = reinterpret_cast<u16*>(
-                            ((u8*)chunk_mchunks + chunk_attrs[i].mchunks_offset));
-                        for (u16 j = 0; j < mchunk_count; j++) {
-                            u16 mchunk_id = mchunks[j];
-                            total_size += mchunk_attrs[mchunk_id].size.size;
-                        }
-                    }
-                    chunks[i].total_size = total_size;
-                }
-            }
+    playgo_chunk_attr_entry_t attr;
+    std::memcpy(&attr, data + playgoHeader.chunk_attrs.offset + chunk_id * sizeof(attr),
+                sizeof(attr));
+    chunk.req_locus = attr.req_locus;
+    chunk.language_mask = attr.language_mask;
 
-            return ret;
-        }
+    const auto& labels = playgoHeader.chunk_labels;
+    if (attr.label_offset < labels.length) {
+        const auto* label = reinterpret_cast<const char*>(data + labels.offset + attr.label_offset);
+        chunk.label_name = {label, strnlen(label, labels.length - attr.label_offset)};
     }
-    return false;
-}
 
-bool PlaygoFile::load_chunk_data(const Common::FS::IOFile& file, const chunk_t chunk,
-                                 std::string& data) {
-    if (file.IsOpen()) {
-        if (file.Seek(chunk.offset)) {
-            data.resize(chunk.length);
-            if (data.size() == chunk.length) {
-                file.ReadRaw<char>(&data[0], chunk.length);
-                return true;
+    u64 total_size = 0;
+    if (IsInFile(playgoHeader.chunk_mchunks, attr.mchunks_offset,
+                 u64(attr.mchunk_count) * sizeof(u16))) {
+        const u8* mchunks = data + playgoHeader.chunk_mchunks.offset + attr.mchunks_offset;
+        for (u16 j = 0; j < attr.mchunk_count; j++) {
+            u16 mchunk_id;
+            std::memcpy(&mchunk_id, mchunks + j * sizeof(u16), sizeof(u16));
+            const u64 mchunk_offset = u64(mchunk_id) * sizeof(playgo_mchunk_attr_entry_t);
+            if (!IsInFile(playgoHeader.mchunk_attrs, mchunk_offset,
+                          sizeof(playgo_mchunk_attr_entry_t))) {
+                continue;
             }
+            playgo_mchunk_attr_entry_t mchunk;
+            std::memcpy(&mchunk, data + playgoHeader.mchunk_attrs.offset + mchunk_offset,
+                        sizeof(mchunk));
+            total_size += mchunk.size.size;
         }
     }
-    return false;
-}
\ No newline at end of file
+    chunk.total_size = total_size;
+    return chunk;
+}
@@ -4,8 +4,8 @@
 #pragma once
 #include <filesystem>
 #include <mutex>
+#include <string_view>
 #include <vector>
-#include "common/io_file.h"
 #include "core/libraries/playgo/playgo_types.h"
 
 constexpr u32 PLAYGO_MAGIC = 0x6F676C70;
@@ -92,9 +92,11 @@ struct PlaygoChunk {
     u64 req_locus;
     u64 language_mask;
     u64 total_size;
-    std::string label_name;
+    std::string_view label_name;
 };
 
+/// PlayGo chunk index read straight from a read-only mapping of playgo-chunk.dat.
+/// Chunk entries are parsed the first time they are looked up.
 class PlaygoFile {
 public:
     OrbisPlayGoHandle handle = 0;
@@ -104,14 +106,20 @@ public:
     s64 speed_tick = 0;
     OrbisPlayGoEta eta = 0;
     OrbisPlayGoLanguageMask langMask = 0;
-    std::vector<PlaygoChunk> chunks;
+
+    // Simulated streaming install, guarded by the speed mutex. Chunks are installed in id
+    // order and install_offsets holds where each of them ends in the install stream.
+    u64 install_bandwidth = 0; // bytes per second at full speed, 0 when not simulating
+    u64 installed_size = 0;
+    s64 install_tick = 0;
+    std::vector<u64> install_offsets;
+    std::vector<OrbisPlayGoToDo> todo_list;
 
 public:
     explicit PlaygoFile() = default;
-    ~PlaygoFile() = default;
+    ~PlaygoFile();
 
     bool Open(const std::filesystem::path& filepath);
-    bool LoadChunks(const Common::FS::IOFile& file);
 
     PlaygoHeader& GetPlaygoHeader() {
         return playgoHeader;
@@ -120,10 +128,22 @@ public:
         return speed_mutex;
     }
 
+    u32 GetChunkCount() const {
+        return static_cast<u32>(chunks.size());
+    }
+    const PlaygoChunk& GetChunk(OrbisPlayGoChunkId chunk_id);
+
 private:
-    bool load_chunk_data(const Common::FS::IOFile& file, const chunk_t chunk, std::string& data);
+    bool LoadChunks();
+    bool IsInFile(const chunk_t& table, u64 entry_offset, u64 entry_size) const;
+    void Unmap();
 
 private:
-    PlaygoHeader playgoHeader;
+    PlaygoHeader playgoHeader{};
     std::mutex speed_mutex;
+    std::mutex chunk_mutex;
+    std::vector<PlaygoChunk> chunks;
+    std::vector<bool> chunk_parsed;
+    const u8* data = nullptr;
+    u64 data_size = 0;
 };
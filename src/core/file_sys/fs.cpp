@@ -2,7 +2,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include "common/assert.h"
 #include "common/config.h"
+#include "common/logging/log.h"
 #include "common/string_util.h"
 #include "core/file_sys/devices/logger.h"
 #include "core/file_sys/devices/nop_device.h"
@@ -21,11 +23,43 @@ std::string RemoveTrailingSlashes(const std::string& path) {
     return path_sanitized;
 }
 
+std::optional<std::filesystem::path> ResolvedPathCache::Find(const std::string& key) {
+    auto& shard = GetShard(key);
+    std::scoped_lock lock{shard.mutex};
+    const auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        ++misses;
+        return std::nullopt;
+    }
+    ++(it->second.exists ? hits : negative_hits);
+    return it->second.host_path;
+}
+
+void ResolvedPathCache::Insert(const std::string& key, const std::filesystem::path& host_path,
+                               bool exists) {
+    auto& shard = GetShard(key);
+    std::scoped_lock lock{shard.mutex};
+    shard.entries.insert_or_assign(key, Entry{host_path, exists});
+}
+
+void ResolvedPathCache::Clear() {
+    for (auto& shard : shards) {
+        std::scoped_lock lock{shard.mutex};
+        shard.entries.clear();
+    }
+}
+
+ResolvedPathCache::Stats ResolvedPathCache::GetStats() const {
+    return {hits.load(std::memory_order_relaxed), negative_hits.load(std::memory_order_relaxed),
+            misses.load(std::memory_order_relaxed)};
+}
+
 void MntPoints::Mount(const std::filesystem::path& host_folder, const std::string& guest_folder,
                       bool read_only) {
     std::scoped_lock lock{m_mutex};
     const auto guest_folder_sanitized = RemoveTrailingSlashes(guest_folder);
     m_mnt_pairs.emplace_back(host_folder, guest_folder_sanitized, read_only);
+    resolved_cache.Clear();
 }
 
 void MntPoints::Unmount(const std::filesystem::path& host_folder, const std::string& guest_folder) {
@@ -35,11 +69,27 @@ void MntPoints::Unmount(const std::filesystem::path& host_folder, const std::str
         return pair.mount == guest_folder_sanitized;
     });
     m_mnt_pairs.erase(it, m_mnt_pairs.end());
+    resolved_cache.Clear();
 }
 
 void MntPoints::UnmountAll() {
     std::scoped_lock lock{m_mutex};
     m_mnt_pairs.clear();
+    resolved_cache.Clear();
+}
+
+void MntPoints::InvalidatePathCache() {
+    {
+        std::scoped_lock lock{m_mutex};
+        path_cache.clear();
+    }
+    resolved_cache.Clear();
+
+    const auto stats = resolved_cache.GetStats();
+    const u64 total = stats.hits + stats.negative_hits + stats.misses;
+    LOG_DEBUG(Kernel_Fs, "Path cache invalidated: {} hits, {} negative hits, {} misses ({:.1f}%)",
+              stats.hits, stats.negative_hits, stats.misses,
+              total ? 100.0 * (stats.hits + stats.negative_hits) / total : 0.0);
 }
 
 std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_read_only,
@@ -67,23 +117,44 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
         return mount->host_path;
     }
 
+    std::string cache_key = corrected_path;
+    cache_key += force_base_path ? "|base" : "|patch";
+    if (auto cached = resolved_cache.Find(cache_key)) {
+        return *std::move(cached);
+    }
+
+    bool exists = false;
+    auto host_path = ResolveHostPath(corrected_path, *mount, force_base_path, exists);
+    // Files can be created behind the guest's back in writable mounts (e.g by save data), so
+    // only remember misses where nothing but the guest could change the outcome.
+    if (exists || mount->read_only) {
+        resolved_cache.Insert(cache_key, host_path, exists);
+    }
+    return host_path;
+}
+
+std::filesystem::path MntPoints::ResolveHostPath(const std::string& corrected_path,
+                                                 const MntPair& mount, bool force_base_path,
+                                                 bool& exists) {
     // Remove device (e.g /app0) from path to retrieve relative path.
-    const auto rel_path = std::string_view{corrected_path}.substr(mount->mount.size() + 1);
-    std::filesystem::path host_path = mount->host_path / rel_path;
-    std::filesystem::path patch_path = mount->host_path;
+    const auto rel_path = std::string_view{corrected_path}.substr(mount.mount.size() + 1);
+    std::filesystem::path host_path = mount.host_path / rel_path;
+    std::filesystem::path patch_path = mount.host_path;
     patch_path += "-UPDATE";
     if (!std::filesystem::exists(patch_path)) {
-        patch_path = mount->host_path;
+        patch_path = mount.host_path;
         patch_path += "-patch";
     }
     patch_path /= rel_path;
 
     if ((corrected_path.starts_with("/app0") || corrected_path.starts_with("/hostapp")) &&
         !force_base_path && !ignore_game_patches && std::filesystem::exists(patch_path)) {
+        exists = true;
         return patch_path;
     }
 
     if (!NeedsCaseInsensitiveSearch) {
+        exists = std::filesystem::exists(host_path);
         return host_path;
     }
 
@@ -141,10 +212,12 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
 
     if (!force_base_path && !ignore_game_patches) {
         if (const auto path = search(patch_path)) {
+            exists = true;
             return *path;
         }
     }
     if (const auto path = search(host_path)) {
+        exists = true;
         return *path;
     }
 
@@ -190,88 +263,183 @@ void MntPoints::IterateDirectory(std::string_view guest_directory,
     }
 }
 
-int HandleTable::CreateHandle() {
-    std::scoped_lock lock{m_mutex};
+FileRef::~FileRef() {
+    if (file != nullptr) {
+        HandleTable::Unref(file);
+    }
+}
 
-    auto* file = new File{};
-    file->is_opened = false;
+FileRef::FileRef(const FileRef& other) : file{other.file} {
+    if (file != nullptr) {
+        file->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FileRef& FileRef::operator=(const FileRef& other) {
+    FileRef copy{other};
+    std::swap(file, copy.file);
+    return *this;
+}
+
+FileRef& FileRef::operator=(FileRef&& other) noexcept {
+    FileRef moved{std::move(other)};
+    std::swap(file, moved.file);
+    return *this;
+}
+
+HandleTable::~HandleTable() {
+    for (auto& chunk : m_slots) {
+        delete chunk.load(std::memory_order_relaxed);
+    }
+}
 
-    int existingFilesNum = m_files.size();
+int HandleTable::CreateHandle() {
+    std::scoped_lock lock{m_lock};
+
+    File* file;
+    if (!m_free_files.empty()) {
+        file = m_free_files.back();
+        m_free_files.pop_back();
+    } else {
+        auto& chunk = m_file_chunks.emplace_back(std::make_unique<FileChunk>());
+        for (auto it = chunk->rbegin(); it != chunk->rend(); ++it) {
+            it->owner = this;
+            m_free_files.push_back(&*it);
+        }
+        file = m_free_files.back();
+        m_free_files.pop_back();
+    }
 
-    for (int index = 0; index < existingFilesNum; index++) {
-        if (m_files.at(index) == nullptr) {
-            m_files[index] = file;
-            return index;
+    int fd;
+    if (!m_free_fds.empty()) {
+        fd = m_free_fds.back();
+        m_free_fds.pop_back();
+    } else {
+        fd = m_num_slots.load(std::memory_order_relaxed);
+        ASSERT_MSG(fd < MaxHandles, "Out of file descriptors");
+        auto& chunk = m_slots[fd / SlotsPerChunk];
+        if (chunk.load(std::memory_order_relaxed) == nullptr) {
+            chunk.store(new SlotChunk{}, std::memory_order_release);
         }
+        m_num_slots.store(fd + 1, std::memory_order_release);
     }
 
-    m_files.push_back(file);
-    return m_files.size() - 1;
+    file->descriptor = fd;
+    file->ref_count.store(1, std::memory_order_relaxed);
+    (*m_slots[fd / SlotsPerChunk].load(std::memory_order_relaxed))[fd % SlotsPerChunk].store(
+        file, std::memory_order_release);
+    return fd;
 }
 
 void HandleTable::DeleteHandle(int d) {
-    std::scoped_lock lock{m_mutex};
-    delete m_files.at(d);
-    m_files[d] = nullptr;
+    if (d < 0 || d >= m_num_slots.load(std::memory_order_acquire)) {
+        return;
+    }
+    auto& slot = (*m_slots[d / SlotsPerChunk].load(std::memory_order_acquire))[d % SlotsPerChunk];
+    File* file = slot.exchange(nullptr, std::memory_order_acq_rel);
+    if (file == nullptr) {
+        return;
+    }
+    {
+        std::scoped_lock lock{m_lock};
+        m_free_fds.push_back(d);
+    }
+    // Drop the reference held by the descriptor, the file is recycled once the last user is done.
+    Unref(file);
 }
 
-File* HandleTable::GetFile(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
-    }
-    return m_files.at(d);
+bool HandleTable::TryRef(File* file) {
+    u32 count = file->ref_count.load(std::memory_order_relaxed);
+    do {
+        if (count == 0) {
+            return false;
+        }
+    } while (!file->ref_count.compare_exchange_weak(count, count + 1, std::memory_order_acquire,
+                                                    std::memory_order_relaxed));
+    return true;
 }
 
-File* HandleTable::GetSocket(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
-    }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Socket) {
-        return nullptr;
+void HandleTable::Unref(File* file) {
+    if (file->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        file->owner->Recycle(file);
     }
-    return file;
 }
 
-File* HandleTable::GetEpoll(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
+void HandleTable::Recycle(File* file) {
+    // Clear instead of reconstructing, so the strings keep their storage for the next open.
+    file->is_opened = false;
+    file->type = FileType::Regular;
+    file->m_host_name.clear();
+    file->m_guest_name.clear();
+    file->f.Close();
+    file->directory.reset();
+    file->device.reset();
+    file->socket.reset();
+    file->epoll.reset();
+    file->resolver.reset();
+    file->descriptor = -1;
+
+    std::scoped_lock lock{m_lock};
+    m_free_files.push_back(file);
+}
+
+FileRef HandleTable::GetFile(int d) {
+    if (d < 0 || d >= m_num_slots.load(std::memory_order_acquire)) {
+        return {};
     }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Epoll) {
-        return nullptr;
+    auto& slot = (*m_slots[d / SlotsPerChunk].load(std::memory_order_acquire))[d % SlotsPerChunk];
+    while (true) {
+        File* file = slot.load(std::memory_order_acquire);
+        if (file == nullptr) {
+            return {};
+        }
+        if (!TryRef(file)) {
+            // Closed and released while we looked, the slot no longer holds it.
+            continue;
+        }
+        if (slot.load(std::memory_order_acquire) == file) {
+            return FileRef{file};
+        }
+        // Recycled into another descriptor in the meantime.
+        Unref(file);
     }
-    return file;
 }
 
-File* HandleTable::GetResolver(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
-    }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Resolver) {
-        return nullptr;
+FileRef HandleTable::GetFileOfType(int d, FileType type) {
+    auto file = GetFile(d);
+    if (file == nullptr || file->type != type) {
+        return {};
     }
     return file;
 }
 
-File* HandleTable::GetFile(const std::filesystem::path& host_name) {
-    for (auto* file : m_files) {
+FileRef HandleTable::GetSocket(int d) {
+    return GetFileOfType(d, FileType::Socket);
+}
+
+FileRef HandleTable::GetEpoll(int d) {
+    return GetFileOfType(d, FileType::Epoll);
+}
+
+FileRef HandleTable::GetResolver(int d) {
+    return GetFileOfType(d, FileType::Resolver);
+}
+
+FileRef HandleTable::GetFile(const std::filesystem::path& host_name) {
+    const int num_slots = m_num_slots.load(std::memory_order_acquire);
+    for (int d = 0; d < num_slots; d++) {
+        auto file = GetFile(d);
         if (file != nullptr && file->m_host_name == host_name) {
             return file;
         }
     }
-    return nullptr;
+    return {};
 }
 
 void HandleTable::CreateStdHandles() {
     auto setup = [this](const char* path, auto* device) {
         int fd = CreateHandle();
-        auto* file = GetFile(fd);
+        auto file = GetFile(fd);
         file->is_opened = true;
         file->type = FileType::Device;
         file->m_guest_name = path;
@@ -285,13 +453,7 @@ void HandleTable::CreateStdHandles() {
 }
 
 int HandleTable::GetFileDescriptor(File* file) {
-    std::scoped_lock lock{m_mutex};
-    auto it = std::find(m_files.begin(), m_files.end(), file);
-
-    if (it != m_files.end()) {
-        return std::distance(m_files.begin(), it);
-    }
-    return 0;
+    return file != nullptr && file->descriptor >= 0 ? file->descriptor : 0;
 }
 
 } // namespace Core::FileSys
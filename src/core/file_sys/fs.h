@@ -3,13 +3,18 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 #include <tsl/robin_map.h>
 #include "common/io_file.h"
 #include "common/logging/formatter.h"
+#include "common/spin_lock.h"
 #include "core/file_sys/devices/base_device.h"
 #include "core/file_sys/directories/base_directory.h"
 
@@ -21,6 +26,43 @@ struct Resolver;
 
 namespace Core::FileSys {
 
+/// Sharded cache of resolved guest paths, including confirmed misses.
+class ResolvedPathCache {
+public:
+    struct Stats {
+        u64 hits;
+        u64 negative_hits;
+        u64 misses;
+    };
+
+    std::optional<std::filesystem::path> Find(const std::string& key);
+    void Insert(const std::string& key, const std::filesystem::path& host_path, bool exists);
+    void Clear();
+    Stats GetStats() const;
+
+private:
+    static constexpr size_t NumShards = 16;
+
+    struct Entry {
+        std::filesystem::path host_path;
+        bool exists;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        tsl::robin_map<std::string, Entry> entries;
+    };
+
+    Shard& GetShard(const std::string& key) {
+        return shards[std::hash<std::string>{}(key) % NumShards];
+    }
+
+    std::array<Shard, NumShards> shards;
+    std::atomic<u64> hits{};
+    std::atomic<u64> negative_hits{};
+    std::atomic<u64> misses{};
+};
+
 class MntPoints {
 #ifdef _WIN64
     static constexpr bool NeedsCaseInsensitiveSearch = false;
@@ -50,6 +92,10 @@ public:
     void IterateDirectory(std::string_view guest_directory,
                           const IterateDirectoryCallback& callback);
 
+    /// Drops all cached path resolutions, must be called after the guest changes the layout
+    /// of a mounted directory.
+    void InvalidatePathCache();
+
     const MntPair* GetMountFromHostPath(const std::string& host_path) {
         std::scoped_lock lock{m_mutex};
         const auto it = std::ranges::find_if(m_mnt_pairs, [&](const MntPair& mount) {
@@ -69,9 +115,13 @@ public:
     }
 
 private:
+    std::filesystem::path ResolveHostPath(const std::string& corrected_path, const MntPair& mount,
+                                          bool force_base_path, bool& exists);
+
     std::vector<MntPair> m_mnt_pairs;
     std::vector<std::filesystem::path> path_parts;
     tsl::robin_map<std::filesystem::path, std::filesystem::path> path_cache;
+    ResolvedPathCache resolved_cache;
     std::mutex m_mutex;
 };
 
@@ -84,6 +134,8 @@ enum class FileType {
     Resolver
 };
 
+class HandleTable;
+
 struct File {
     std::atomic_bool is_opened{};
     std::atomic<FileType> type{FileType::Regular};
@@ -96,27 +148,93 @@ struct File {
     std::shared_ptr<Libraries::Net::Socket> socket;        // only valid for type == Socket
     std::shared_ptr<Libraries::Net::Epoll> epoll;          // only valid for type == Epoll
     std::shared_ptr<Libraries::Net::Resolver> resolver;    // only valid for type == Resolver
+
+private:
+    friend class HandleTable;
+    friend class FileRef;
+
+    // Managed by the handle table. Files are pooled and never freed while the table lives,
+    // so the counter stays valid to probe even after the file is recycled.
+    std::atomic<u32> ref_count{};
+    int descriptor{-1};
+    HandleTable* owner{};
+};
+
+/// Counted reference to a file. The file object is not recycled while referenced, even if its
+/// descriptor is closed concurrently.
+class FileRef {
+public:
+    FileRef() = default;
+    FileRef(std::nullptr_t) {}
+    ~FileRef();
+
+    FileRef(const FileRef& other);
+    FileRef& operator=(const FileRef& other);
+    FileRef(FileRef&& other) noexcept : file{std::exchange(other.file, nullptr)} {}
+    FileRef& operator=(FileRef&& other) noexcept;
+
+    File* get() const {
+        return file;
+    }
+    File* operator->() const {
+        return file;
+    }
+    File& operator*() const {
+        return *file;
+    }
+    operator File*() const {
+        return file;
+    }
+
+private:
+    friend class HandleTable;
+
+    /// Adopts a reference that was already taken on `file`.
+    explicit FileRef(File* file_) : file{file_} {}
+
+    File* file{};
 };
 
 class HandleTable {
 public:
     HandleTable() = default;
-    virtual ~HandleTable() = default;
+    virtual ~HandleTable();
 
     int CreateHandle();
     void DeleteHandle(int d);
-    File* GetFile(int d);
-    File* GetSocket(int d);
-    File* GetEpoll(int d);
-    File* GetResolver(int d);
-    File* GetFile(const std::filesystem::path& host_name);
+    FileRef GetFile(int d);
+    FileRef GetSocket(int d);
+    FileRef GetEpoll(int d);
+    FileRef GetResolver(int d);
+    FileRef GetFile(const std::filesystem::path& host_name);
     int GetFileDescriptor(File* file);
 
     void CreateStdHandles();
 
 private:
-    std::vector<File*> m_files;
-    std::mutex m_mutex;
+    friend class FileRef;
+
+    static constexpr u32 SlotsPerChunk = 1024;
+    static constexpr u32 MaxSlotChunks = 1024;
+    static constexpr u32 MaxHandles = SlotsPerChunk * MaxSlotChunks;
+    static constexpr u32 FilesPerChunk = 64;
+
+    using SlotChunk = std::array<std::atomic<File*>, SlotsPerChunk>;
+    using FileChunk = std::array<File, FilesPerChunk>;
+
+    FileRef GetFileOfType(int d, FileType type);
+    static bool TryRef(File* file);
+    static void Unref(File* file);
+    void Recycle(File* file);
+
+    // Descriptor slots are published once and only freed with the table, so lookups are
+    // two atomic loads and never take a lock.
+    std::array<std::atomic<SlotChunk*>, MaxSlotChunks> m_slots{};
+    std::atomic<int> m_num_slots{};
+    Common::SpinLock m_lock;
+    std::vector<int> m_free_fds;
+    std::vector<File*> m_free_files;
+    std::vector<std::unique_ptr<FileChunk>> m_file_chunks;
 };
 
 } // namespace Core::FileSys
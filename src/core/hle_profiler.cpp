@@ -0,0 +1,216 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <fmt/format.h>
+
+#include "common/config.h"
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/native_clock.h"
+#include "common/path_util.h"
+#include "core/hle_profiler.h"
+#include "core/libraries/kernel/time.h"
+
+namespace Core::HleProfiler {
+
+namespace {
+
+constexpr u32 PageBits = 10;
+constexpr u32 PageSize = 1U << PageBits;
+constexpr u32 NumPages = MaxFunctions / PageSize;
+
+struct Counter {
+    std::atomic<u64> calls;
+    std::atomic<u64> ticks;
+};
+
+using Page = std::array<Counter, PageSize>;
+
+/// Counters owned by one thread at a time, only the owner writes them. Pages are allocated
+/// as the thread first calls into them, and the counters are handed over to a new thread
+/// once the owner exits so the list only grows with the peak number of threads.
+struct ThreadCounters {
+    std::array<std::atomic<Page*>, NumPages> pages{};
+    std::atomic<bool> in_use{true};
+    ThreadCounters* next{};
+};
+
+struct FunctionInfo {
+    const char* function;
+    const char* library;
+};
+
+std::mutex register_mutex;
+std::array<FunctionInfo, MaxFunctions> functions{};
+std::atomic<u32> num_functions{0};
+
+std::atomic<ThreadCounters*> thread_counters{nullptr};
+
+std::mutex baseline_mutex;
+std::vector<FunctionStats> baseline;
+
+ThreadCounters* AcquireThreadCounters() {
+    for (auto* counters = thread_counters.load(std::memory_order_acquire); counters != nullptr;
+         counters = counters->next) {
+        bool in_use = false;
+        if (counters->in_use.compare_exchange_strong(in_use, true, std::memory_order_acq_rel)) {
+            return counters;
+        }
+    }
+    auto* counters = new ThreadCounters{};
+    counters->next = thread_counters.load(std::memory_order_relaxed);
+    while (!thread_counters.compare_exchange_weak(counters->next, counters,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+    }
+    return counters;
+}
+
+struct ThreadCountersRef {
+    ThreadCounters* counters = AcquireThreadCounters();
+
+    ~ThreadCountersRef() {
+        counters->in_use.store(false, std::memory_order_release);
+    }
+};
+
+ThreadCounters& GetThreadCounters() {
+    thread_local ThreadCountersRef ref;
+    return *ref.counters;
+}
+
+/// Sums the counters of every thread, without applying the baseline.
+std::vector<FunctionStats> Sum() {
+    const u32 count = num_functions.load(std::memory_order_acquire);
+    std::vector<FunctionStats> stats(count);
+    for (u32 slot = 0; slot < count; ++slot) {
+        stats[slot].function = functions[slot].function;
+        stats[slot].library = functions[slot].library;
+    }
+    for (auto* counters = thread_counters.load(std::memory_order_acquire); counters != nullptr;
+         counters = counters->next) {
+        for (u32 page_index = 0; page_index < NumPages; ++page_index) {
+            const Page* page = counters->pages[page_index].load(std::memory_order_acquire);
+            if (page == nullptr) {
+                continue;
+            }
+            const u32 first = page_index * PageSize;
+            const u32 last = std::min(count, first + PageSize);
+            for (u32 slot = first; slot < last; ++slot) {
+                const Counter& counter = (*page)[slot - first];
+                stats[slot].calls += counter.calls.load(std::memory_order_relaxed);
+                stats[slot].ticks += counter.ticks.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return stats;
+}
+
+} // Anonymous namespace
+
+std::filesystem::path ReportPath() {
+    return Common::FS::GetUserPath(Common::FS::PathType::LogDir) / "hle_profile.txt";
+}
+
+bool IsEnabled() {
+    static const bool enabled = [] {
+        if (!Config::hleProfilerEnabled()) {
+            return false;
+        }
+        LOG_INFO(Core, "Profiling HLE calls, report will be written to {}",
+                 ReportPath().string());
+        std::at_quick_exit([] { WriteReport(ReportPath()); });
+        return true;
+    }();
+    return enabled;
+}
+
+u32 RegisterFunction(const char* function, const char* library) {
+    std::scoped_lock lk{register_mutex};
+    const u32 slot = num_functions.load(std::memory_order_relaxed);
+    if (slot == MaxFunctions) {
+        LOG_WARNING(Core, "Out of HLE profiler slots, not profiling {}", function);
+        return InvalidSlot;
+    }
+    functions[slot] = {function, library};
+    num_functions.store(slot + 1, std::memory_order_release);
+    return slot;
+}
+
+void RecordCall(u32 slot, u64 ticks) {
+    if (slot >= MaxFunctions) {
+        return;
+    }
+    ThreadCounters& counters = GetThreadCounters();
+    auto& page_ref = counters.pages[slot >> PageBits];
+    Page* page = page_ref.load(std::memory_order_relaxed);
+    if (page == nullptr) {
+        page = new Page{};
+        page_ref.store(page, std::memory_order_release);
+    }
+    // Only this thread writes the counter, readers merely need untorn values.
+    Counter& counter = (*page)[slot & (PageSize - 1)];
+    counter.calls.store(counter.calls.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+    counter.ticks.store(counter.ticks.load(std::memory_order_relaxed) + ticks,
+                        std::memory_order_relaxed);
+}
+
+std::vector<FunctionStats> Collect() {
+    auto stats = Sum();
+    {
+        std::scoped_lock lk{baseline_mutex};
+        const size_t count = std::min(stats.size(), baseline.size());
+        for (size_t slot = 0; slot < count; ++slot) {
+            stats[slot].calls -= baseline[slot].calls;
+            stats[slot].ticks -= baseline[slot].ticks;
+        }
+    }
+    std::erase_if(stats, [](const FunctionStats& entry) { return entry.calls == 0; });
+    std::ranges::sort(stats, std::greater{}, &FunctionStats::ticks);
+    return stats;
+}
+
+void Reset() {
+    auto stats = Sum();
+    std::scoped_lock lk{baseline_mutex};
+    baseline = std::move(stats);
+}
+
+double TicksToMs(u64 ticks) {
+    const auto* clock = Libraries::Kernel::Dev::GetClock();
+    if (clock == nullptr || clock->GetTscFrequency() == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(ticks) * 1000.0 / static_cast<double>(clock->GetTscFrequency());
+}
+
+void WriteReport(const std::filesystem::path& path) {
+    const auto stats = Collect();
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write,
+                            Common::FS::FileType::TextFile};
+    if (!file.IsOpen()) {
+        return;
+    }
+    u64 total_ticks = 0;
+    for (const auto& entry : stats) {
+        total_ticks += entry.ticks;
+    }
+    file.WriteString(fmt::format("{:<56} {:<28} {:>12} {:>12} {:>10} {:>7}\n", "Function",
+                                 "Library", "Calls", "Total ms", "Avg us", "Share"));
+    for (const auto& entry : stats) {
+        const double total_ms = TicksToMs(entry.ticks);
+        const double share = total_ticks != 0 ? 100.0 * entry.ticks / total_ticks : 0.0;
+        file.WriteString(fmt::format("{:<56} {:<28} {:>12} {:>12.3f} {:>10.3f} {:>6.2f}%\n",
+                                     entry.function, entry.library, entry.calls, total_ms,
+                                     total_ms * 1000.0 / entry.calls, share));
+    }
+}
+
+} // namespace Core::HleProfiler
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "common/rdtsc.h"
+#include "common/types.h"
+
+namespace Core::HleProfiler {
+
+/// Upper bound of profiled functions, comfortably above what the HLE libraries register.
+constexpr u32 MaxFunctions = 8192;
+constexpr u32 InvalidSlot = ~0U;
+
+struct FunctionStats {
+    std::string_view function;
+    std::string_view library;
+    u64 calls;
+    u64 ticks; ///< Host time spent inside the function, including nested HLE calls.
+};
+
+/// Whether LIB_FUNCTION registers functions through the profiling wrapper. Fixed on first use.
+bool IsEnabled();
+
+/// Allocates the counters of a function. Returns InvalidSlot once all of them are taken.
+u32 RegisterFunction(const char* function, const char* library);
+
+/// Adds a call to the counters of the calling thread.
+void RecordCall(u32 slot, u64 ticks);
+
+/// Sums up the counters of all threads since the last reset, most expensive functions first.
+std::vector<FunctionStats> Collect();
+
+/// Makes Collect count from zero again.
+void Reset();
+
+double TicksToMs(u64 ticks);
+
+/// Where the report is written on exit.
+std::filesystem::path ReportPath();
+
+/// Writes the collected stats as a text table.
+void WriteReport(const std::filesystem::path& path);
+
+template <class F, F f>
+struct ProfiledCallWrapperImpl;
+
+template <class ReturnType, class... Args, PS4_SYSV_ABI ReturnType (*func)(Args...)>
+struct ProfiledCallWrapperImpl<PS4_SYSV_ABI ReturnType (*)(Args...), func> {
+    struct ScopedCall {
+        u64 start = Common::FencedRDTSC();
+
+        ~ScopedCall() {
+            RecordCall(slot, Common::FencedRDTSC() - start);
+        }
+    };
+
+    static ReturnType PS4_SYSV_ABI wrap(Args... args) {
+        const ScopedCall call{};
+        return func(args...);
+    }
+
+    static auto Register(const char* function, const char* library) {
+        // Functions exported under several NIDs share their counters.
+        if (slot == InvalidSlot) {
+            slot = RegisterFunction(function, library);
+        }
+        return &wrap;
+    }
+
+    static inline u32 slot = InvalidSlot;
+};
+
+#define HLE_PROFILED_CALL(func, lib)                                                               \
+    (Core::HleProfiler::ProfiledCallWrapperImpl<decltype(&(func)), func>::Register(#func, lib))
+
+} // namespace Core::HleProfiler
@@ -24,6 +24,13 @@ std::array<PortOut, SCE_AUDIO_OUT_NUM_PORTS> ports_out{};
 
 static std::unique_ptr<AudioOutBackend> audio;
 
+// The ring holds up to this many grains, which also caps the adaptive latency target.
+static constexpr u32 MaxQueuedGrains = 8;
+static constexpr u32 InitialTargetGrains = 2;
+static constexpr u32 MinTargetGrains = 1;
+// Grains without an underrun before the latency target is lowered again.
+static constexpr u32 StableGrainsBeforeLowering = 2000;
+
 static AudioFormatInfo GetFormatInfo(const OrbisAudioOutParamFormat format) {
     static constexpr std::array<AudioFormatInfo, 8> format_infos = {{
         // S16Mono
@@ -99,18 +106,21 @@ int PS4_SYSV_ABI sceAudioOutClose(s32 handle) {
 
     std::unique_lock open_lock{port_open_mutex};
     auto& port = ports_out.at(handle - 1);
+    if (!port.IsOpen()) {
+        return ORBIS_AUDIO_OUT_ERROR_INVALID_PORT;
+    }
+    port.is_open.store(false, std::memory_order_release);
+    // Release a game thread waiting for room in the ring.
+    port.consumed_grains.fetch_add(1, std::memory_order_release);
+    port.consumed_grains.notify_all();
+    // Stop outside of port lock scope to prevent deadlocks.
+    port.output_thread.Stop();
+    LOG_INFO(Lib_AudioOut, "Port {} closed after {} underruns", handle,
+             port.underrun_count.load());
     {
         std::unique_lock lock{port.mutex};
-        if (!port.IsOpen()) {
-            return ORBIS_AUDIO_OUT_ERROR_INVALID_PORT;
-        }
-        std::free(port.output_buffer);
-        port.output_buffer = nullptr;
-        port.output_ready = false;
         port.impl = nullptr;
     }
-    // Stop outside of port lock scope to prevent deadlocks.
-    port.output_thread.Stop();
     return ORBIS_OK;
 }
 
@@ -255,7 +265,12 @@ int PS4_SYSV_ABI sceAudioOutInit() {
     if (audio != nullptr) {
         return ORBIS_AUDIO_OUT_ERROR_ALREADY_INIT;
     }
-    audio = std::make_unique<SDLAudioOut>();
+    if (Config::getAudioBackend() == "Null") {
+        LOG_INFO(Lib_AudioOut, "Using null audio backend");
+        audio = std::make_unique<NullAudioOut>();
+    } else {
+        audio = std::make_unique<SDLAudioOut>();
+    }
     return ORBIS_OK;
 }
 
@@ -295,18 +310,44 @@ static void AudioOutputThread(PortOut* port, const std::stop_token& stop) {
         Common::SetCurrentThreadName(thread_name.c_str());
     }
 
+    const u32 buffer_size = port->BufferSize();
+    const u64 grain_us = 1000000ULL * port->buffer_frames / port->sample_rate;
     Common::AccurateTimer timer(
         std::chrono::nanoseconds(1000000000ULL * port->buffer_frames / port->sample_rate));
+    // Underruns only count once the game has started submitting, and once per gap.
+    bool streaming = false;
+    u32 stable_grains = 0;
     while (true) {
         timer.Start();
-        {
-            std::unique_lock lock{port->mutex};
-            if (port->output_ready) {
-                port->impl->Output(port->output_buffer);
-                port->output_ready = false;
+        const size_t queued = port->ring->Size();
+        port->latency_us.store(static_cast<u32>(queued / buffer_size * grain_us),
+                               std::memory_order_relaxed);
+        if (queued >= buffer_size) {
+            port->ring->Pop(port->output_buffer);
+            port->impl->Output(port->output_buffer.data());
+            port->consumed_grains.fetch_add(1, std::memory_order_release);
+            port->consumed_grains.notify_all();
+            streaming = true;
+
+            const u32 target = port->target_grains.load(std::memory_order_relaxed);
+            if (++stable_grains >= StableGrainsBeforeLowering && target > MinTargetGrains) {
+                port->target_grains.store(target - 1, std::memory_order_relaxed);
+                stable_grains = 0;
+                LOG_DEBUG(Lib_AudioOut, "Port {} latency target lowered to {} grains",
+                          fmt::ptr(port), target - 1);
             }
+        } else if (streaming) {
+            // The game missed its slot, let it queue further ahead from now on.
+            streaming = false;
+            stable_grains = 0;
+            const u64 underruns = port->underrun_count.fetch_add(1, std::memory_order_relaxed) + 1;
+            const u32 target = port->target_grains.load(std::memory_order_relaxed);
+            if (target < MaxQueuedGrains) {
+                port->target_grains.store(target + 1, std::memory_order_relaxed);
+            }
+            LOG_DEBUG(Lib_AudioOut, "Port {} underrun #{}, latency target {} grains",
+                      fmt::ptr(port), underruns, std::min(target + 1, MaxQueuedGrains));
         }
-        port->output_cv.notify_one();
         if (stop.stop_requested()) {
             break;
         }
@@ -377,8 +418,12 @@ s32 PS4_SYSV_ABI sceAudioOutOpen(UserService::OrbisUserServiceUserId user_id,
 
         port->impl = audio->Open(*port);
 
-        port->output_buffer = std::malloc(port->BufferSize());
-        port->output_ready = false;
+        port->ring = std::make_unique<Common::RingBuffer<u8>>(MaxQueuedGrains * port->BufferSize());
+        port->output_buffer.resize(port->BufferSize());
+        port->target_grains.store(InitialTargetGrains);
+        port->underrun_count.store(0);
+        port->latency_us.store(0);
+        port->is_open.store(true, std::memory_order_release);
         port->output_thread.Run(
             [port](const std::stop_token& stop) { AudioOutputThread(&*port, stop); });
     }
@@ -398,22 +443,33 @@ s32 PS4_SYSV_ABI sceAudioOutOutput(s32 handle, void* ptr) {
         return ORBIS_AUDIO_OUT_ERROR_INVALID_PORT;
     }
 
-    auto samples_sent = 0;
     auto& port = ports_out.at(handle - 1);
-    {
-        std::unique_lock lock{port.mutex};
-        if (!port.IsOpen()) {
-            return ORBIS_AUDIO_OUT_ERROR_INVALID_PORT;
-        }
-        port.output_cv.wait(lock, [&] { return !port.output_ready; });
-        if (ptr != nullptr && port.IsOpen()) {
-            std::memcpy(port.output_buffer, ptr, port.BufferSize());
-            port.output_ready = true;
-            port.last_output_time = Kernel::sceKernelGetProcessTime();
-            samples_sent = port.buffer_frames * port.format_info.num_channels;
+    if (!port.IsOpen()) {
+        return ORBIS_AUDIO_OUT_ERROR_INVALID_PORT;
+    }
+
+    // Block while the game is the latency target ahead of the output thread. A null pointer
+    // waits for everything queued to be played instead.
+    const u32 buffer_size = port.BufferSize();
+    const auto has_room = [&] {
+        const size_t queued = port.ring->Size();
+        return ptr != nullptr
+                   ? queued < port.target_grains.load(std::memory_order_relaxed) * buffer_size
+                   : queued == 0;
+    };
+    while (port.IsOpen() && !has_room()) {
+        const u64 consumed = port.consumed_grains.load(std::memory_order_acquire);
+        if (has_room()) {
+            break;
         }
+        port.consumed_grains.wait(consumed, std::memory_order_acquire);
     }
-    return samples_sent;
+    if (ptr == nullptr || !port.IsOpen()) {
+        return 0;
+    }
+    port.ring->Push({static_cast<const u8*>(ptr), buffer_size});
+    port.last_output_time = Kernel::sceKernelGetProcessTime();
+    return port.buffer_frames * port.format_info.num_channels;
 }
 
 int PS4_SYSV_ABI sceAudioOutOutputs(OrbisAudioOutOutputParam* param, u32 num) {
@@ -556,6 +612,22 @@ void AdjustVol() {
     }
 }
 
+std::vector<PortOutStats> GetPortOutStats() {
+    std::vector<PortOutStats> stats;
+    for (size_t i = 0; i < ports_out.size(); i++) {
+        const auto& port = ports_out[i];
+        if (!port.IsOpen()) {
+            continue;
+        }
+        stats.push_back({
+            .handle = static_cast<s32>(i + 1),
+            .latency_us = port.latency_us.load(std::memory_order_relaxed),
+            .underruns = port.underrun_count.load(std::memory_order_relaxed),
+        });
+    }
+    return stats;
+}
+
 int PS4_SYSV_ABI sceAudioOutSetVolumeDown() {
     LOG_ERROR(Lib_AudioOut, "(STUBBED) called");
     return ORBIS_OK;
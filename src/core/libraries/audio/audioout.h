@@ -3,11 +3,13 @@
 
 #pragma once
 
-#include <condition_variable>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "common/bit_field.h"
+#include "common/ring_buffer.h"
 #include "core/libraries/kernel/threads.h"
 #include "core/libraries/system/userservice.h"
 
@@ -83,15 +85,30 @@ struct AudioFormatInfo {
     }
 };
 
+struct PortOutStats {
+    s32 handle;
+    u32 latency_us; ///< Audio queued ahead of the host output.
+    u64 underruns;
+};
+
 struct PortOut {
     std::mutex mutex;
     std::unique_ptr<PortBackend> impl{};
-
-    void* output_buffer;
-    std::condition_variable_any output_cv;
-    bool output_ready;
+    std::atomic<bool> is_open{};
+
+    /// Grains queued by the game, drained by the output thread once per grain period.
+    std::unique_ptr<Common::RingBuffer<u8>> ring;
+    std::vector<u8> output_buffer;
+    /// Bumped for every grain the output thread consumes, games wait on it for room in the ring.
+    std::atomic<u64> consumed_grains{};
+    /// Number of grains the game may queue ahead, raised on underruns and lowered when stable.
+    std::atomic<u32> target_grains{};
     Kernel::Thread output_thread{};
 
+    /// Reported by GetPortOutStats for the debug overlay.
+    std::atomic<u64> underrun_count{};
+    std::atomic<u32> latency_us{};
+
     OrbisAudioOutPort type;
     AudioFormatInfo format_info;
     u32 sample_rate;
@@ -100,7 +117,7 @@ struct PortOut {
     std::array<s32, 8> volume;
 
     [[nodiscard]] bool IsOpen() const {
-        return impl != nullptr;
+        return is_open.load(std::memory_order_acquire);
     }
 
     [[nodiscard]] u32 BufferSize() const {
@@ -183,5 +200,9 @@ int PS4_SYSV_ABI sceAudioOutSparkControlSetEqCoef();
 int PS4_SYSV_ABI sceAudioOutSetSystemDebugState();
 
 void AdjustVol();
+
+/// Latency and underrun counters of the open output ports.
+std::vector<PortOutStats> GetPortOutStats();
+
 void RegisterLib(Core::Loader::SymbolsResolver* sym);
 } // namespace Libraries::AudioOut
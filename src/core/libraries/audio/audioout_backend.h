@@ -31,4 +31,10 @@ public:
     std::unique_ptr<PortBackend> Open(PortOut& port) override;
 };
 
+/// Discards all output. The output threads still pace the game, so this runs headless.
+class NullAudioOut final : public AudioOutBackend {
+public:
+    std::unique_ptr<PortBackend> Open(PortOut& port) override;
+};
+
 } // namespace Libraries::AudioOut
@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "core/libraries/audio/audioout.h"
+#include "core/libraries/audio/audioout_backend.h"
+
+namespace Libraries::AudioOut {
+
+class NullPortBackend : public PortBackend {
+public:
+    void Output(void* ptr) override {}
+
+    void SetVolume(const std::array<int, 8>& ch_volumes) override {}
+};
+
+std::unique_ptr<PortBackend> NullAudioOut::Open(PortOut& port) {
+    return std::make_unique<NullPortBackend>();
+}
+
+} // namespace Libraries::AudioOut
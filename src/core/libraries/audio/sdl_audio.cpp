@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <cmath>
 #include <thread>
 #include <SDL3/SDL_audio.h>
 #include <SDL3/SDL_hints.h>
@@ -14,6 +15,13 @@
 #define SDL_INVALID_AUDIODEVICEID 0 // Defined in SDL_audio.h but not made a macro
 namespace Libraries::AudioOut {
 
+// Drift compensation: the playback rate is nudged by up to MaxDriftCorrection, proportionally
+// to how far the smoothed host queue is off its target.
+static constexpr float DriftGain = 0.01f;
+static constexpr float DriftSmoothing = 0.05f;
+static constexpr float MaxDriftCorrection = 0.01f;
+static constexpr float MinRatioChange = 0.0005f;
+
 class SDLPortBackend : public PortBackend {
 public:
     explicit SDLPortBackend(const PortOut& port)
@@ -63,7 +71,7 @@ public:
             LOG_ERROR(Lib_AudioOut, "Failed to create SDL audio stream: {}", SDL_GetError());
             return;
         }
-        CalculateQueueThreshold();
+        CalculateQueueTarget();
         if (!SDL_SetAudioStreamInputChannelMap(stream, port.format_info.channel_layout.data(),
                                                port.format_info.num_channels)) {
             LOG_ERROR(Lib_AudioOut, "Failed to configure SDL audio stream channel map: {}",
@@ -93,15 +101,17 @@ public:
         if (!stream) {
             return;
         }
-        // AudioOut library manages timing, but we still need to guard against the SDL
-        // audio queue stalling, which may happen during device changes, for example.
-        // Otherwise, latency may grow over time unbounded.
+        // AudioOut library manages timing, small drift between the guest and host clocks is
+        // absorbed by resampling. Only a stalled device, which may happen during device
+        // changes for example, backs the queue up far enough to drop it.
         if (const auto queued = SDL_GetAudioStreamQueued(stream); queued >= queue_threshold) {
             LOG_INFO(Lib_AudioOut, "SDL audio queue backed up ({} queued, {} threshold), clearing.",
                      queued, queue_threshold);
             SDL_ClearAudioStream(stream);
-            // Recalculate the threshold in case this happened because of a device change.
-            CalculateQueueThreshold();
+            // Recalculate the target in case this happened because of a device change.
+            CalculateQueueTarget();
+        } else if (queued >= 0) {
+            CompensateDrift(queued);
         }
         if (!SDL_PutAudioStreamData(stream, ptr, static_cast<int>(guest_buffer_size))) {
             LOG_ERROR(Lib_AudioOut, "Failed to output to SDL audio stream: {}", SDL_GetError());
@@ -122,7 +132,24 @@ public:
     }
 
 private:
-    void CalculateQueueThreshold() {
+    void CompensateDrift(int queued) {
+        const float error = static_cast<float>(queued - static_cast<int>(queue_target)) /
+                            static_cast<float>(queue_target);
+        smoothed_error += (error - smoothed_error) * DriftSmoothing;
+        const float ratio =
+            1.0f + std::clamp(smoothed_error * DriftGain, -MaxDriftCorrection, MaxDriftCorrection);
+        if (std::abs(ratio - frequency_ratio) < MinRatioChange) {
+            return;
+        }
+        if (!SDL_SetAudioStreamFrequencyRatio(stream, ratio)) {
+            LOG_WARNING(Lib_AudioOut, "Failed to set SDL audio stream frequency ratio: {}",
+                        SDL_GetError());
+            return;
+        }
+        frequency_ratio = ratio;
+    }
+
+    void CalculateQueueTarget() {
         SDL_AudioSpec discard;
         int sdl_buffer_frames;
         if (!SDL_GetAudioDeviceFormat(SDL_GetAudioStreamDevice(stream), &discard,
@@ -132,20 +159,25 @@ private:
             sdl_buffer_frames = 0;
         }
         const auto sdl_buffer_size = sdl_buffer_frames * frame_size;
-        const auto new_threshold = std::max(guest_buffer_size, sdl_buffer_size) * 4;
-        if (host_buffer_size != sdl_buffer_size || queue_threshold != new_threshold) {
+        const auto new_target = std::max(guest_buffer_size, sdl_buffer_size) * 2;
+        smoothed_error = 0.0f;
+        if (host_buffer_size != sdl_buffer_size || queue_target != new_target) {
             host_buffer_size = sdl_buffer_size;
-            queue_threshold = new_threshold;
+            queue_target = new_target;
+            queue_threshold = new_target * 8;
             LOG_INFO(Lib_AudioOut,
-                     "SDL audio buffers: guest = {} bytes, host = {} bytes, threshold = {} bytes",
-                     guest_buffer_size, host_buffer_size, queue_threshold);
+                     "SDL audio buffers: guest = {} bytes, host = {} bytes, target = {} bytes",
+                     guest_buffer_size, host_buffer_size, queue_target);
         }
     }
 
     u32 frame_size;
     u32 guest_buffer_size;
     u32 host_buffer_size{};
+    u32 queue_target{};
     u32 queue_threshold{};
+    float smoothed_error{};
+    float frequency_ratio{1.0f};
     SDL_AudioStream* stream{};
 };
 
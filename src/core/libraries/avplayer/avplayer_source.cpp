@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <thread>
+
 #include "common/alignment.h"
 #include "common/singleton.h"
 #include "common/thread.h"
@@ -23,6 +26,13 @@ extern "C" {
 
 namespace Libraries::AvPlayer {
 
+// Packets buffered ahead of the decoders before the demuxer waits for them to catch up.
+static constexpr size_t MaxQueuedVideoPackets = 30;
+static constexpr size_t MaxQueuedAudioPackets = 8;
+
+// Upper bound on FFmpeg worker threads per video decoder, guest threads need the cores too.
+static constexpr u32 MaxVideoDecoderThreads = 8;
+
 AvPlayerSource::AvPlayerSource(AvPlayerStateCallback& state, bool use_vdec2)
     : m_state(state), m_use_vdec2(use_vdec2) {}
 
@@ -214,6 +224,10 @@ bool AvPlayerSource::Start() {
                       m_video_stream_index.value());
             return false;
         }
+        // High bitrate 1080p/4K cutscenes can't be decoded in real time by a single thread.
+        m_video_codec_context->thread_count =
+            std::clamp(std::thread::hardware_concurrency() / 2, 1u, MaxVideoDecoderThreads);
+        m_video_codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
         if (avcodec_open2(m_video_codec_context.get(), decoder, nullptr) < 0) {
             LOG_ERROR(Lib_AvPlayer, "Could not open avcodec for video stream {}.",
                       m_video_stream_index.value());
@@ -452,9 +466,12 @@ void AvPlayerSource::DemuxerThread(std::stop_token stop) {
     LOG_INFO(Lib_AvPlayer, "Demuxer Thread started");
 
     while (!stop.stop_requested()) {
-        if (m_video_packets.Size() > 30 &&
-            (!m_audio_stream_index.has_value() || m_audio_packets.Size() > 8)) {
-            std::this_thread::sleep_for(milliseconds(5));
+        // Decoders notify us whenever they consume a packet.
+        if (!m_demuxer_cv.Wait(stop, [this] {
+                return m_video_packets.Size() <= MaxQueuedVideoPackets ||
+                       (m_audio_stream_index.has_value() &&
+                        m_audio_packets.Size() <= MaxQueuedAudioPackets);
+            })) {
             continue;
         }
         AVPacketPtr up_packet(av_packet_alloc(), &ReleaseAVPacket);
@@ -512,81 +529,68 @@ void AvPlayerSource::DemuxerThread(std::stop_token stop) {
     LOG_INFO(Lib_AvPlayer, "Demuxer Thread exited normally");
 }
 
-AvPlayerSource::AVFramePtr AvPlayerSource::ConvertVideoFrame(const AVFrame& frame) {
-    auto nv12_frame = AVFramePtr{av_frame_alloc(), &ReleaseAVFrame};
-    nv12_frame->pts = frame.pts;
-    nv12_frame->pkt_dts = frame.pkt_dts < 0 ? 0 : frame.pkt_dts;
-    nv12_frame->format = AV_PIX_FMT_NV12;
-    nv12_frame->width = frame.width;
-    nv12_frame->height = frame.height;
-    nv12_frame->sample_aspect_ratio = frame.sample_aspect_ratio;
-    nv12_frame->crop_top = frame.crop_top;
-    nv12_frame->crop_bottom = frame.crop_bottom;
-    nv12_frame->crop_left = frame.crop_left;
-    nv12_frame->crop_right = frame.crop_right;
+static void CopyNV12Data(u8* dst, const AVFrame& src, u32 width, u32 height) {
+    if (u32(src.linesize[0]) == width && u32(src.linesize[1]) == width) {
+        std::memcpy(dst, src.data[0], width * src.height);
+        std::memcpy(dst + width * height, src.data[1], (width * src.height) / 2);
+        return;
+    }
+    const auto luma_dst = dst;
+    for (u32 y = 0; y < src.height; ++y) {
+        std::memcpy(luma_dst + y * width, src.data[0] + y * src.linesize[0], src.width);
+    }
+    const auto chroma_dst = dst + width * height;
+    for (u32 y = 0; y < src.height / 2; ++y) {
+        std::memcpy(chroma_dst + y * width, src.data[1] + y * src.linesize[1], src.width);
+    }
+}
 
-    av_frame_get_buffer(nv12_frame.get(), 0);
+bool AvPlayerSource::WriteVideoFrame(u8* dst, const AVFrame& frame, u32 width, u32 height) {
+    if (frame.format == AV_PIX_FMT_NV12) {
+        CopyNV12Data(dst, frame, width, height);
+        return true;
+    }
 
+    // Convert straight into the guest buffer instead of going through an intermediate frame.
+    m_sws_context.reset(sws_getCachedContext(
+        m_sws_context.release(), frame.width, frame.height, AVPixelFormat(frame.format),
+        frame.width, frame.height, AV_PIX_FMT_NV12, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr));
     if (m_sws_context == nullptr) {
-        m_sws_context =
-            SWSContextPtr(sws_getContext(frame.width, frame.height, AVPixelFormat(frame.format),
-                                         nv12_frame->width, nv12_frame->height, AV_PIX_FMT_NV12,
-                                         SWS_FAST_BILINEAR, nullptr, nullptr, nullptr),
-                          &ReleaseSWSContext);
+        LOG_ERROR(Lib_AvPlayer, "Could not create NV12 conversion context");
+        return false;
     }
+    u8* const dst_data[4] = {dst, dst + width * height, nullptr, nullptr};
+    const int dst_linesize[4] = {int(width), int(width), 0, 0};
     const auto res = sws_scale(m_sws_context.get(), frame.data, frame.linesize, 0, frame.height,
-                               nv12_frame->data, nv12_frame->linesize);
+                               dst_data, dst_linesize);
     if (res < 0) {
         LOG_ERROR(Lib_AvPlayer, "Could not convert to NV12: {}", av_err2str(res));
-        return AVFramePtr{nullptr, &ReleaseAVFrame};
+        return false;
     }
-    return nv12_frame;
+    return true;
 }
 
-static void CopyNV12Data(u8* dst, const AVFrame& src, bool use_vdec2) {
-    auto width = u32(src.width);
-    auto height = u32(src.height);
-    if (!use_vdec2) {
+std::optional<Frame> AvPlayerSource::PrepareVideoFrame(GuestBuffer buffer,
+                                                      const AVFrame& frame) {
+    auto width = u32(frame.width);
+    auto height = u32(frame.height);
+    if (!m_use_vdec2) {
         width = Common::AlignUp(width, 16);
         height = Common::AlignUp(height, 16);
     }
 
-    if (src.width == width) {
-        std::memcpy(dst, src.data[0], src.width * src.height);
-        std::memcpy(dst + src.width * height, src.data[1], (src.width * src.height) / 2);
-    } else {
-        const auto luma_dst = dst;
-        for (u32 y = 0; y < src.height; ++y) {
-            std::memcpy(luma_dst + y * width, src.data[0] + y * src.width, src.width);
-        }
-        const auto chroma_dst = dst + width * height;
-        for (u32 y = 0; y < src.height / 2; ++y) {
-            std::memcpy(chroma_dst + y * (width / 2), src.data[0] + y * (src.width / 2),
-                        src.width / 2);
-        }
-    }
-}
-
-Frame AvPlayerSource::PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame) {
-    ASSERT(frame.format == AV_PIX_FMT_NV12);
-
     auto p_buffer = buffer.GetBuffer();
-    CopyNV12Data(p_buffer, frame, m_use_vdec2);
+    if (!WriteVideoFrame(p_buffer, frame, width, height)) {
+        return std::nullopt;
+    }
 
-    const auto pkt_dts = u64(frame.pkt_dts) * 1000;
+    const auto pkt_dts = u64(std::max<s64>(frame.pkt_dts, 0)) * 1000;
     const auto stream = m_avformat_context->streams[m_video_stream_index.value()];
     const auto time_base = stream->time_base;
     const auto den = time_base.den;
     const auto num = time_base.num;
     const auto timestamp = (num != 0 && den > 1) ? (pkt_dts * num) / den : pkt_dts;
 
-    auto width = u32(frame.width);
-    auto height = u32(frame.height);
-    if (!m_use_vdec2) {
-        width = Common::AlignUp(width, 16);
-        height = Common::AlignUp(height, 16);
-    }
-
     return Frame{
         .buffer = std::move(buffer),
         .info =
@@ -605,7 +609,7 @@ Frame AvPlayerSource::PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame
                                 .crop_top_offset = u32(frame.crop_top),
                                 .crop_bottom_offset =
                                     u32(frame.crop_bottom + (height - frame.height)),
-                                .pitch = u32(frame.linesize[0]),
+                                .pitch = width,
                                 .luma_bit_depth = 8,
                                 .chroma_bit_depth = 8,
                             },
@@ -619,17 +623,22 @@ void AvPlayerSource::VideoDecoderThread(std::stop_token stop) {
     Common::SetCurrentThreadName("shadPS4:AvVideoDecoder");
 
     LOG_INFO(Lib_AvPlayer, "Video Decoder Thread started");
-    while ((!m_is_eof || m_video_packets.Size() != 0) && !stop.stop_requested()) {
+    // Reused for every frame, avcodec_receive_frame unreferences it before filling it in.
+    const auto up_frame = AVFramePtr(av_frame_alloc(), &ReleaseAVFrame);
+    while (!stop.stop_requested()) {
         if (!m_video_packets_cv.Wait(stop,
                                      [this] { return m_video_packets.Size() != 0 || m_is_eof; })) {
             continue;
         }
         const auto packet = m_video_packets.Pop();
-        if (!packet.has_value()) {
+        if (!packet.has_value() && !m_is_eof) {
             continue;
         }
+        m_demuxer_cv.Notify();
 
-        auto res = avcodec_send_packet(m_video_codec_context.get(), packet->get());
+        // Frame threading holds back the last few frames, a null packet drains them at EOF.
+        auto res = avcodec_send_packet(m_video_codec_context.get(),
+                                       packet.has_value() ? packet->get() : nullptr);
         if (res < 0 && res != AVERROR(EAGAIN)) {
             m_state.OnError();
             LOG_ERROR(Lib_AvPlayer, "Could not send packet to the video codec. Error = {}",
@@ -643,7 +652,6 @@ void AvPlayerSource::VideoDecoderThread(std::stop_token stop) {
             if (m_video_buffers.Size() == 0) {
                 continue;
             }
-            auto up_frame = AVFramePtr(av_frame_alloc(), &ReleaseAVFrame);
             res = avcodec_receive_frame(m_video_codec_context.get(), up_frame.get());
             if (res < 0) {
                 if (res == AVERROR_EOF) {
@@ -662,12 +670,12 @@ void AvPlayerSource::VideoDecoderThread(std::stop_token stop) {
                     // Video buffers queue was cleared. This means that player was stopped.
                     break;
                 }
-                if (up_frame->format != AV_PIX_FMT_NV12) {
-                    const auto nv12_frame = ConvertVideoFrame(*up_frame);
-                    m_video_frames.Push(PrepareVideoFrame(std::move(buffer.value()), *nv12_frame));
-                } else {
-                    m_video_frames.Push(PrepareVideoFrame(std::move(buffer.value()), *up_frame));
+                auto frame = PrepareVideoFrame(std::move(buffer.value()), *up_frame);
+                if (!frame.has_value()) {
+                    m_state.OnError();
+                    return;
                 }
+                m_video_frames.Push(std::move(frame.value()));
                 m_video_frames_cv.Notify();
             }
         }
@@ -741,6 +749,7 @@ void AvPlayerSource::AudioDecoderThread(std::stop_token stop) {
     Common::SetCurrentThreadName("shadPS4:AvAudioDecoder");
 
     LOG_INFO(Lib_AvPlayer, "Audio Decoder Thread started");
+    const auto up_frame = AVFramePtr(av_frame_alloc(), &ReleaseAVFrame);
     while ((!m_is_eof || m_audio_packets.Size() != 0) && !stop.stop_requested()) {
         if (!m_audio_packets_cv.Wait(stop,
                                      [this] { return m_audio_packets.Size() != 0 || m_is_eof; })) {
@@ -750,6 +759,7 @@ void AvPlayerSource::AudioDecoderThread(std::stop_token stop) {
         if (!packet.has_value()) {
             continue;
         }
+        m_demuxer_cv.Notify();
         auto res = avcodec_send_packet(m_audio_codec_context.get(), packet->get());
         if (res < 0 && res != AVERROR(EAGAIN)) {
             m_state.OnError();
@@ -765,7 +775,6 @@ void AvPlayerSource::AudioDecoderThread(std::stop_token stop) {
                 continue;
             }
 
-            auto up_frame = AVFramePtr(av_frame_alloc(), &ReleaseAVFrame);
             res = avcodec_receive_frame(m_audio_codec_context.get(), up_frame.get());
             if (res < 0) {
                 if (res == AVERROR_EOF) {
@@ -181,10 +181,10 @@ private:
     bool HasRunningThreads() const;
 
     AVFramePtr ConvertAudioFrame(const AVFrame& frame);
-    AVFramePtr ConvertVideoFrame(const AVFrame& frame);
+    bool WriteVideoFrame(u8* dst, const AVFrame& frame, u32 width, u32 height);
 
     Frame PrepareAudioFrame(GuestBuffer buffer, const AVFrame& frame);
-    Frame PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame);
+    std::optional<Frame> PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame);
 
     AvPlayerStateCallback& m_state;
     bool m_use_vdec2 = false;
@@ -221,6 +221,8 @@ private:
     EventCV m_video_frames_cv{};
     EventCV m_video_buffers_cv{};
 
+    EventCV m_demuxer_cv{};
+
     std::mutex m_state_mutex{};
     Kernel::Thread m_demuxer_thread{};
     Kernel::Thread m_video_decoder_thread{};
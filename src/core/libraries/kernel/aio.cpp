@@ -1,12 +1,20 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <span>
 #include <thread>
 
 #include "aio.h"
 #include "common/assert.h"
 #include "common/debug.h"
 #include "common/logging/log.h"
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
 #include "core/libraries/kernel/equeue.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/libs.h"
@@ -14,10 +22,229 @@
 
 namespace Libraries::Kernel {
 
-#define MAX_QUEUE 512
+static constexpr s32 MaxSubmissions = 512;
+static constexpr u32 NumAioWorkers = 4;
+static constexpr u32 NumAioPriorities = ORBIS_KERNEL_AIO_PRIORITY_HIGH;
+
+struct AioSubmission {
+    std::vector<OrbisKernelAioRWRequest> requests;
+    s32 state{};
+    bool is_write{};
+    bool in_use{};
+    bool delete_pending{};
+};
+
+/// Services AIO submissions on a small pool of host threads. Submissions are picked from the
+/// highest priority queue first and complete independently of each other.
+class AioEngine {
+public:
+    AioEngine() {
+        // Id 0 is never handed out, games use it as a null id.
+        for (s32 id = MaxSubmissions - 1; id > 0; --id) {
+            free_ids.push_back(id);
+        }
+    }
+
+    s32 Submit(std::span<const OrbisKernelAioRWRequest> requests, bool is_write, s32 prio,
+               OrbisKernelAioSubmitId* id) {
+        std::call_once(workers_started, [this] { StartWorkers(); });
+
+        std::scoped_lock lock{mutex};
+        if (free_ids.empty()) {
+            LOG_WARNING(Kernel, "Out of AIO submission ids");
+            return ORBIS_KERNEL_ERROR_EAGAIN;
+        }
+        const OrbisKernelAioSubmitId new_id = free_ids.back();
+        free_ids.pop_back();
+
+        auto& submission = submissions[new_id];
+        submission.requests.assign(requests.begin(), requests.end());
+        submission.state = ORBIS_KERNEL_AIO_STATE_SUBMITTED;
+        submission.is_write = is_write;
+        submission.in_use = true;
+        submission.delete_pending = false;
+        for (const auto& req : submission.requests) {
+            if (req.result) {
+                req.result->state = ORBIS_KERNEL_AIO_STATE_SUBMITTED;
+            }
+        }
+
+        queues[PriorityIndex(prio)].push_back(new_id);
+        *id = new_id;
+        work_cv.notify_one();
+        return ORBIS_OK;
+    }
+
+    s32 Poll(OrbisKernelAioSubmitId id, s32* state) {
+        std::scoped_lock lock{mutex};
+        if (!IsValid(id)) {
+            return ORBIS_KERNEL_ERROR_ESRCH;
+        }
+        *state = submissions[id].state;
+        return ORBIS_OK;
+    }
+
+    /// Aborts a submission that has not been picked up by a worker yet. Requests in flight
+    /// run to completion and report their state.
+    s32 Cancel(OrbisKernelAioSubmitId id, s32* state) {
+        std::scoped_lock lock{mutex};
+        if (!IsValid(id)) {
+            return ORBIS_KERNEL_ERROR_ESRCH;
+        }
+        auto& submission = submissions[id];
+        if (submission.state == ORBIS_KERNEL_AIO_STATE_SUBMITTED) {
+            for (auto& queue : queues) {
+                std::erase(queue, id);
+            }
+            submission.state = ORBIS_KERNEL_AIO_STATE_ABORTED;
+            for (const auto& req : submission.requests) {
+                if (req.result) {
+                    req.result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
+                }
+            }
+            done_cv.notify_all();
+        }
+        *state = submission.state;
+        return ORBIS_OK;
+    }
+
+    s32 Delete(OrbisKernelAioSubmitId id) {
+        std::scoped_lock lock{mutex};
+        if (!IsValid(id)) {
+            return ORBIS_KERNEL_ERROR_ESRCH;
+        }
+        auto& submission = submissions[id];
+        if (submission.state == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
+            submission.delete_pending = true;
+            return ORBIS_OK;
+        }
+        if (submission.state == ORBIS_KERNEL_AIO_STATE_SUBMITTED) {
+            for (auto& queue : queues) {
+                std::erase(queue, id);
+            }
+        }
+        Release(id);
+        done_cv.notify_all();
+        return ORBIS_OK;
+    }
+
+    s32 Wait(std::span<const OrbisKernelAioSubmitId> ids, s32* states, bool wait_all,
+             const u32* usec) {
+        std::unique_lock lock{mutex};
+        const auto is_done = [this](OrbisKernelAioSubmitId id) {
+            return !IsValid(id) || submissions[id].state == ORBIS_KERNEL_AIO_STATE_COMPLETED ||
+                   submissions[id].state == ORBIS_KERNEL_AIO_STATE_ABORTED;
+        };
+        const auto pred = [&] {
+            return wait_all ? std::ranges::all_of(ids, is_done)
+                            : std::ranges::any_of(ids, is_done);
+        };
+
+        bool timed_out = false;
+        if (usec) {
+            timed_out = !done_cv.wait_for(lock, std::chrono::microseconds(*usec), pred);
+        } else {
+            done_cv.wait(lock, pred);
+        }
+
+        s32 result = timed_out ? ORBIS_KERNEL_ERROR_ETIMEDOUT : ORBIS_OK;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (!IsValid(ids[i])) {
+                result = ORBIS_KERNEL_ERROR_ESRCH;
+                continue;
+            }
+            states[i] = submissions[ids[i]].state;
+        }
+        return result;
+    }
+
+private:
+    static u32 PriorityIndex(s32 prio) {
+        // Queue 0 holds the highest priority submissions.
+        const s32 clamped = std::clamp<s32>(prio, ORBIS_KERNEL_AIO_PRIORITY_LOW,
+                                            ORBIS_KERNEL_AIO_PRIORITY_HIGH);
+        return ORBIS_KERNEL_AIO_PRIORITY_HIGH - clamped;
+    }
+
+    bool IsValid(OrbisKernelAioSubmitId id) const {
+        return id > 0 && id < MaxSubmissions && submissions[id].in_use;
+    }
+
+    void Release(OrbisKernelAioSubmitId id) {
+        auto& submission = submissions[id];
+        submission.requests.clear();
+        submission.in_use = false;
+        free_ids.push_back(id);
+    }
+
+    void StartWorkers() {
+        workers.reserve(NumAioWorkers);
+        for (u32 i = 0; i < NumAioWorkers; ++i) {
+            workers.emplace_back([this](std::stop_token stop_token) { WorkerLoop(stop_token); });
+        }
+    }
+
+    void WorkerLoop(std::stop_token stop_token) {
+        Common::SetCurrentThreadName("shadPS4:AioWorker");
+        while (!stop_token.stop_requested()) {
+            OrbisKernelAioSubmitId id{};
+            std::vector<OrbisKernelAioRWRequest> requests;
+            bool is_write{};
+            {
+                std::unique_lock lock{mutex};
+                const auto has_work = [](const auto& queue) { return !queue.empty(); };
+                Common::CondvarWait(work_cv, lock, stop_token,
+                                    [&] { return std::ranges::any_of(queues, has_work); });
+                if (stop_token.stop_requested()) {
+                    break;
+                }
+                auto& queue = *std::ranges::find_if(queues, has_work);
+                id = queue.front();
+                queue.pop_front();
+
+                auto& submission = submissions[id];
+                submission.state = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+                requests = submission.requests;
+                is_write = submission.is_write;
+            }
 
-static s32* id_state;
-static s32 id_index;
+            bool has_error = false;
+            for (const auto& req : requests) {
+                if (req.result) {
+                    req.result->state = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+                }
+                const s64 ret = is_write ? sceKernelPwrite(req.fd, req.buf, req.nbyte, req.offset)
+                                         : sceKernelPread(req.fd, req.buf, req.nbyte, req.offset);
+                has_error |= ret < 0;
+                if (req.result) {
+                    req.result->returnValue = ret;
+                    req.result->state =
+                        ret < 0 ? ORBIS_KERNEL_AIO_STATE_ABORTED : ORBIS_KERNEL_AIO_STATE_COMPLETED;
+                }
+            }
+
+            std::scoped_lock lock{mutex};
+            auto& submission = submissions[id];
+            submission.state =
+                has_error ? ORBIS_KERNEL_AIO_STATE_ABORTED : ORBIS_KERNEL_AIO_STATE_COMPLETED;
+            if (submission.delete_pending) {
+                Release(id);
+            }
+            done_cv.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable_any work_cv;
+    std::condition_variable done_cv;
+    std::array<AioSubmission, MaxSubmissions> submissions{};
+    std::array<std::deque<OrbisKernelAioSubmitId>, NumAioPriorities> queues;
+    std::vector<OrbisKernelAioSubmitId> free_ids;
+    std::once_flag workers_started;
+    std::vector<std::jthread> workers;
+};
+
+static std::unique_ptr<AioEngine> aio_engine;
 
 s32 PS4_SYSV_ABI sceKernelAioInitializeImpl(void* p, s32 size) {
 
@@ -28,8 +255,7 @@ s32 PS4_SYSV_ABI sceKernelAioDeleteRequest(OrbisKernelAioSubmitId id, s32* ret)
     if (ret == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    id_state[id] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-    *ret = 0;
+    *ret = aio_engine->Delete(id);
     return 0;
 }
 
@@ -38,18 +264,17 @@ s32 PS4_SYSV_ABI sceKernelAioDeleteRequests(OrbisKernelAioSubmitId id[], s32 num
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < num; i++) {
-        id_state[id[i]] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-        ret[i] = 0;
+        ret[i] = aio_engine->Delete(id[i]);
     }
 
     return 0;
 }
+
 s32 PS4_SYSV_ABI sceKernelAioPollRequest(OrbisKernelAioSubmitId id, s32* state) {
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    *state = id_state[id];
-    return 0;
+    return aio_engine->Poll(id, state);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioPollRequests(OrbisKernelAioSubmitId id[], s32 num, s32 state[]) {
@@ -57,7 +282,9 @@ s32 PS4_SYSV_ABI sceKernelAioPollRequests(OrbisKernelAioSubmitId id[], s32 num,
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < num; i++) {
-        state[i] = id_state[id[i]];
+        if (const s32 ret = aio_engine->Poll(id[i], &state[i]); ret != ORBIS_OK) {
+            return ret;
+        }
     }
 
     return 0;
@@ -67,13 +294,11 @@ s32 PS4_SYSV_ABI sceKernelAioCancelRequest(OrbisKernelAioSubmitId id, s32* state
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    if (id) {
-        id_state[id] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-        *state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-    } else {
+    if (id == 0) {
         *state = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+        return 0;
     }
-    return 0;
+    return aio_engine->Cancel(id, state);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioCancelRequests(OrbisKernelAioSubmitId id[], s32 num, s32 state[]) {
@@ -81,11 +306,12 @@ s32 PS4_SYSV_ABI sceKernelAioCancelRequests(OrbisKernelAioSubmitId id[], s32 num
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < num; i++) {
-        if (id[i]) {
-            id_state[id[i]] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            state[i] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-        } else {
+        if (id[i] == 0) {
             state[i] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+            continue;
+        }
+        if (const s32 ret = aio_engine->Cancel(id[i], &state[i]); ret != ORBIS_OK) {
+            return ret;
         }
     }
 
@@ -96,65 +322,19 @@ s32 PS4_SYSV_ABI sceKernelAioWaitRequest(OrbisKernelAioSubmitId id, s32* state,
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    u32 timer = 0;
-
-    s32 timeout = 0;
-
-    while (id_state[id] == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
-        sceKernelUsleep(10);
-
-        timer += 10;
-        if (*usec) {
-            if (timer > *usec) {
-                timeout = 1;
-                break;
-            }
-        }
-    }
-
-    *state = id_state[id];
-
-    if (timeout)
-        return ORBIS_KERNEL_ERROR_ETIMEDOUT;
-    return 0;
+    return aio_engine->Wait({&id, 1}, state, true, usec);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioWaitRequests(OrbisKernelAioSubmitId id[], s32 num, s32 state[],
                                           u32 mode, u32* usec) {
-    if (state == nullptr) {
+    if (state == nullptr || id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    u32 timer = 0;
-    s32 timeout = 0;
-    s32 completion = 0;
-
-    for (s32 i = 0; i < num; i++) {
-        if (!completion && !timeout) {
-            while (id_state[id[i]] == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
-                sceKernelUsleep(10);
-                timer += 10;
-
-                if (*usec) {
-                    if (timer > *usec) {
-                        timeout = 1;
-                        break;
-                    }
-                }
-            }
-        }
-
-        if (mode == 0x02) {
-            if (id_state[id[i]] == ORBIS_KERNEL_AIO_STATE_COMPLETED)
-                completion = 1;
-        }
-
-        state[i] = id_state[id[i]];
+    if (num <= 0 || (mode != ORBIS_KERNEL_AIO_WAIT_AND && mode != ORBIS_KERNEL_AIO_WAIT_OR)) {
+        return ORBIS_KERNEL_ERROR_EINVAL;
     }
-
-    if (timeout)
-        return ORBIS_KERNEL_ERROR_ETIMEDOUT;
-
-    return 0;
+    return aio_engine->Wait({id, static_cast<size_t>(num)}, state,
+                            mode == ORBIS_KERNEL_AIO_WAIT_AND, usec);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommands(OrbisKernelAioRWRequest req[], s32 size, s32 prio,
@@ -165,32 +345,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommands(OrbisKernelAioRWRequest req[], s
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-    for (s32 i = 0; i < size; i++) {
-
-        s64 ret = sceKernelPread(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-        }
-    }
-
-    id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-
-    *id = id_index;
-
-    id_index = (id_index + 1) % MAX_QUEUE;
-
-    if (!id_index)
-        id_index++;
-
-    return 0;
+    return aio_engine->Submit({req, static_cast<size_t>(size)}, false, prio, id);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommandsMultiple(OrbisKernelAioRWRequest req[], s32 size,
@@ -202,29 +357,10 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommandsMultiple(OrbisKernelAioRWRequest
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-        s64 ret = sceKernelPread(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
+        if (const s32 ret = aio_engine->Submit({&req[i], 1}, false, prio, &id[i]);
+            ret != ORBIS_OK) {
+            return ret;
         }
-
-        id[i] = id_index;
-
-        id_index = (id_index + 1) % MAX_QUEUE;
-
-        if (!id_index)
-            id_index++;
     }
 
     return 0;
@@ -238,35 +374,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommands(OrbisKernelAioRWRequest req[],
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-        s64 ret = sceKernelPwrite(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-        }
-    }
-
-    *id = id_index;
-
-    id_index = (id_index + 1) % MAX_QUEUE;
-
-    // skip id_index equals 0 , because sceKernelAioCancelRequest will submit id
-    // equal to 0
-    if (!id_index)
-        id_index++;
-
-    return 0;
+    return aio_engine->Submit({req, static_cast<size_t>(size)}, true, prio, id);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommandsMultiple(OrbisKernelAioRWRequest req[], s32 size,
@@ -278,26 +386,10 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommandsMultiple(OrbisKernelAioRWRequest
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-        s64 ret = sceKernelPwrite(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
+        if (const s32 ret = aio_engine->Submit({&req[i], 1}, true, prio, &id[i]);
+            ret != ORBIS_OK) {
+            return ret;
         }
-
-        id[i] = id_index;
-        id_index = (id_index + 1) % MAX_QUEUE;
-
-        if (!id_index)
-            id_index++;
     }
     return 0;
 }
@@ -313,9 +405,7 @@ s32 PS4_SYSV_ABI sceKernelAioInitializeParam() {
 }
 
 void RegisterAio(Core::Loader::SymbolsResolver* sym) {
-    id_index = 1;
-    id_state = (int*)malloc(sizeof(int) * MAX_QUEUE);
-    memset(id_state, 0, sizeof(sizeof(int) * MAX_QUEUE));
+    aio_engine = std::make_unique<AioEngine>();
 
     LIB_FUNCTION("fR521KIGgb8", "libkernel", 1, "libkernel", sceKernelAioCancelRequest);
     LIB_FUNCTION("3Lca1XBrQdY", "libkernel", 1, "libkernel", sceKernelAioCancelRequests);
@@ -336,4 +426,4 @@ void RegisterAio(Core::Loader::SymbolsResolver* sym) {
     LIB_FUNCTION("lgK+oIWkJyA", "libkernel", 1, "libkernel", sceKernelAioWaitRequests);
 }
 
-} // namespace Libraries::Kernel
\ No newline at end of file
+} // namespace Libraries::Kernel
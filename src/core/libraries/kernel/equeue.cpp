@@ -1,44 +1,50 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
-#include <thread>
-
 #include "common/assert.h"
 #include "common/debug.h"
 #include "common/logging/log.h"
 #include "core/libraries/kernel/equeue.h"
 #include "core/libraries/kernel/orbis_error.h"
+#include "core/libraries/kernel/timer_wheel.h"
 #include "core/libraries/libs.h"
 
 namespace Libraries::Kernel {
 
-extern boost::asio::io_context io_context;
-extern void KernelSignalRequest();
-
-static constexpr auto HrTimerSpinlockThresholdUs = 1200u;
+EqueueInternal::~EqueueInternal() {
+    for (const auto& event : m_events) {
+        if (event.timer_id != 0) {
+            TimerWheel::Instance().Cancel(event.timer_id);
+        }
+    }
+}
 
 // Events are uniquely identified by id and filter.
 
 bool EqueueInternal::AddEvent(EqueueEvent& event) {
-    std::scoped_lock lock{m_mutex};
+    u64 stale_timer_id = 0;
+    {
+        std::scoped_lock lock{m_mutex};
 
-    event.time_added = std::chrono::steady_clock::now();
-    if (event.event.filter == SceKernelEvent::Filter::Timer ||
-        event.event.filter == SceKernelEvent::Filter::HrTimer) {
-        // HrTimer events are offset by the threshold of time at the end that we spinlock for
-        // greater accuracy.
-        const auto offset =
-            event.event.filter == SceKernelEvent::Filter::HrTimer ? HrTimerSpinlockThresholdUs : 0u;
-        event.timer_interval = std::chrono::microseconds(event.event.data - offset);
-    }
+        event.time_added = std::chrono::steady_clock::now();
+        if (event.event.filter == SceKernelEvent::Filter::Timer ||
+            event.event.filter == SceKernelEvent::Filter::HrTimer) {
+            event.timer_interval = std::chrono::microseconds(event.event.data);
+        }
 
-    const auto& it = std::ranges::find(m_events, event);
-    if (it != m_events.cend()) {
-        *it = std::move(event);
-    } else {
-        m_events.emplace_back(std::move(event));
+        const auto& it = std::ranges::find(m_events, event);
+        if (it != m_events.cend()) {
+            stale_timer_id = it->timer_id;
+            *it = std::move(event);
+        } else {
+            m_events.emplace_back(std::move(event));
+        }
     }
 
+    // Timer callbacks take the queue lock, so they must be cancelled without holding it.
+    if (stale_timer_id != 0) {
+        TimerWheel::Instance().Cancel(stale_timer_id);
+    }
     return true;
 }
 
@@ -53,48 +59,40 @@ bool EqueueInternal::ScheduleEvent(u64 id, s16 filter,
         return false;
     }
 
-    const auto& event = *it;
+    auto& event = *it;
     ASSERT(event.event.filter == SceKernelEvent::Filter::Timer ||
            event.event.filter == SceKernelEvent::Filter::HrTimer);
+    ASSERT_MSG(event.timer_id == 0, "Timer event {} is already scheduled", id);
 
-    if (!it->timer) {
-        it->timer = std::make_unique<boost::asio::steady_timer>(io_context, event.timer_interval);
-    } else {
-        // If the timer already exists we are scheduling a reoccurrence after the next period.
-        // Set the expiration time to the previous occurrence plus the period.
-        it->timer->expires_at(it->timer->expiry() + event.timer_interval);
-    }
-
-    it->timer->async_wait(
-        [this, event_data = event.event, callback](const boost::system::error_code& ec) {
-            if (ec) {
-                if (ec != boost::system::errc::operation_canceled) {
-                    LOG_ERROR(Kernel_Event, "Timer callback error: {}", ec.message());
-                } else {
-                    // Timer was cancelled (removed) before it triggered
-                    LOG_DEBUG(Kernel_Event, "Timer cancelled");
-                }
-                return;
-            }
-            callback(this, event_data);
-        });
-    KernelSignalRequest();
+    // Periodic timers are rearmed by the wheel itself against their original deadline,
+    // so they don't drift by the time it takes to deliver each expiration.
+    const bool one_shot = event.event.flags & SceKernelEvent::Flags::OneShot;
+    const bool precise = filter == SceKernelEvent::Filter::HrTimer;
+    event.timer_id = TimerWheel::Instance().Add(
+        event.timer_interval, one_shot ? std::chrono::microseconds{0} : event.timer_interval,
+        precise, [this, event_data = event.event, callback] { callback(this, event_data); });
 
     return true;
 }
 
 bool EqueueInternal::RemoveEvent(u64 id, s16 filter) {
-    bool has_found = false;
-    std::scoped_lock lock{m_mutex};
-
-    const auto& it = std::ranges::find_if(m_events, [id, filter](auto& ev) {
-        return ev.event.ident == id && ev.event.filter == filter;
-    });
-    if (it != m_events.cend()) {
+    u64 timer_id = 0;
+    {
+        std::scoped_lock lock{m_mutex};
+        const auto& it = std::ranges::find_if(m_events, [id, filter](auto& ev) {
+            return ev.event.ident == id && ev.event.filter == filter;
+        });
+        if (it == m_events.cend()) {
+            return false;
+        }
+        timer_id = it->timer_id;
         m_events.erase(it);
-        has_found = true;
     }
-    return has_found;
+
+    if (timer_id != 0) {
+        TimerWheel::Instance().Cancel(timer_id);
+    }
+    return true;
 }
 
 int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUseconds* timo) {
@@ -105,11 +103,6 @@ int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUs
     }
     const auto micros = timo ? *timo : 0u;
 
-    if (HasSmallTimer()) {
-        // If a small timer is set, just wait for it to expire.
-        return WaitForSmallTimer(ev, num, micros);
-    }
-
     int count = 0;
 
     const auto predicate = [&] {
@@ -127,15 +120,6 @@ int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUs
         m_cond.wait_for(lock, std::chrono::microseconds(micros), predicate);
     }
 
-    if (HasSmallTimer()) {
-        if (count > 0) {
-            const auto time_waited = std::chrono::duration_cast<std::chrono::microseconds>(
-                                         std::chrono::steady_clock::now() - m_events[0].time_added)
-                                         .count();
-            count = WaitForSmallTimer(ev, num, std::max(0l, long(micros - time_waited)));
-        }
-    }
-
     return count;
 }
 
@@ -189,49 +173,6 @@ int EqueueInternal::GetTriggeredEvents(SceKernelEvent* ev, int num) {
     return count;
 }
 
-bool EqueueInternal::AddSmallTimer(EqueueEvent& ev) {
-    SmallTimer st;
-    st.event = ev.event;
-    st.added = std::chrono::steady_clock::now();
-    st.interval = std::chrono::microseconds{ev.event.data};
-    {
-        std::scoped_lock lock{m_mutex};
-        m_small_timers[st.event.ident] = std::move(st);
-    }
-    return true;
-}
-
-int EqueueInternal::WaitForSmallTimer(SceKernelEvent* ev, int num, u32 micros) {
-    ASSERT(num >= 1);
-
-    auto curr_clock = std::chrono::steady_clock::now();
-    const auto wait_end_us = (micros == 0) ? std::chrono::steady_clock::time_point::max()
-                                           : curr_clock + std::chrono::microseconds{micros};
-    int count = 0;
-    do {
-        curr_clock = std::chrono::steady_clock::now();
-        {
-            std::scoped_lock lock{m_mutex};
-            for (auto it = m_small_timers.begin(); it != m_small_timers.end() && count < num;) {
-                const SmallTimer& st = it->second;
-
-                if (curr_clock - st.added >= st.interval) {
-                    ev[count++] = st.event;
-                    it = m_small_timers.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-
-            if (count > 0)
-                return count;
-        }
-        std::this_thread::yield();
-    } while (curr_clock < wait_end_us);
-
-    return 0;
-}
-
 bool EqueueInternal::EventExists(u64 id, s16 filter) {
     std::scoped_lock lock{m_mutex};
 
@@ -303,10 +244,6 @@ int PS4_SYSV_ABI sceKernelWaitEqueue(SceKernelEqueue eq, SceKernelEvent* ev, int
 }
 
 static void HrTimerCallback(SceKernelEqueue eq, const SceKernelEvent& kevent) {
-    static EqueueEvent event;
-    event.event = kevent;
-    event.event.data = HrTimerSpinlockThresholdUs;
-    eq->AddSmallTimer(event);
     eq->TriggerEvent(kevent.ident, SceKernelEvent::Filter::HrTimer, kevent.udata);
 }
 
@@ -329,22 +266,13 @@ s32 PS4_SYSV_ABI sceKernelAddHRTimerEvent(SceKernelEqueue eq, int id, timespec*
     event.event.data = total_us;
     event.event.udata = udata;
 
-    // HR timers cannot be implemented within the existing event queue architecture due to the
-    // slowness of the notification mechanism. For instance, a 100us timer will lose its precision
-    // as the trigger time drifts by +50-700%, depending on the host PC and workload. To address
-    // this issue, we use a spinlock for small waits (which can be adjusted using
-    // `HrTimerSpinlockThresholdUs`) and fall back to boost asio timers if the time to tick is
-    // large. Even for large delays, we truncate a small portion to complete the wait
-    // using the spinlock, prioritizing precision.
+    // HR timers are marked precise, the timer wheel sleeps on them with the finest resolution
+    // the host offers instead of rounding them to its tick.
 
     if (eq->EventExists(event.event.ident, event.event.filter)) {
         eq->RemoveEvent(id, SceKernelEvent::Filter::HrTimer);
     }
 
-    if (total_us < HrTimerSpinlockThresholdUs) {
-        return eq->AddSmallTimer(event) ? ORBIS_OK : ORBIS_KERNEL_ERROR_ENOMEM;
-    }
-
     if (!eq->AddEvent(event) ||
         !eq->ScheduleEvent(id, SceKernelEvent::Filter::HrTimer, HrTimerCallback)) {
         return ORBIS_KERNEL_ERROR_ENOMEM;
@@ -357,23 +285,12 @@ int PS4_SYSV_ABI sceKernelDeleteHRTimerEvent(SceKernelEqueue eq, int id) {
         return ORBIS_KERNEL_ERROR_EBADF;
     }
 
-    if (eq->HasSmallTimer()) {
-        return eq->RemoveSmallTimer(id) ? ORBIS_OK : ORBIS_KERNEL_ERROR_ENOENT;
-    } else {
-        return eq->RemoveEvent(id, SceKernelEvent::Filter::HrTimer) ? ORBIS_OK
-                                                                    : ORBIS_KERNEL_ERROR_ENOENT;
-    }
+    return eq->RemoveEvent(id, SceKernelEvent::Filter::HrTimer) ? ORBIS_OK
+                                                                : ORBIS_KERNEL_ERROR_ENOENT;
 }
 
 static void TimerCallback(SceKernelEqueue eq, const SceKernelEvent& kevent) {
-    if (eq->EventExists(kevent.ident, kevent.filter)) {
-        eq->TriggerEvent(kevent.ident, SceKernelEvent::Filter::Timer, kevent.udata);
-
-        if (!(kevent.flags & SceKernelEvent::Flags::OneShot)) {
-            // Reschedule the event for its next period.
-            eq->ScheduleEvent(kevent.ident, kevent.filter, TimerCallback);
-        }
-    }
+    eq->TriggerEvent(kevent.ident, SceKernelEvent::Filter::Timer, kevent.udata);
 }
 
 int PS4_SYSV_ABI sceKernelAddTimerEvent(SceKernelEqueue eq, int id, SceKernelUseconds usec,
@@ -7,9 +7,7 @@
 #include <mutex>
 #include <string>
 #include <vector>
-#include <boost/asio/steady_timer.hpp>
 
-#include <unordered_map>
 #include "common/rdtsc.h"
 #include "common/types.h"
 
@@ -82,7 +80,7 @@ struct EqueueEvent {
     void* data = nullptr;
     std::chrono::steady_clock::time_point time_added;
     std::chrono::microseconds timer_interval;
-    std::unique_ptr<boost::asio::steady_timer> timer;
+    u64 timer_id{};
 
     void ResetTriggerState() {
         is_triggered = false;
@@ -136,14 +134,9 @@ private:
 };
 
 class EqueueInternal {
-    struct SmallTimer {
-        SceKernelEvent event;
-        std::chrono::steady_clock::time_point added;
-        std::chrono::microseconds interval;
-    };
-
 public:
     explicit EqueueInternal(std::string_view name) : m_name(name) {}
+    ~EqueueInternal();
 
     std::string_view GetName() const {
         return m_name;
@@ -157,21 +150,6 @@ public:
     bool TriggerEvent(u64 ident, s16 filter, void* trigger_data);
     int GetTriggeredEvents(SceKernelEvent* ev, int num);
 
-    bool AddSmallTimer(EqueueEvent& event);
-    bool HasSmallTimer() {
-        std::scoped_lock lock{m_mutex};
-        return !m_small_timers.empty();
-    }
-    bool RemoveSmallTimer(u64 id) {
-        if (HasSmallTimer()) {
-            std::scoped_lock lock{m_mutex};
-            return m_small_timers.erase(id) > 0;
-        }
-        return false;
-    }
-
-    int WaitForSmallTimer(SceKernelEvent* ev, int num, u32 micros);
-
     bool EventExists(u64 id, s16 filter);
 
 private:
@@ -179,7 +157,6 @@ private:
     std::mutex m_mutex;
     std::vector<EqueueEvent> m_events;
     std::condition_variable m_cond;
-    std::unordered_map<u64, SmallTimer> m_small_timers;
 };
 
 u64 PS4_SYSV_ABI sceKernelGetEventData(const SceKernelEvent* ev);
@@ -5,6 +5,13 @@
 
 #include "common/assert.h"
 
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace Libraries::Kernel {
 
 TimedMutex::TimedMutex() {
@@ -28,6 +35,18 @@ void TimedMutex::lock() {
             return;
         }
     }
+#elif defined(__linux__)
+    u32 state = Unlocked;
+    if (lock_word.compare_exchange_strong(state, Locked, std::memory_order_acquire)) [[likely]] {
+        return;
+    }
+    if (state != Contended) {
+        state = lock_word.exchange(Contended, std::memory_order_acquire);
+    }
+    while (state != Unlocked) {
+        Wait();
+        state = lock_word.exchange(Contended, std::memory_order_acquire);
+    }
 #else
     mtx.lock();
 #endif
@@ -36,6 +55,11 @@ void TimedMutex::lock() {
 bool TimedMutex::try_lock() {
 #ifdef _WIN64
     return WaitForSingleObjectEx(mtx, 0, true) == WAIT_OBJECT_0;
+#elif defined(__linux__)
+    // Test before the exchange, so guests spinning on a held lock don't bounce its cache line.
+    u32 state = lock_word.load(std::memory_order_relaxed);
+    return state == Unlocked &&
+           lock_word.compare_exchange_strong(state, Locked, std::memory_order_acquire);
 #else
     return mtx.try_lock();
 #endif
@@ -44,9 +68,28 @@ bool TimedMutex::try_lock() {
 void TimedMutex::unlock() {
 #ifdef _WIN64
     ReleaseMutex(mtx);
+#elif defined(__linux__)
+    if (lock_word.exchange(Unlocked, std::memory_order_release) == Contended) {
+        syscall(SYS_futex, &lock_word, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
 #else
     mtx.unlock();
 #endif
 }
 
+#ifdef __linux__
+void TimedMutex::Wait(std::chrono::nanoseconds timeout) {
+    timespec ts{};
+    timespec* ts_ptr = nullptr;
+    if (timeout.count() >= 0) {
+        const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        ts.tv_sec = static_cast<time_t>(std::min<s64>(secs.count(), INT_MAX));
+        ts.tv_nsec = static_cast<long>((timeout - secs).count());
+        ts_ptr = &ts;
+    }
+    // Spurious returns (EINTR, EAGAIN, ETIMEDOUT) are handled by the caller re-checking the word.
+    syscall(SYS_futex, &lock_word, FUTEX_WAIT_PRIVATE, Contended, ts_ptr, nullptr, 0);
+}
+#endif
+
 } // namespace Libraries::Kernel
\ No newline at end of file
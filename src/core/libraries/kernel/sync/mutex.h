@@ -9,6 +9,8 @@
 
 #ifdef _WIN64
 #include <windows.h>
+#elif defined(__linux__)
+#include <atomic>
 #else
 #include <mutex>
 #endif
@@ -27,7 +29,7 @@ public:
 
     template <class Rep, class Period>
     bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time) {
-#ifdef _WIN64
+#if defined(_WIN64) || defined(__linux__)
         constexpr auto zero = std::chrono::duration<Rep, Period>::zero();
         const auto now = std::chrono::steady_clock::now();
 
@@ -64,6 +66,23 @@ public:
                 return false;
             }
         }
+#elif defined(__linux__)
+        u32 state = Unlocked;
+        if (lock_word.compare_exchange_strong(state, Locked, std::memory_order_acquire)) {
+            return true;
+        }
+        if (state != Contended) {
+            state = lock_word.exchange(Contended, std::memory_order_acquire);
+        }
+        while (state != Unlocked) {
+            const auto now = Clock::now();
+            if (abs_time <= now) {
+                return false;
+            }
+            Wait(std::chrono::ceil<std::chrono::nanoseconds>(abs_time - now));
+            state = lock_word.exchange(Contended, std::memory_order_acquire);
+        }
+        return true;
 #else
         return mtx.try_lock_until(abs_time);
 #endif
@@ -72,6 +91,18 @@ public:
 private:
 #ifdef _WIN64
     HANDLE mtx;
+#elif defined(__linux__)
+    /// Futex lock word, see "Futexes Are Tricky" for the three state protocol.
+    enum : u32 {
+        Unlocked = 0,
+        Locked = 1,
+        Contended = 2,
+    };
+
+    /// Sleeps while the lock word is contended, for at most `timeout` if it is non-negative.
+    void Wait(std::chrono::nanoseconds timeout = std::chrono::nanoseconds{-1});
+
+    std::atomic<u32> lock_word{Unlocked};
 #else
     std::timed_mutex mtx;
 #endif
@@ -0,0 +1,245 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+
+#include "common/assert.h"
+#include "common/thread.h"
+#include "core/libraries/kernel/timer_wheel.h"
+
+#ifdef __linux__
+#include <ctime>
+#include <sys/prctl.h>
+#endif
+
+namespace Libraries::Kernel {
+
+// Precise timers busy-wait for the final stretch on hosts without absolute-time sleeps.
+[[maybe_unused]] static constexpr auto PreciseSpinWindow = std::chrono::microseconds(500);
+
+static void PreciseSleepUntil(TimerWheel::Clock::time_point deadline) {
+#ifdef __linux__
+    // steady_clock is CLOCK_MONOTONIC on Linux.
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        deadline.time_since_epoch())
+                        .count();
+    const timespec ts{
+        .tv_sec = static_cast<time_t>(ns / 1'000'000'000),
+        .tv_nsec = static_cast<long>(ns % 1'000'000'000),
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#else
+    const auto now = TimerWheel::Clock::now();
+    if (deadline - now > PreciseSpinWindow) {
+        std::this_thread::sleep_until(deadline - PreciseSpinWindow);
+    }
+    while (TimerWheel::Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+#endif
+}
+
+TimerWheel& TimerWheel::Instance() {
+    static TimerWheel instance;
+    return instance;
+}
+
+TimerWheel::TimerWheel() : epoch{Clock::now()} {
+    thread = std::jthread{[this](std::stop_token stoken) { Run(stoken); }};
+}
+
+TimerWheel::~TimerWheel() {
+    thread.request_stop();
+    thread.join();
+}
+
+u64 TimerWheel::TickOf(Clock::time_point time) const {
+    if (time <= epoch) {
+        return 0;
+    }
+    return static_cast<u64>((time - epoch) / TickDuration);
+}
+
+void TimerWheel::Insert(const Entry& entry) {
+    const u64 tick = TickOf(entry.deadline);
+    if (tick < current_tick) {
+        // The slot for this tick was already processed, so hand the entry over directly.
+        expired.push_back(entry);
+        return;
+    }
+    const u64 delta = tick - current_tick;
+    if (delta < level0.size()) {
+        level0[tick & (level0.size() - 1)].push_back(entry);
+        return;
+    }
+    u32 shift = Level0Bits;
+    for (u32 level = 0; level < levels.size(); ++level) {
+        const u64 span = u64(1) << (shift + LevelNBits);
+        if (delta < span || level == levels.size() - 1) {
+            // Timers beyond the last level park in its furthest slot and are cascaded again.
+            const u64 clamped = delta < span ? tick : current_tick + span - 1;
+            levels[level][(clamped >> shift) & ((1u << LevelNBits) - 1)].push_back(entry);
+            return;
+        }
+        shift += LevelNBits;
+    }
+}
+
+void TimerWheel::Cascade(u32 level) {
+    const u32 shift = Level0Bits + level * LevelNBits;
+    auto& slot = levels[level][(current_tick >> shift) & ((1u << LevelNBits) - 1)];
+    Slot entries = std::move(slot);
+    slot.clear();
+    for (const auto& entry : entries) {
+        Insert(entry);
+    }
+}
+
+std::optional<u64> TimerWheel::NextPendingTick() const {
+    if (timers.empty()) {
+        return std::nullopt;
+    }
+    // Look for work up to the next cascade, which is where far away timers come into view.
+    const u64 boundary = (current_tick | (level0.size() - 1)) + 1;
+    for (u64 tick = current_tick; tick < boundary; ++tick) {
+        if (!level0[tick & (level0.size() - 1)].empty()) {
+            return tick;
+        }
+    }
+    return boundary;
+}
+
+TimerWheel::TimerId TimerWheel::Add(std::chrono::microseconds delay,
+                                    std::chrono::microseconds period, bool precise,
+                                    Callback callback) {
+    std::scoped_lock lk{mutex};
+    const auto now = Clock::now();
+    if (timers.empty()) {
+        // The wheel went idle, drop entries of cancelled timers and catch up with the clock
+        // instead of walking every tick that passed in the meantime.
+        expired.clear();
+        for (auto& slot : level0) {
+            slot.clear();
+        }
+        for (auto& level : levels) {
+            for (auto& slot : level) {
+                slot.clear();
+            }
+        }
+        current_tick = TickOf(now);
+    }
+    const TimerId id = next_id++;
+    const auto deadline = now + delay;
+    timers.emplace(id, Timer{
+                           .deadline = deadline,
+                           .period = period,
+                           .precise = precise,
+                           .callback = std::move(callback),
+                       });
+    Insert(Entry{id, deadline});
+    cv.notify_one();
+    return id;
+}
+
+void TimerWheel::Cancel(TimerId id) {
+    std::unique_lock lk{mutex};
+    timers.erase(id);
+    if (std::this_thread::get_id() != thread_id) {
+        cancel_cv.wait(lk, [&] { return running_id != id; });
+    }
+}
+
+void TimerWheel::Fire(std::unique_lock<std::mutex>& lk, const Entry& entry) {
+    auto it = timers.find(entry.id);
+    if (it == timers.end() || it->second.deadline != entry.deadline) {
+        // Cancelled, or rearmed and queued again under the new deadline.
+        return;
+    }
+    if (Clock::now() < entry.deadline) {
+        const bool precise = it->second.precise;
+        lk.unlock();
+        if (precise) {
+            PreciseSleepUntil(entry.deadline);
+        } else {
+            std::this_thread::sleep_until(entry.deadline);
+        }
+        lk.lock();
+        it = timers.find(entry.id);
+        if (it == timers.end()) {
+            return;
+        }
+    }
+
+    Callback callback = it->second.callback;
+    if (it->second.period.count() > 0) {
+        it.value().deadline += it->second.period;
+        Insert(Entry{entry.id, it->second.deadline});
+    } else {
+        timers.erase(it);
+    }
+
+    running_id = entry.id;
+    lk.unlock();
+    callback();
+    lk.lock();
+    running_id = 0;
+    cancel_cv.notify_all();
+}
+
+void TimerWheel::Run(std::stop_token stoken) {
+    Common::SetCurrentThreadName("shadPS4:KernelTimerWheel");
+#ifdef __linux__
+    // Don't let the kernel coalesce our wakeups, precise timers rely on them.
+    prctl(PR_SET_TIMERSLACK, 1);
+#endif
+
+    const std::stop_callback on_stop{stoken, [this] {
+        std::scoped_lock lk{mutex};
+        cv.notify_all();
+    }};
+
+    std::unique_lock lk{mutex};
+    thread_id = std::this_thread::get_id();
+    while (!stoken.stop_requested()) {
+        const u64 now_tick = TickOf(Clock::now());
+        Slot due = std::move(expired);
+        expired.clear();
+        while (current_tick <= now_tick) {
+            if ((current_tick & (level0.size() - 1)) == 0) {
+                // Cascade from coarse to fine so entries settle in a single pass.
+                u32 shift = Level0Bits;
+                u32 num_levels = 0;
+                while (num_levels < levels.size() &&
+                       (current_tick & ((u64(1) << shift) - 1)) == 0) {
+                    ++num_levels;
+                    shift += LevelNBits;
+                }
+                for (u32 level = num_levels; level-- > 0;) {
+                    Cascade(level);
+                }
+            }
+            auto& slot = level0[current_tick & (level0.size() - 1)];
+            due.insert(due.end(), slot.begin(), slot.end());
+            slot.clear();
+            ++current_tick;
+        }
+
+        std::ranges::sort(due, {}, &Entry::deadline);
+        for (const auto& entry : due) {
+            Fire(lk, entry);
+        }
+
+        const auto next_tick = NextPendingTick();
+        if (!next_tick) {
+            cv.wait(lk, [&] { return stoken.stop_requested() || !timers.empty(); });
+            continue;
+        }
+        // Wake early if a timer was added in front of the one we are waiting for.
+        cv.wait_until(lk, epoch + TickDuration * *next_tick, [&] {
+            return stoken.stop_requested() || !expired.empty() || NextPendingTick() != next_tick;
+        });
+    }
+}
+
+} // namespace Libraries::Kernel
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <tsl/robin_map.h>
+
+#include "common/polyfill_thread.h"
+#include "common/types.h"
+
+namespace Libraries::Kernel {
+
+/**
+ * Hierarchical timing wheel driving all kernel timer events from a single thread.
+ * Insertion and cancellation are O(1), timers far in the future are cascaded down
+ * to finer levels as their expiry approaches.
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = u64;
+
+    static TimerWheel& Instance();
+
+    TimerWheel();
+    ~TimerWheel();
+
+    /// Schedules `callback` after `delay`, and every `period` afterwards if it is non-zero.
+    /// Precise timers are slept on with the highest resolution the host offers.
+    TimerId Add(std::chrono::microseconds delay, std::chrono::microseconds period, bool precise,
+                Callback callback);
+
+    /// Cancels a timer. Once this returns its callback is not running and won't run again,
+    /// unless called from the callback itself.
+    void Cancel(TimerId id);
+
+private:
+    static constexpr auto TickDuration = std::chrono::milliseconds(1);
+    static constexpr u32 NumLevels = 4;
+    static constexpr u32 Level0Bits = 8;
+    static constexpr u32 LevelNBits = 6;
+
+    struct Timer {
+        Clock::time_point deadline;
+        std::chrono::microseconds period;
+        bool precise;
+        Callback callback;
+    };
+
+    struct Entry {
+        TimerId id;
+        Clock::time_point deadline;
+    };
+
+    using Slot = std::vector<Entry>;
+
+    u64 TickOf(Clock::time_point time) const;
+    void Insert(const Entry& entry);
+    void Cascade(u32 level);
+    std::optional<u64> NextPendingTick() const;
+    void Fire(std::unique_lock<std::mutex>& lk, const Entry& entry);
+    void Run(std::stop_token stoken);
+
+    std::mutex mutex;
+    std::condition_variable_any cv;
+    std::condition_variable_any cancel_cv;
+    Clock::time_point epoch;
+    u64 current_tick{};
+    TimerId next_id{1};
+    TimerId running_id{};
+    tsl::robin_map<TimerId, Timer> timers;
+    Slot expired;
+    std::array<Slot, 1u << Level0Bits> level0;
+    std::array<std::array<Slot, 1u << LevelNBits>, NumLevels - 1> levels;
+    std::thread::id thread_id;
+    std::jthread thread;
+};
+
+} // namespace Libraries::Kernel
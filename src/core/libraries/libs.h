@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "core/hle_profiler.h"
 #include "core/loader/elf.h"
 #include "core/loader/symbols_resolver.h"
 #include "core/tls.h"
@@ -15,7 +16,9 @@
         sr.library_version = libversion;                                                           \
         sr.module = mod;                                                                           \
         sr.type = Core::Loader::SymbolType::Function;                                              \
-        auto func = reinterpret_cast<u64>(HOST_CALL(function));                                    \
+        auto func = Core::HleProfiler::IsEnabled()                                                 \
+                        ? reinterpret_cast<u64>(HLE_PROFILED_CALL(function, lib))                  \
+                        : reinterpret_cast<u64>(HOST_CALL(function));                              \
         sym->AddSymbol(sr, func);                                                                  \
     }
 
@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
 #include "core/libraries/libs.h"
@@ -47,15 +49,48 @@ s32 PS4_SYSV_ABI sceNgs2ParseWaveformUser(OrbisNgs2ParseReadHandler handler, uin
     return ORBIS_OK;
 }
 
+/// The reference keeps the system alive for the call even if another thread destroys it.
+static std::shared_ptr<Ngs2System> GetSystem(OrbisNgs2Handle handle) {
+    return HandleOwner(handle, OrbisNgs2HandleType::System);
+}
+
+static LockedHandle<Ngs2Rack> GetRack(OrbisNgs2Handle handle) {
+    return {handle, OrbisNgs2HandleType::Rack};
+}
+
+static LockedHandle<Ngs2Voice> GetVoice(OrbisNgs2Handle handle) {
+    return {handle, OrbisNgs2HandleType::Voice};
+}
+
 s32 PS4_SYSV_ABI sceNgs2RackCreate(OrbisNgs2Handle systemHandle, u32 rackId,
                                    const OrbisNgs2RackOption* option,
                                    const OrbisNgs2ContextBufferInfo* bufferInfo,
                                    OrbisNgs2Handle* outHandle) {
-    LOG_ERROR(Lib_Ngs2, "rackId = {}", rackId);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_INFO(Lib_Ngs2, "rackId = {:#x}", rackId);
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
+    }
+    if (!bufferInfo) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack buffer info {}", (void*)bufferInfo);
+        return ORBIS_NGS2_ERROR_INVALID_BUFFER_INFO;
+    }
+    if (!outHandle) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack handle address {}", (void*)outHandle);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    const size_t requiredBufferSize = RackQueryBufferSize(rackId, option);
+    if (!bufferInfo->hostBuffer || bufferInfo->hostBufferSize < requiredBufferSize) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack buffer ({}, {}<{}[byte])", bufferInfo->hostBuffer,
+                  bufferInfo->hostBufferSize, requiredBufferSize);
+        return ORBIS_NGS2_ERROR_INVALID_BUFFER_SIZE;
     }
+    Ngs2Rack* rack;
+    const s32 result = RackCreate(*system, rackId, option, *bufferInfo, &rack);
+    if (result < 0) {
+        return result;
+    }
+    *outHandle = rack->Handle();
     return ORBIS_OK;
 }
 
@@ -63,55 +98,159 @@ s32 PS4_SYSV_ABI sceNgs2RackCreateWithAllocator(OrbisNgs2Handle systemHandle, u3
                                                 const OrbisNgs2RackOption* option,
                                                 const OrbisNgs2BufferAllocator* allocator,
                                                 OrbisNgs2Handle* outHandle) {
-    LOG_ERROR(Lib_Ngs2, "rackId = {}", rackId);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_INFO(Lib_Ngs2, "rackId = {:#x}", rackId);
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
+    }
+    if (!allocator || !allocator->allocHandler) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack buffer allocator {}", (void*)allocator);
+        return ORBIS_NGS2_ERROR_INVALID_BUFFER_ALLOCATOR;
+    }
+    if (!outHandle) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack handle address {}", (void*)outHandle);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    OrbisNgs2ContextBufferInfo bufferInfo{};
+    bufferInfo.hostBufferSize = RackQueryBufferSize(rackId, option);
+    bufferInfo.userData = allocator->userData;
+    s32 result = Core::ExecuteGuest(allocator->allocHandler, &bufferInfo);
+    if (result < 0) {
+        return result;
+    }
+    Ngs2Rack* rack;
+    result = RackCreate(*system, rackId, option, bufferInfo, &rack);
+    if (result < 0) {
+        if (allocator->freeHandler) {
+            Core::ExecuteGuest(allocator->freeHandler, &bufferInfo);
+        }
+        return result;
     }
+    rack->host_free = allocator->freeHandler;
+    *outHandle = rack->Handle();
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackDestroy(OrbisNgs2Handle rackHandle,
                                     OrbisNgs2ContextBufferInfo* outBufferInfo) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    OrbisNgs2ContextBufferInfo bufferInfo;
+    OrbisNgs2BufferFreeHandler hostFree;
+    {
+        const auto rack = GetRack(rackHandle);
+        if (!rack) {
+            return HandleReportInvalid(rackHandle, 2);
+        }
+        bufferInfo = rack->buffer_info;
+        hostFree = rack->host_free;
+        rack->system.DestroyRack(rack.get());
+    }
+    if (outBufferInfo) {
+        *outBufferInfo = bufferInfo;
+    }
+    if (hostFree) {
+        Core::ExecuteGuest(hostFree, &bufferInfo);
+    }
+    LOG_INFO(Lib_Ngs2, "called");
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackGetInfo(OrbisNgs2Handle rackHandle, OrbisNgs2RackInfo* outInfo,
                                     size_t infoSize) {
-    LOG_ERROR(Lib_Ngs2, "infoSize = {}", infoSize);
+    const auto rack = GetRack(rackHandle);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    if (!outInfo || infoSize < sizeof(OrbisNgs2RackInfo)) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack info {}, size {}", (void*)outInfo, infoSize);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    MemoryClear(outInfo, infoSize);
+    rack->name.copy(outInfo->name, ORBIS_NGS2_RACK_NAME_LENGTH - 1);
+    outInfo->rackHandle = rack->Handle();
+    outInfo->bufferInfo = rack->buffer_info;
+    outInfo->ownerSystemHandle = rack->system.Handle();
+    outInfo->rackId = rack->rack_id;
+    outInfo->uid = rack->uid;
+    outInfo->minGrainSamples = 64;
+    outInfo->maxGrainSamples = rack->max_grain_samples;
+    outInfo->maxVoices = rack->max_voices;
+    outInfo->maxMatrices = rack->max_matrices;
+    outInfo->maxPorts = rack->max_ports;
+    outInfo->lastProcessRatio = rack->last_process_ratio;
+    outInfo->lastProcessTick = rack->last_process_tick;
+    outInfo->renderCount = rack->render_count;
+    outInfo->activeVoiceCount = static_cast<u32>(
+        std::ranges::count_if(rack->voices, [](const auto& voice) { return voice->IsActive(); }));
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackGetUserData(OrbisNgs2Handle rackHandle, uintptr_t* outUserData) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    const auto rack = GetRack(rackHandle);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    if (!outUserData) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    *outUserData = rack->user_data;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackGetVoiceHandle(OrbisNgs2Handle rackHandle, u32 voiceIndex,
                                            OrbisNgs2Handle* outHandle) {
-    LOG_DEBUG(Lib_Ngs2, "(STUBBED) voiceIndex = {}", voiceIndex);
+    const auto rack = GetRack(rackHandle);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    if (voiceIndex >= rack->voices.size()) {
+        LOG_ERROR(Lib_Ngs2, "Invalid voice index {} (max {})", voiceIndex, rack->voices.size());
+        return ORBIS_NGS2_ERROR_INVALID_VOICE_INDEX;
+    }
+    if (!outHandle) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    *outHandle = rack->voices[voiceIndex]->Handle();
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackLock(OrbisNgs2Handle rackHandle) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    const auto rack = GetRack(rackHandle);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    // Held on top of the lookup lock, which is released on return.
+    rack->system.mutex.lock();
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackQueryBufferSize(u32 rackId, const OrbisNgs2RackOption* option,
                                             OrbisNgs2ContextBufferInfo* outBufferInfo) {
-    LOG_ERROR(Lib_Ngs2, "rackId = {}", rackId);
+    LOG_INFO(Lib_Ngs2, "rackId = {:#x}", rackId);
+    if (!outBufferInfo) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack buffer info {}", (void*)outBufferInfo);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    outBufferInfo->hostBuffer = nullptr;
+    outBufferInfo->hostBufferSize = RackQueryBufferSize(rackId, option);
+    MemoryClear(&outBufferInfo->reserved, sizeof(outBufferInfo->reserved));
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackSetUserData(OrbisNgs2Handle rackHandle, uintptr_t userData) {
-    LOG_ERROR(Lib_Ngs2, "userData = {}", userData);
+    const auto rack = GetRack(rackHandle);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    rack->user_data = userData;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackUnlock(OrbisNgs2Handle rackHandle) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    const auto rack = GetRack(rackHandle);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    rack->system.mutex.unlock();
     return ORBIS_OK;
 }
 
@@ -185,50 +324,96 @@ s32 PS4_SYSV_ABI sceNgs2SystemCreateWithAllocator(const OrbisNgs2SystemOption* o
 
 s32 PS4_SYSV_ABI sceNgs2SystemDestroy(OrbisNgs2Handle systemHandle,
                                       OrbisNgs2ContextBufferInfo* outBufferInfo) {
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
+    }
+    const OrbisNgs2BufferFreeHandler hostFree = system->host_free;
+    OrbisNgs2ContextBufferInfo bufferInfo;
+    SystemCleanup(systemHandle, &bufferInfo);
+    if (outBufferInfo) {
+        *outBufferInfo = bufferInfo;
+    }
+    if (hostFree) {
+        Core::ExecuteGuest(hostFree, &bufferInfo);
     }
     LOG_INFO(Lib_Ngs2, "called");
     return ORBIS_OK;
 }
 
+static s32 CopyHandles(const std::vector<OrbisNgs2Handle>& handles, OrbisNgs2Handle* aOutHandle,
+                       u32 maxHandles) {
+    if (aOutHandle) {
+        std::copy_n(handles.begin(), std::min<size_t>(handles.size(), maxHandles), aOutHandle);
+    }
+    return static_cast<s32>(handles.size());
+}
+
 s32 PS4_SYSV_ABI sceNgs2SystemEnumHandles(OrbisNgs2Handle* aOutHandle, u32 maxHandles) {
-    LOG_ERROR(Lib_Ngs2, "maxHandles = {}", maxHandles);
-    return ORBIS_OK;
+    LOG_DEBUG(Lib_Ngs2, "maxHandles = {}", maxHandles);
+    return CopyHandles(EnumHandles(OrbisNgs2HandleType::System), aOutHandle, maxHandles);
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemEnumRackHandles(OrbisNgs2Handle systemHandle,
                                               OrbisNgs2Handle* aOutHandle, u32 maxHandles) {
-    LOG_ERROR(Lib_Ngs2, "maxHandles = {}", maxHandles);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_DEBUG(Lib_Ngs2, "maxHandles = {}", maxHandles);
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    return ORBIS_OK;
+    std::scoped_lock lk{system->mutex};
+    std::vector<OrbisNgs2Handle> handles;
+    for (const auto& rack : system->racks) {
+        handles.push_back(rack->Handle());
+    }
+    return CopyHandles(handles, aOutHandle, maxHandles);
 }
 
-s32 PS4_SYSV_ABI sceNgs2SystemGetInfo(OrbisNgs2Handle rackHandle, OrbisNgs2SystemInfo* outInfo,
+s32 PS4_SYSV_ABI sceNgs2SystemGetInfo(OrbisNgs2Handle systemHandle, OrbisNgs2SystemInfo* outInfo,
                                       size_t infoSize) {
-    LOG_ERROR(Lib_Ngs2, "infoSize = {}", infoSize);
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
+    }
+    if (!outInfo || infoSize < sizeof(OrbisNgs2SystemInfo)) {
+        LOG_ERROR(Lib_Ngs2, "Invalid system info {}, size {}", (void*)outInfo, infoSize);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    std::scoped_lock lk{system->mutex};
+    MemoryClear(outInfo, infoSize);
+    system->name.copy(outInfo->name, ORBIS_NGS2_SYSTEM_NAME_LENGTH - 1);
+    outInfo->systemHandle = system->Handle();
+    outInfo->bufferInfo = system->buffer_info;
+    outInfo->uid = system->uid;
+    outInfo->minGrainSamples = 64;
+    outInfo->maxGrainSamples = system->max_grain_samples;
+    outInfo->rackCount = static_cast<u32>(system->racks.size());
+    outInfo->lastRenderRatio = system->last_render_ratio;
+    outInfo->lastRenderTick = system->last_render_tick;
+    outInfo->renderCount = system->render_count;
+    outInfo->sampleRate = system->sample_rate;
+    outInfo->numGrainSamples = system->num_grain_samples;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemGetUserData(OrbisNgs2Handle systemHandle, uintptr_t* outUserData) {
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    LOG_ERROR(Lib_Ngs2, "called");
+    if (!outUserData) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    *outUserData = system->user_data;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemLock(OrbisNgs2Handle systemHandle) {
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    LOG_ERROR(Lib_Ngs2, "called");
+    system->mutex.lock();
     return ORBIS_OK;
 }
 
@@ -249,12 +434,16 @@ s32 PS4_SYSV_ABI sceNgs2SystemQueryBufferSize(const OrbisNgs2SystemOption* optio
 s32 PS4_SYSV_ABI sceNgs2SystemRender(OrbisNgs2Handle systemHandle,
                                      const OrbisNgs2RenderBufferInfo* aBufferInfo,
                                      u32 numBufferInfo) {
-    LOG_DEBUG(Lib_Ngs2, "(STUBBED) numBufferInfo = {}", numBufferInfo);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_TRACE(Lib_Ngs2, "numBufferInfo = {}", numBufferInfo);
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    return ORBIS_OK;
+    if (numBufferInfo != 0 && !aBufferInfo) {
+        LOG_ERROR(Lib_Ngs2, "Invalid render buffer info {}", (void*)aBufferInfo);
+        return ORBIS_NGS2_ERROR_INVALID_BUFFER_INFO;
+    }
+    return system->Render(aBufferInfo, numBufferInfo);
 }
 
 static s32 PS4_SYSV_ABI sceNgs2SystemResetOption(OrbisNgs2SystemOption* outOption) {
@@ -272,73 +461,142 @@ static s32 PS4_SYSV_ABI sceNgs2SystemResetOption(OrbisNgs2SystemOption* outOptio
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemSetGrainSamples(OrbisNgs2Handle systemHandle, u32 numSamples) {
-    LOG_ERROR(Lib_Ngs2, "numSamples = {}", numSamples);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_INFO(Lib_Ngs2, "numSamples = {}", numSamples);
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
+    std::scoped_lock lk{system->mutex};
+    if (numSamples < 64 || numSamples > system->max_grain_samples || (numSamples & 63) != 0) {
+        LOG_ERROR(Lib_Ngs2, "Invalid grain samples {} (max {})", numSamples,
+                  system->max_grain_samples);
+        return ORBIS_NGS2_ERROR_INVALID_NUM_GRAIN_SAMPLES;
+    }
+    system->num_grain_samples = numSamples;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemSetSampleRate(OrbisNgs2Handle systemHandle, u32 sampleRate) {
-    LOG_ERROR(Lib_Ngs2, "sampleRate = {}", sampleRate);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_INFO(Lib_Ngs2, "sampleRate = {}", sampleRate);
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
+    }
+    if (sampleRate == 0) {
+        return ORBIS_NGS2_ERROR_INVALID_SAMPLE_RATE;
     }
+    std::scoped_lock lk{system->mutex};
+    system->sample_rate = sampleRate;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemSetUserData(OrbisNgs2Handle systemHandle, uintptr_t userData) {
-    LOG_ERROR(Lib_Ngs2, "userData = {}", userData);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
+    system->user_data = userData;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemUnlock(OrbisNgs2Handle systemHandle) {
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    const auto system = GetSystem(systemHandle);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    LOG_ERROR(Lib_Ngs2, "called");
+    system->mutex.unlock();
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceControl(OrbisNgs2Handle voiceHandle,
                                      const OrbisNgs2VoiceParamHeader* paramList) {
-    LOG_ERROR(Lib_Ngs2, "called");
-    return ORBIS_OK;
+    const auto voice = GetVoice(voiceHandle);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (!paramList) {
+        return ORBIS_NGS2_ERROR_INVALID_VOICE_CONTROL_ADDRESS;
+    }
+    return voice->Control(paramList);
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetMatrixInfo(OrbisNgs2Handle voiceHandle, u32 matrixId,
                                            OrbisNgs2VoiceMatrixInfo* outInfo, size_t outInfoSize) {
-    LOG_ERROR(Lib_Ngs2, "matrixId = {}, outInfoSize = {}", matrixId, outInfoSize);
+    const auto voice = GetVoice(voiceHandle);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (matrixId >= voice->matrices.size()) {
+        return ORBIS_NGS2_ERROR_INVALID_MATRIX_INDEX;
+    }
+    if (!outInfo || outInfoSize < sizeof(OrbisNgs2VoiceMatrixInfo)) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    const auto& matrix = voice->matrices[matrixId];
+    outInfo->numLevels = matrix.num_levels;
+    std::ranges::copy(matrix.levels, outInfo->aLevel);
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetOwner(OrbisNgs2Handle voiceHandle, OrbisNgs2Handle* outRackHandle,
                                       u32* outVoiceId) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    const auto voice = GetVoice(voiceHandle);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (outRackHandle) {
+        *outRackHandle = voice->rack.Handle();
+    }
+    if (outVoiceId) {
+        *outVoiceId = voice->index;
+    }
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetPortInfo(OrbisNgs2Handle voiceHandle, u32 port,
                                          OrbisNgs2VoicePortInfo* outInfo, size_t outInfoSize) {
-    LOG_ERROR(Lib_Ngs2, "port = {}, outInfoSize = {}", port, outInfoSize);
+    const auto voice = GetVoice(voiceHandle);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (port >= voice->ports.size()) {
+        return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+    }
+    if (!outInfo || outInfoSize < sizeof(OrbisNgs2VoicePortInfo)) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    const auto& voicePort = voice->ports[port];
+    outInfo->matrixId = voicePort.matrix_id;
+    outInfo->volume = voicePort.volume;
+    outInfo->numDelaySamples = voicePort.num_delay_samples;
+    outInfo->destInputId = voicePort.dest_input_id;
+    outInfo->destHandle = voicePort.dest ? voicePort.dest->Handle() : 0;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetState(OrbisNgs2Handle voiceHandle, OrbisNgs2VoiceState* outState,
                                       size_t stateSize) {
-    LOG_ERROR(Lib_Ngs2, "stateSize = {}", stateSize);
+    const auto voice = GetVoice(voiceHandle);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (!outState || stateSize < sizeof(OrbisNgs2VoiceState)) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    MemoryClear(outState, stateSize);
+    voice->GetState(outState, stateSize);
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetStateFlags(OrbisNgs2Handle voiceHandle, u32* outStateFlags) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    const auto voice = GetVoice(voiceHandle);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (!outStateFlags) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    *outStateFlags = voice->state_flags;
     return ORBIS_OK;
 }
 
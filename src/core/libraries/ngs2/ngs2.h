@@ -32,6 +32,51 @@ static const int ORBIS_NGS2_WAVEFORM_INFO_MAX_BLOCKS = 4;
 static const int ORBIS_NGS2_MAX_MATRIX_LEVELS =
     (ORBIS_NGS2_MAX_VOICE_CHANNELS * ORBIS_NGS2_MAX_VOICE_CHANNELS);
 
+static const u32 ORBIS_NGS2_RACK_ID_SAMPLER = 0x1000;
+static const u32 ORBIS_NGS2_RACK_ID_SUBMIXER = 0x2000;
+static const u32 ORBIS_NGS2_RACK_ID_REVERB = 0x2001;
+static const u32 ORBIS_NGS2_RACK_ID_EQ = 0x2002;
+static const u32 ORBIS_NGS2_RACK_ID_MASTERING = 0x3000;
+static const u32 ORBIS_NGS2_RACK_ID_CUSTOM_SAMPLER = 0x4001;
+static const u32 ORBIS_NGS2_RACK_ID_CUSTOM_SUBMIXER = 0x4002;
+static const u32 ORBIS_NGS2_RACK_ID_CUSTOM_MASTERING = 0x4003;
+
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_U8 = 0x10;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_I16L = 0x12;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_I16B = 0x13;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_I24L = 0x14;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_I24B = 0x15;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_I32L = 0x16;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_I32B = 0x17;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_F32L = 0x18;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_PCM_F32B = 0x19;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_VAG = 0x1c;
+static const u32 ORBIS_NGS2_WAVEFORM_TYPE_ATRAC9 = 0x40;
+
+static const u32 ORBIS_NGS2_VOICE_PARAM_MATRIX_LEVELS = 1;
+static const u32 ORBIS_NGS2_VOICE_PARAM_PORT_MATRIX = 2;
+static const u32 ORBIS_NGS2_VOICE_PARAM_PORT_VOLUME = 3;
+static const u32 ORBIS_NGS2_VOICE_PARAM_PORT_DELAY = 4;
+static const u32 ORBIS_NGS2_VOICE_PARAM_PATCH = 5;
+static const u32 ORBIS_NGS2_VOICE_PARAM_EVENT = 6;
+static const u32 ORBIS_NGS2_VOICE_PARAM_CALLBACK = 7;
+
+static const u32 ORBIS_NGS2_VOICE_EVENT_PLAY = 0;
+static const u32 ORBIS_NGS2_VOICE_EVENT_STOP = 1;
+static const u32 ORBIS_NGS2_VOICE_EVENT_STOP_IMM = 2;
+static const u32 ORBIS_NGS2_VOICE_EVENT_KILL = 3;
+static const u32 ORBIS_NGS2_VOICE_EVENT_PAUSE = 4;
+static const u32 ORBIS_NGS2_VOICE_EVENT_RESUME = 5;
+
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_INUSE = 0x1;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING = 0x2;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED = 0x4;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_STOPPED = 0x8;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_ERROR = 0x10;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_EMPTY = 0x20;
+
+static const u32 ORBIS_NGS2_VOICE_CALLBACK_FLAG_WAVEFORM_BLOCK_END = 0x1;
+
 struct OrbisNgs2WaveformFormat {
     u32 waveformType;
     u32 numChannels;
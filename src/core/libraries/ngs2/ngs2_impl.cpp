@@ -1,17 +1,808 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <latch>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "ngs2.h"
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_mastering.h"
+#include "ngs2_sampler.h"
+#include "ngs2_submixer.h"
 
+#include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread_worker.h"
 #include "core/libraries/error_codes.h"
 #include "core/libraries/kernel/kernel.h"
+#include "core/libraries/libs.h"
 
 using namespace Libraries::Kernel;
 
 namespace Libraries::Ngs2 {
 
+// Guards against parameter lists whose next offsets loop back on themselves.
+static constexpr u32 MaxVoiceControlParams = 1024;
+
+// Source voices are spread over the render workers in chunks of at least this many voices.
+static constexpr size_t MinVoicesPerRenderTask = 16;
+
+// Average render load is logged once per this many grains.
+static constexpr u64 RenderStatsInterval = 1000;
+
+void MixScaled(float* dst, const float* src, float gain, u32 num_samples) {
+    u32 i = 0;
+#if defined(__AVX__)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 8 <= num_samples; i += 8) {
+        const __m256 s = _mm256_loadu_ps(src + i);
+        const __m256 d = _mm256_loadu_ps(dst + i);
+#if defined(__FMA__)
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(s, g, d));
+#else
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(d, _mm256_mul_ps(s, g)));
+#endif
+    }
+#elif defined(__SSE2__)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= num_samples; i += 4) {
+        const __m128 s = _mm_loadu_ps(src + i);
+        const __m128 d = _mm_loadu_ps(dst + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(d, _mm_mul_ps(s, g)));
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+void MixRamp(float* dst, const float* src, float from, float to, u32 num_samples) {
+    if (from == to) {
+        MixScaled(dst, src, from, num_samples);
+        return;
+    }
+    const float step = (to - from) / static_cast<float>(num_samples);
+    u32 i = 0;
+#if defined(__AVX__)
+    __m256 g = _mm256_add_ps(_mm256_set1_ps(from),
+                             _mm256_mul_ps(_mm256_set1_ps(step),
+                                           _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f)));
+    const __m256 g_step = _mm256_set1_ps(step * 8.0f);
+    for (; i + 8 <= num_samples; i += 8) {
+        const __m256 s = _mm256_loadu_ps(src + i);
+        const __m256 d = _mm256_loadu_ps(dst + i);
+#if defined(__FMA__)
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(s, g, d));
+#else
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(d, _mm256_mul_ps(s, g)));
+#endif
+        g = _mm256_add_ps(g, g_step);
+    }
+#elif defined(__SSE2__)
+    __m128 g = _mm_add_ps(_mm_set1_ps(from),
+                          _mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0.f, 1.f, 2.f, 3.f)));
+    const __m128 g_step = _mm_set1_ps(step * 4.0f);
+    for (; i + 4 <= num_samples; i += 4) {
+        const __m128 s = _mm_loadu_ps(src + i);
+        const __m128 d = _mm_loadu_ps(dst + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(d, _mm_mul_ps(s, g)));
+        g = _mm_add_ps(g, g_step);
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        dst[i] += src[i] * (from + step * static_cast<float>(i));
+    }
+}
+
+void ScaleRamp(float* data, float from, float to, u32 num_samples) {
+    if (from == 1.0f && to == 1.0f) {
+        return;
+    }
+    const float step = (to - from) / static_cast<float>(num_samples);
+    u32 i = 0;
+#if defined(__AVX__)
+    __m256 g = _mm256_add_ps(_mm256_set1_ps(from),
+                             _mm256_mul_ps(_mm256_set1_ps(step),
+                                           _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f)));
+    const __m256 g_step = _mm256_set1_ps(step * 8.0f);
+    for (; i + 8 <= num_samples; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+        g = _mm256_add_ps(g, g_step);
+    }
+#elif defined(__SSE2__)
+    __m128 g = _mm_add_ps(_mm_set1_ps(from),
+                          _mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0.f, 1.f, 2.f, 3.f)));
+    const __m128 g_step = _mm_set1_ps(step * 4.0f);
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+        g = _mm_add_ps(g, g_step);
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        data[i] *= from + step * static_cast<float>(i);
+    }
+}
+
+void Ngs2Envelope::SetPoints(const OrbisNgs2EnvelopePoint* points, u32 num_forward,
+                             u32 num_release) {
+    forward_points.clear();
+    release_points.clear();
+    for (u32 i = 0; i < num_forward + num_release; ++i) {
+        auto& list = i < num_forward ? forward_points : release_points;
+        list.push_back({points[i].duration, points[i].height});
+    }
+    Start();
+}
+
+void Ngs2Envelope::Start() {
+    released = false;
+    point_index = 0;
+    elapsed_us = 0.0;
+    // Without forward points the envelope is flat, otherwise it rises from silence.
+    height = forward_points.empty() ? 1.0f : 0.0f;
+    segment_start = height;
+}
+
+void Ngs2Envelope::Release() {
+    released = true;
+    point_index = 0;
+    elapsed_us = 0.0;
+    segment_start = height;
+}
+
+float Ngs2Envelope::Advance(u32 num_samples, u32 sample_rate) {
+    const auto& points = released ? release_points : forward_points;
+    double remaining_us = num_samples * 1'000'000.0 / sample_rate;
+    while (remaining_us > 0.0 && point_index < points.size()) {
+        const auto& point = points[point_index];
+        const double left_us = point.duration_us - elapsed_us;
+        if (remaining_us < left_us) {
+            elapsed_us += remaining_us;
+            const float t = static_cast<float>(elapsed_us / point.duration_us);
+            height = segment_start + (point.height - segment_start) * t;
+            break;
+        }
+        remaining_us -= left_us;
+        height = point.height;
+        segment_start = point.height;
+        elapsed_us = 0.0;
+        ++point_index;
+    }
+    return height;
+}
+
+struct HandleEntry {
+    OrbisNgs2HandleType type;
+    std::weak_ptr<Ngs2System> owner;
+};
+
+static std::mutex handle_mutex;
+static std::unordered_map<OrbisNgs2Handle, HandleEntry> handle_entries;
+/// Keeps every system alive until it is destroyed, lookups take their own reference.
+static std::unordered_map<OrbisNgs2Handle, std::shared_ptr<Ngs2System>> systems;
+
+void RegisterSystem(std::shared_ptr<Ngs2System> system) {
+    std::scoped_lock lk{handle_mutex};
+    handle_entries[system->Handle()] = {OrbisNgs2HandleType::System, system};
+    systems.emplace(system->Handle(), std::move(system));
+}
+
+std::shared_ptr<Ngs2System> UnregisterSystem(Ngs2System& system) {
+    std::scoped_lock lk{handle_mutex};
+    std::erase_if(handle_entries, [&system](const auto& entry) {
+        return entry.second.owner.lock().get() == &system;
+    });
+    const auto it = systems.find(system.Handle());
+    if (it == systems.end()) {
+        return nullptr;
+    }
+    auto owned = std::move(it->second);
+    systems.erase(it);
+    return owned;
+}
+
+void RegisterHandle(OrbisNgs2Handle handle, OrbisNgs2HandleType type, Ngs2System& owner) {
+    std::scoped_lock lk{handle_mutex};
+    handle_entries[handle] = {type, owner.weak_from_this()};
+}
+
+void UnregisterHandle(OrbisNgs2Handle handle) {
+    std::scoped_lock lk{handle_mutex};
+    handle_entries.erase(handle);
+}
+
+std::shared_ptr<Ngs2System> HandleOwner(OrbisNgs2Handle handle, OrbisNgs2HandleType type) {
+    std::scoped_lock lk{handle_mutex};
+    const auto it = handle_entries.find(handle);
+    return it != handle_entries.end() && it->second.type == type ? it->second.owner.lock()
+                                                                 : nullptr;
+}
+
+std::vector<OrbisNgs2Handle> EnumHandles(OrbisNgs2HandleType type) {
+    std::scoped_lock lk{handle_mutex};
+    std::vector<OrbisNgs2Handle> handles;
+    for (const auto& [handle, entry] : handle_entries) {
+        if (entry.type == type) {
+            handles.push_back(handle);
+        }
+    }
+    return handles;
+}
+
+Ngs2Voice::Ngs2Voice(Ngs2Rack& rack_, u32 index_)
+    : rack{rack_}, index{index_}, state_flags{0}, ports(rack_.max_ports),
+      matrices(rack_.max_matrices), max_grain_samples{rack_.max_grain_samples} {
+    SetChannels(0, 1);
+}
+
+Ngs2Voice::~Ngs2Voice() = default;
+
+void Ngs2Voice::SetChannels(u32 num_inputs, u32 num_outputs) {
+    num_input_channels = num_inputs;
+    num_output_channels = num_outputs;
+    input.assign(num_inputs * max_grain_samples, 0.0f);
+    output.assign(num_outputs * max_grain_samples, 0.0f);
+}
+
+s32 Ngs2Voice::Control(const OrbisNgs2VoiceParamHeader* param_list) {
+    const auto* param = param_list;
+    for (u32 count = 0; param != nullptr; ++count) {
+        if (count >= MaxVoiceControlParams) {
+            return ORBIS_NGS2_ERROR_DETECTED_CIRCULAR_VOICE_CONTROL;
+        }
+        if (param->size < sizeof(OrbisNgs2VoiceParamHeader)) {
+            LOG_ERROR(Lib_Ngs2, "Invalid voice control size {} for id {:#x}", param->size,
+                      param->id);
+            return ORBIS_NGS2_ERROR_INVALID_VOICE_CONTROL_SIZE;
+        }
+        if (const s32 result = ControlParam(param); result < 0) {
+            return result;
+        }
+        // The next field is a byte offset from this parameter, zero ends the list.
+        if (param->next == 0) {
+            break;
+        }
+        param = reinterpret_cast<const OrbisNgs2VoiceParamHeader*>(
+            reinterpret_cast<const u8*>(param) + param->next);
+    }
+    return ORBIS_OK;
+}
+
+s32 Ngs2Voice::ControlParam(const OrbisNgs2VoiceParamHeader* param) {
+    switch (param->id) {
+    case ORBIS_NGS2_VOICE_PARAM_MATRIX_LEVELS: {
+        const auto* levels = reinterpret_cast<const OrbisNgs2VoiceMatrixLevelsParam*>(param);
+        if (levels->matrixId >= matrices.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_MATRIX_INDEX;
+        }
+        if (levels->numLevels > ORBIS_NGS2_MAX_MATRIX_LEVELS) {
+            return ORBIS_NGS2_ERROR_INVALID_NUM_MATRIX_LEVELS;
+        }
+        if (levels->numLevels != 0 && levels->aLevel == nullptr) {
+            return ORBIS_NGS2_ERROR_INVALID_MATRIX_LEVEL_ADDRESS;
+        }
+        auto& matrix = matrices[levels->matrixId];
+        matrix.num_levels = levels->numLevels;
+        std::copy_n(levels->aLevel, levels->numLevels, matrix.levels.begin());
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_PORT_MATRIX: {
+        const auto* port_matrix = reinterpret_cast<const OrbisNgs2VoicePortMatrixParam*>(param);
+        if (port_matrix->port >= ports.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+        }
+        if (port_matrix->matrixId >= static_cast<s32>(matrices.size())) {
+            return ORBIS_NGS2_ERROR_INVALID_MATRIX_INDEX;
+        }
+        ports[port_matrix->port].matrix_id = port_matrix->matrixId;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_PORT_VOLUME: {
+        const auto* volume = reinterpret_cast<const OrbisNgs2VoicePortVolumeParam*>(param);
+        if (volume->port >= ports.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+        }
+        ports[volume->port].volume = volume->level;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_PORT_DELAY: {
+        const auto* delay = reinterpret_cast<const OrbisNgs2VoicePortDelayParam*>(param);
+        if (delay->port >= ports.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+        }
+        ports[delay->port].num_delay_samples = delay->numSamples;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_PATCH: {
+        const auto* patch = reinterpret_cast<const OrbisNgs2VoicePatchParam*>(param);
+        if (patch->port >= ports.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+        }
+        auto& port = ports[patch->port];
+        if (patch->destHandle == 0) {
+            port.dest = nullptr;
+            rack.system.InvalidateRenderOrder();
+            return ORBIS_OK;
+        }
+        // Only voices of this system are safe to touch, its lock is held by the caller.
+        if (HandleOwner(patch->destHandle, OrbisNgs2HandleType::Voice).get() != &rack.system) {
+            LOG_ERROR(Lib_Ngs2, "Invalid patch destination {:#x}", patch->destHandle);
+            return ORBIS_NGS2_ERROR_INVALID_PATCH;
+        }
+        auto* dest = reinterpret_cast<Ngs2Voice*>(patch->destHandle);
+        if (dest->rack.Stage() == 0 || dest->rack.Stage() < rack.Stage() || dest->Reaches(this)) {
+            LOG_ERROR(Lib_Ngs2, "Invalid patch from rack {:#x} to {:#x}", rack.rack_id,
+                      dest->rack.rack_id);
+            return ORBIS_NGS2_ERROR_INVALID_PATCH;
+        }
+        port.dest = dest;
+        port.dest_input_id = patch->destInputId;
+        rack.system.InvalidateRenderOrder();
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_EVENT: {
+        const auto* event = reinterpret_cast<const OrbisNgs2VoiceEventParam*>(param);
+        return HandleEvent(event->eventId);
+    }
+    case ORBIS_NGS2_VOICE_PARAM_CALLBACK: {
+        const auto* callback = reinterpret_cast<const OrbisNgs2VoiceCallbackParam*>(param);
+        callback_handler = reinterpret_cast<uintptr_t>(callback->callbackHandler);
+        callback_data = callback->callbackData;
+        callback_flags = callback->flags;
+        return ORBIS_OK;
+    }
+    default:
+        LOG_ERROR(Lib_Ngs2, "Unhandled voice control id {:#x} on rack {:#x}", param->id,
+                  rack.rack_id);
+        return ORBIS_NGS2_ERROR_INVALID_VOICE_CONTROL_ID;
+    }
+}
+
+s32 Ngs2Voice::HandleEvent(u32 event_id) {
+    switch (event_id) {
+    case ORBIS_NGS2_VOICE_EVENT_PLAY:
+        state_flags = ORBIS_NGS2_VOICE_STATE_FLAG_INUSE | ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING;
+        return ORBIS_OK;
+    case ORBIS_NGS2_VOICE_EVENT_STOP:
+    case ORBIS_NGS2_VOICE_EVENT_STOP_IMM:
+    case ORBIS_NGS2_VOICE_EVENT_KILL:
+        state_flags = 0;
+        return ORBIS_OK;
+    case ORBIS_NGS2_VOICE_EVENT_PAUSE:
+        state_flags |= ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED;
+        return ORBIS_OK;
+    case ORBIS_NGS2_VOICE_EVENT_RESUME:
+        state_flags &= ~ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED;
+        return ORBIS_OK;
+    default:
+        return ORBIS_NGS2_ERROR_INVALID_EVENT_TYPE;
+    }
+}
+
+void Ngs2Voice::GetState(void* out_state, size_t state_size) const {
+    auto* state = static_cast<OrbisNgs2VoiceState*>(out_state);
+    state->stateFlags = state_flags;
+}
+
+void Ngs2Voice::BeginGrain(u32 num_samples) {
+    for (u32 channel = 0; channel < num_input_channels; ++channel) {
+        std::fill_n(InputChannel(channel), num_samples, 0.0f);
+    }
+}
+
+bool Ngs2Voice::IsActive() const {
+    return (state_flags & ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING) &&
+           !(state_flags & ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED);
+}
+
+void Ngs2Voice::Route(u32 num_samples) {
+    for (const auto& port : ports) {
+        if (port.dest == nullptr || port.volume == 0.0f) {
+            continue;
+        }
+        Ngs2Voice& dest = *port.dest;
+        const Matrix* matrix = port.matrix_id >= 0 ? &matrices[port.matrix_id] : nullptr;
+        for (u32 in = 0; in < num_output_channels; ++in) {
+            for (u32 out = 0; out < dest.num_input_channels; ++out) {
+                // Levels are laid out per source channel. Without a matrix channels map one to
+                // one and mono sources fan out to every destination channel.
+                float level;
+                if (matrix != nullptr) {
+                    const u32 level_index = in * dest.num_input_channels + out;
+                    level = level_index < matrix->num_levels ? matrix->levels[level_index] : 0.0f;
+                } else {
+                    level = (num_output_channels == 1 || in == out) ? 1.0f : 0.0f;
+                }
+                if (level != 0.0f) {
+                    MixScaled(dest.InputChannel(out), OutputChannel(in), level * port.volume,
+                              num_samples);
+                }
+            }
+        }
+    }
+}
+
+void Ngs2Voice::Unpatch(const Ngs2Voice* voice) {
+    for (auto& port : ports) {
+        if (port.dest == voice) {
+            port.dest = nullptr;
+        }
+    }
+}
+
+bool Ngs2Voice::Reaches(const Ngs2Voice* voice) const {
+    std::vector<const Ngs2Voice*> pending{this};
+    std::unordered_set<const Ngs2Voice*> visited{this};
+    while (!pending.empty()) {
+        const Ngs2Voice* current = pending.back();
+        pending.pop_back();
+        if (current == voice) {
+            return true;
+        }
+        for (const auto& port : current->ports) {
+            if (port.dest != nullptr && visited.insert(port.dest).second) {
+                pending.push_back(port.dest);
+            }
+        }
+    }
+    return false;
+}
+
+void Ngs2Voice::RunCallback(u32 flag, uintptr_t user_data, const void* data, u32 data_size,
+                            u32 repeated_count) {
+    if (callback_handler == 0 || (callback_flags != 0 && !(callback_flags & flag))) {
+        return;
+    }
+    OrbisNgs2VoiceCallbackInfo info{};
+    info.callbackData = callback_data;
+    info.voiceHandle = Handle();
+    info.flag = flag;
+    info.param.waveformBlock.userData = user_data;
+    info.param.waveformBlock.data = data;
+    info.param.waveformBlock.dataSize = data_size;
+    info.param.waveformBlock.repeatedCount = repeated_count;
+    Core::ExecuteGuest(reinterpret_cast<OrbisNgs2VoiceCallbackHandler>(callback_handler), &info);
+}
+
+static std::atomic<u32> next_uid{1};
+
+Ngs2Rack::Ngs2Rack(Ngs2System& system_, u32 rack_id_, const OrbisNgs2RackOption* option,
+                   const OrbisNgs2ContextBufferInfo& buffer_info_)
+    : system{system_}, rack_id{rack_id_}, uid{next_uid++}, buffer_info{buffer_info_} {
+    max_voices = option && option->maxVoices ? option->maxVoices : 1;
+    max_ports = option && option->maxPorts ? option->maxPorts : 1;
+    max_matrices = option && option->maxMatrices ? option->maxMatrices : 1;
+    max_grain_samples = option && option->maxGrainSamples ? option->maxGrainSamples
+                                                           : system.max_grain_samples;
+    if (option) {
+        name.assign(option->name, strnlen(option->name, ORBIS_NGS2_RACK_NAME_LENGTH));
+    }
+}
+
+Ngs2Rack::~Ngs2Rack() {
+    for (const auto& voice : voices) {
+        UnregisterHandle(voice->Handle());
+    }
+    UnregisterHandle(Handle());
+}
+
+void Ngs2Rack::CreateVoices() {
+    voices.reserve(max_voices);
+    for (u32 i = 0; i < max_voices; ++i) {
+        voices.emplace_back(CreateVoice(i));
+    }
+}
+
+u32 Ngs2Rack::Stage() const {
+    switch (rack_id) {
+    case ORBIS_NGS2_RACK_ID_SAMPLER:
+    case ORBIS_NGS2_RACK_ID_CUSTOM_SAMPLER:
+        return 0;
+    case ORBIS_NGS2_RACK_ID_MASTERING:
+    case ORBIS_NGS2_RACK_ID_CUSTOM_MASTERING:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+size_t RackQueryBufferSize(u32 rack_id, const OrbisNgs2RackOption* option) {
+    const u32 max_voices = option && option->maxVoices ? option->maxVoices : 1;
+    return 0x1000 + max_voices * 0x400;
+}
+
+s32 RackCreate(Ngs2System& system, u32 rack_id, const OrbisNgs2RackOption* option,
+               const OrbisNgs2ContextBufferInfo& buffer_info, Ngs2Rack** out_rack) {
+    if (option && option->maxGrainSamples > 1024) {
+        return ORBIS_NGS2_ERROR_INVALID_MAX_GRAIN_SAMPLES;
+    }
+    if (option && option->maxVoices > 4096) {
+        return ORBIS_NGS2_ERROR_INVALID_MAX_VOICES;
+    }
+    if (option && option->maxPorts > ORBIS_NGS2_MAX_VOICE_CHANNELS) {
+        return ORBIS_NGS2_ERROR_INVALID_MAX_PORTS;
+    }
+
+    std::unique_ptr<Ngs2Rack> rack;
+    switch (rack_id) {
+    case ORBIS_NGS2_RACK_ID_SAMPLER:
+    case ORBIS_NGS2_RACK_ID_CUSTOM_SAMPLER:
+        rack = std::make_unique<Ngs2Sampler>(system, rack_id, option, buffer_info);
+        break;
+    case ORBIS_NGS2_RACK_ID_SUBMIXER:
+    case ORBIS_NGS2_RACK_ID_REVERB:
+    case ORBIS_NGS2_RACK_ID_EQ:
+    case ORBIS_NGS2_RACK_ID_CUSTOM_SUBMIXER:
+        rack = std::make_unique<Ngs2Submixer>(system, rack_id, option, buffer_info);
+        break;
+    case ORBIS_NGS2_RACK_ID_MASTERING:
+    case ORBIS_NGS2_RACK_ID_CUSTOM_MASTERING:
+        rack = std::make_unique<Ngs2Mastering>(system, rack_id, option, buffer_info);
+        break;
+    default:
+        LOG_ERROR(Lib_Ngs2, "Invalid rack id {:#x}", rack_id);
+        return ORBIS_NGS2_ERROR_INVALID_RACK_ID;
+    }
+    rack->CreateVoices();
+    *out_rack = rack.get();
+    if (!system.AddRack(std::move(rack))) {
+        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    }
+    return ORBIS_OK;
+}
+
+static Common::ThreadWorker& RenderWorkers() {
+    static Common::ThreadWorker workers{
+        std::clamp<size_t>(std::thread::hardware_concurrency() / 4, 1, 4), "Ngs2Render"};
+    return workers;
+}
+
+Ngs2System::Ngs2System(const OrbisNgs2SystemOption* option,
+                       const OrbisNgs2ContextBufferInfo& buffer_info_,
+                       OrbisNgs2BufferFreeHandler host_free_)
+    : buffer_info{buffer_info_}, host_free{host_free_}, uid{next_uid++} {
+    sample_rate = option ? option->sampleRate : 48000;
+    num_grain_samples = option ? option->numGrainSamples : 256;
+    max_grain_samples = option ? option->maxGrainSamples : 512;
+    if (option) {
+        name.assign(option->name, strnlen(option->name, ORBIS_NGS2_SYSTEM_NAME_LENGTH));
+    }
+}
+
+Ngs2System::~Ngs2System() {
+    racks.clear();
+}
+
+bool Ngs2System::AddRack(std::unique_ptr<Ngs2Rack> rack) {
+    std::scoped_lock lk{mutex};
+    if (is_destroyed) {
+        return false;
+    }
+    RegisterHandle(rack->Handle(), OrbisNgs2HandleType::Rack, *this);
+    for (const auto& voice : rack->voices) {
+        RegisterHandle(voice->Handle(), OrbisNgs2HandleType::Voice, *this);
+    }
+    racks.push_back(std::move(rack));
+    is_sorted = false;
+    return true;
+}
+
+void Ngs2System::DestroyRack(Ngs2Rack* rack) {
+    std::scoped_lock lk{mutex};
+    for (const auto& other : racks) {
+        for (const auto& voice : other->voices) {
+            for (const auto& removed : rack->voices) {
+                voice->Unpatch(removed.get());
+            }
+        }
+    }
+    std::erase_if(racks, [rack](const auto& r) { return r.get() == rack; });
+    is_sorted = false;
+}
+
+void Ngs2System::SortRenderOrder() {
+    // Kahn's algorithm over the voice patches. Voices without pending inputs are taken in stage
+    // order, so the order only deviates from it where patches within a stage require it.
+    std::ranges::stable_sort(racks, {}, [](const auto& rack) { return rack->Stage(); });
+    std::unordered_map<const Ngs2Voice*, u32> num_inputs;
+    for (const auto& rack : racks) {
+        for (const auto& voice : rack->voices) {
+            num_inputs.try_emplace(voice.get(), 0);
+            for (const auto& port : voice->ports) {
+                if (port.dest != nullptr) {
+                    ++num_inputs[port.dest];
+                }
+            }
+        }
+    }
+    render_order.clear();
+    for (const auto& rack : racks) {
+        for (const auto& voice : rack->voices) {
+            if (num_inputs[voice.get()] == 0) {
+                render_order.push_back(voice.get());
+            }
+        }
+    }
+    for (size_t i = 0; i < render_order.size(); ++i) {
+        for (const auto& port : render_order[i]->ports) {
+            if (port.dest != nullptr && --num_inputs[port.dest] == 0) {
+                render_order.push_back(port.dest);
+            }
+        }
+    }
+    // Patches that would close a cycle are rejected, so every voice should be ordered by now.
+    ASSERT_MSG(render_order.size() == num_inputs.size(), "Cycle in the voice patch graph");
+    is_sorted = true;
+}
+
+void Ngs2System::ProcessSources(std::span<Ngs2Voice* const> sources, u32 num_samples) {
+    if (sources.size() < MinVoicesPerRenderTask * 2) {
+        for (auto* voice : sources) {
+            voice->Process(num_samples);
+        }
+        return;
+    }
+    // Sources only read guest waveform memory and write their own output, so they can be
+    // rendered in parallel. The calling thread takes the first chunk itself.
+    const size_t max_tasks = std::min<size_t>(std::thread::hardware_concurrency() / 4 + 1,
+                                              sources.size() / MinVoicesPerRenderTask);
+    const size_t chunk_size = (sources.size() + max_tasks - 1) / max_tasks;
+    // Rounding the chunks up can leave the last tasks without voices, don't start those.
+    const size_t num_tasks = (sources.size() + chunk_size - 1) / chunk_size;
+    std::latch done{static_cast<std::ptrdiff_t>(num_tasks - 1)};
+    for (size_t task = 1; task < num_tasks; ++task) {
+        const auto chunk = sources.subspan(task * chunk_size,
+                                           std::min(chunk_size, sources.size() - task * chunk_size));
+        RenderWorkers().QueueWork([chunk, num_samples, &done] {
+            for (auto* voice : chunk) {
+                voice->Process(num_samples);
+            }
+            done.count_down();
+        });
+    }
+    for (auto* voice : sources.first(chunk_size)) {
+        voice->Process(num_samples);
+    }
+    done.wait();
+}
+
+static void WriteRenderBuffer(const OrbisNgs2RenderBufferInfo& info, const float* mix,
+                              u32 num_samples) {
+    if (info.buffer == nullptr || info.numChannels == 0) {
+        return;
+    }
+    const u32 num_channels = std::min<u32>(info.numChannels, ORBIS_NGS2_MAX_VOICE_CHANNELS);
+    switch (info.waveformType) {
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_F32L: {
+        const u32 num_frames =
+            std::min<u32>(num_samples, info.bufferSize / (info.numChannels * sizeof(float)));
+        auto* out = static_cast<float*>(info.buffer);
+        for (u32 frame = 0; frame < num_frames; ++frame) {
+            for (u32 channel = 0; channel < num_channels; ++channel) {
+                out[frame * info.numChannels + channel] = mix[channel * num_samples + frame];
+            }
+        }
+        break;
+    }
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_I16L: {
+        const u32 num_frames =
+            std::min<u32>(num_samples, info.bufferSize / (info.numChannels * sizeof(s16)));
+        auto* out = static_cast<s16*>(info.buffer);
+        for (u32 frame = 0; frame < num_frames; ++frame) {
+            for (u32 channel = 0; channel < num_channels; ++channel) {
+                const float sample = std::clamp(mix[channel * num_samples + frame], -1.0f, 1.0f);
+                out[frame * info.numChannels + channel] = static_cast<s16>(sample * 32767.0f);
+            }
+        }
+        break;
+    }
+    default:
+        LOG_ERROR(Lib_Ngs2, "Unsupported render buffer waveform type {:#x}", info.waveformType);
+        std::memset(info.buffer, 0, info.bufferSize);
+        break;
+    }
+}
+
+s32 Ngs2System::Render(const OrbisNgs2RenderBufferInfo* buffers, u32 num_buffers) {
+    const auto start = std::chrono::steady_clock::now();
+    std::scoped_lock lk{mutex};
+    const u32 num_samples = num_grain_samples;
+
+    if (!is_sorted) {
+        SortRenderOrder();
+    }
+
+    active_sources.clear();
+    for (const auto& rack : racks) {
+        rack->process_time = {};
+        for (const auto& voice : rack->voices) {
+            voice->BeginGrain(num_samples);
+            if (rack->Stage() == 0 && voice->IsActive()) {
+                active_sources.push_back(voice.get());
+            }
+        }
+    }
+    ProcessSources(active_sources, num_samples);
+    for (auto* voice : active_sources) {
+        voice->FlushCallbacks();
+    }
+
+    // Voices of different racks may interleave, time each run of voices of the same rack.
+    const u32 mix_stride = ORBIS_NGS2_MAX_VOICE_CHANNELS * num_samples;
+    mix_buffer.assign(num_buffers * mix_stride, 0.0f);
+    Ngs2Rack* timed_rack = nullptr;
+    auto timed_start = std::chrono::steady_clock::now();
+    for (auto* voice : render_order) {
+        if (&voice->rack != timed_rack) {
+            const auto now = std::chrono::steady_clock::now();
+            if (timed_rack != nullptr) {
+                timed_rack->process_time += now - timed_start;
+            }
+            timed_rack = &voice->rack;
+            timed_start = now;
+        }
+        if (!voice->IsActive()) {
+            continue;
+        }
+        if (voice->rack.Stage() != 0) {
+            voice->Process(num_samples);
+        }
+        if (const auto output_index = voice->OutputIndex(); output_index.has_value()) {
+            if (*output_index >= num_buffers) {
+                continue;
+            }
+            const u32 num_channels =
+                std::min<u32>(voice->num_output_channels, ORBIS_NGS2_MAX_VOICE_CHANNELS);
+            for (u32 channel = 0; channel < num_channels; ++channel) {
+                MixScaled(&mix_buffer[*output_index * mix_stride + channel * num_samples],
+                          voice->OutputChannel(channel), 1.0f, num_samples);
+            }
+        } else {
+            voice->Route(num_samples);
+        }
+    }
+    if (timed_rack != nullptr) {
+        timed_rack->process_time += std::chrono::steady_clock::now() - timed_start;
+    }
+    const u64 process_tick =
+        std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count();
+    for (const auto& rack : racks) {
+        rack->last_process_ratio = static_cast<float>(
+            std::chrono::duration<double>(rack->process_time).count() * sample_rate / num_samples);
+        rack->last_process_tick = process_tick;
+        ++rack->render_count;
+    }
+
+    for (u32 i = 0; i < num_buffers; ++i) {
+        WriteRenderBuffer(buffers[i], &mix_buffer[i * mix_stride], num_samples);
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double grain_us = num_samples * 1'000'000.0 / sample_rate;
+    last_render_ratio = static_cast<float>(
+        std::chrono::duration<double, std::micro>(elapsed).count() / grain_us);
+    last_render_tick = std::chrono::duration_cast<std::chrono::microseconds>(
+                           start.time_since_epoch())
+                           .count();
+    render_time_total += elapsed;
+    if (++render_count % RenderStatsInterval == 0) {
+        const double average_us =
+            std::chrono::duration<double, std::micro>(render_time_total).count() /
+            RenderStatsInterval;
+        LOG_DEBUG(Lib_Ngs2, "System {}: {} sources, average render {:.1f} us ({:.1f}% of grain)",
+                  name, active_sources.size(), average_us, 100.0 * average_us / grain_us);
+        render_time_total = {};
+    }
+    return ORBIS_OK;
+}
+
 s32 HandleReportInvalid(OrbisNgs2Handle handle, u32 handleType) {
     switch (handleType) {
     case 1:
@@ -62,12 +853,24 @@ s32 StackBufferOpen(StackBuffer* stackBuffer, void* bufferStart, size_t bufferSi
 }
 
 s32 SystemCleanup(OrbisNgs2Handle systemHandle, OrbisNgs2ContextBufferInfo* outInfo) {
-    if (!systemHandle) {
+    const auto system = HandleOwner(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
         return ORBIS_NGS2_ERROR_INVALID_HANDLE;
     }
-
-    // TODO
-
+    std::shared_ptr<Ngs2System> owned;
+    {
+        // Waits for renders and rack or voice calls in flight. Once the handles are gone new
+        // lookups fail, and the system is freed when the last reference taken before goes.
+        std::scoped_lock lk{system->mutex};
+        if (system->is_destroyed) {
+            return ORBIS_NGS2_ERROR_INVALID_HANDLE;
+        }
+        system->is_destroyed = true;
+        owned = UnregisterSystem(*system);
+        if (outInfo) {
+            *outInfo = system->buffer_info;
+        }
+    }
     return ORBIS_OK;
 }
 
@@ -101,8 +904,9 @@ s32 SystemSetupCore(StackBuffer* stackBuffer, const OrbisNgs2SystemOption* optio
     }
 
     if (outSystem) {
-        // dummy handle
-        outSystem->systemHandle = 1;
+        outSystem->sampleRate = sampleRate;
+        outSystem->maxGrainSamples = maxGrainSamples;
+        outSystem->numGrainSamples = numGrainSamples;
     }
 
     return ORBIS_OK;
@@ -165,20 +969,14 @@ s32 SystemSetup(const OrbisNgs2SystemOption* option, OrbisNgs2ContextBufferInfo*
 
     StackBufferClose(&stackBuffer, &requiredBufferSize);
 
-    // Copy buffer results
-    setupResult.bufferInfo = *hostBufferInfo;
-    setupResult.hostFree = hostFree;
-    // TODO
-    // setupResult.systemList = systemList;
-
-    OrbisNgs2Handle systemHandle = setupResult.systemHandle;
     if (hostBufferInfo->hostBufferSize >= requiredBufferSize) {
-        *outHandle = systemHandle;
+        // The renderer lives on the host, the guest buffer only reserves the expected space.
+        auto system = std::make_shared<Ngs2System>(option, *hostBufferInfo, hostFree);
+        *outHandle = system->Handle();
+        RegisterSystem(std::move(system));
         return ORBIS_OK;
     }
 
-    SystemCleanup(systemHandle, 0);
-
     LOG_ERROR(Lib_Ngs2, "Invalid system buffer size ({}<{}[byte])", hostBufferInfo->hostBufferSize,
               requiredBufferSize);
     return ORBIS_NGS2_ERROR_INVALID_BUFFER_SIZE;
@@ -3,6 +3,15 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
 #include "core/libraries/kernel/threads/pthread.h"
 
 namespace Libraries::Ngs2 {
@@ -170,6 +179,296 @@ s32 StackBufferOpen(StackBuffer* stackBuffer, void* buffer, size_t bufferSize, v
 s32 SystemSetupCore(StackBuffer* stackBuffer, const OrbisNgs2SystemOption* option,
                     SystemInternal* outSystem);
 
+struct OrbisNgs2EnvelopePoint;
+struct OrbisNgs2VoiceParamHeader;
+struct OrbisNgs2RenderBufferInfo;
+struct OrbisNgs2RackOption;
+enum class OrbisNgs2HandleType : u32;
+
+/// dst[i] += src[i] * gain
+void MixScaled(float* dst, const float* src, float gain, u32 num_samples);
+/// dst[i] += src[i] * gain, with the gain moving linearly from `from` towards `to`.
+void MixRamp(float* dst, const float* src, float from, float to, u32 num_samples);
+/// data[i] *= gain, with the gain moving linearly from `from` towards `to`.
+void ScaleRamp(float* data, float from, float to, u32 num_samples);
+
+/// Piecewise linear volume envelope shared by sampler and submixer voices.
+class Ngs2Envelope {
+public:
+    struct Point {
+        u32 duration_us;
+        float height;
+    };
+
+    /// Takes the guest point list, forward points followed by release points.
+    void SetPoints(const OrbisNgs2EnvelopePoint* points, u32 num_forward, u32 num_release);
+    void Start();
+    void Release();
+
+    /// Advances the envelope by `num_samples` and returns the gain reached at the end.
+    float Advance(u32 num_samples, u32 sample_rate);
+
+    float Height() const {
+        return height;
+    }
+
+    bool HasRelease() const {
+        return !release_points.empty();
+    }
+
+    /// True once the release section has run to its end.
+    bool IsFinished() const {
+        return released && point_index >= release_points.size();
+    }
+
+private:
+    std::vector<Point> forward_points;
+    std::vector<Point> release_points;
+    bool released = false;
+    size_t point_index = 0;
+    double elapsed_us = 0.0;
+    float segment_start = 1.0f;
+    float height = 1.0f;
+};
+
+class Ngs2Rack;
+class Ngs2System;
+
+class Ngs2Voice {
+public:
+    struct Port {
+        s32 matrix_id = -1;
+        float volume = 1.0f;
+        u32 num_delay_samples = 0;
+        u32 dest_input_id = 0;
+        Ngs2Voice* dest = nullptr;
+    };
+
+    struct Matrix {
+        u32 num_levels = 0;
+        std::array<float, 64> levels{};
+    };
+
+    Ngs2Voice(Ngs2Rack& rack, u32 index);
+    virtual ~Ngs2Voice();
+
+    /// Applies a linked list of voice parameters.
+    s32 Control(const OrbisNgs2VoiceParamHeader* param_list);
+
+    /// Clears the input mix and prepares the output for a new grain.
+    void BeginGrain(u32 num_samples);
+
+    /// Renders one grain of output. Sources ignore their input and may run on worker threads.
+    virtual void Process(u32 num_samples) = 0;
+
+    /// Runs guest callbacks queued during Process, must be called on the rendering guest thread.
+    virtual void FlushCallbacks() {}
+
+    /// Render buffer this voice writes to, if any.
+    virtual std::optional<u32> OutputIndex() const {
+        return std::nullopt;
+    }
+
+    /// Writes the rack specific voice state, starting with OrbisNgs2VoiceState.
+    virtual void GetState(void* out_state, size_t state_size) const;
+
+    /// Mixes this voice's output into the inputs of the voices patched to its ports.
+    void Route(u32 num_samples);
+
+    /// Detaches every port patched to `voice`.
+    void Unpatch(const Ngs2Voice* voice);
+
+    /// Whether the output of this voice flows into `voice`, directly or through other voices.
+    bool Reaches(const Ngs2Voice* voice) const;
+
+    bool IsActive() const;
+
+    OrbisNgs2Handle Handle() const {
+        return reinterpret_cast<OrbisNgs2Handle>(this);
+    }
+
+    Ngs2Rack& rack;
+    u32 index;
+    u32 state_flags;
+    u32 num_output_channels = 1;
+    u32 num_input_channels = 0;
+    std::vector<Port> ports;
+    std::vector<Matrix> matrices;
+
+    /// Planar channel buffers, each holding max grain samples.
+    std::vector<float> output;
+    std::vector<float> input;
+
+    float* OutputChannel(u32 channel) {
+        return output.data() + channel * max_grain_samples;
+    }
+    float* InputChannel(u32 channel) {
+        return input.data() + channel * max_grain_samples;
+    }
+
+protected:
+    virtual s32 ControlParam(const OrbisNgs2VoiceParamHeader* param);
+    virtual s32 HandleEvent(u32 event_id);
+
+    void SetChannels(u32 num_inputs, u32 num_outputs);
+    void RunCallback(u32 flag, uintptr_t user_data, const void* data, u32 data_size,
+                     u32 repeated_count);
+
+    u32 max_grain_samples;
+    uintptr_t callback_handler = 0;
+    uintptr_t callback_data = 0;
+    u32 callback_flags = 0;
+};
+
+class Ngs2Rack {
+public:
+    Ngs2Rack(Ngs2System& system, u32 rack_id, const OrbisNgs2RackOption* option,
+             const OrbisNgs2ContextBufferInfo& buffer_info);
+    virtual ~Ngs2Rack();
+
+    /// Creates the rack's voices, called once the derived rack is constructed.
+    void CreateVoices();
+
+    /// Sources are stage 0 and mastering stage 2, everything else mixes in stage 1. Voices may
+    /// only patch into voices of the same or a later stage, sources take no input.
+    u32 Stage() const;
+
+    OrbisNgs2Handle Handle() const {
+        return reinterpret_cast<OrbisNgs2Handle>(this);
+    }
+
+    Ngs2System& system;
+    u32 rack_id;
+    u32 uid;
+    std::string name;
+    OrbisNgs2ContextBufferInfo buffer_info;
+    OrbisNgs2BufferFreeHandler host_free = nullptr;
+    uintptr_t user_data = 0;
+    u32 max_voices;
+    u32 max_ports;
+    u32 max_matrices;
+    u32 max_grain_samples;
+    std::vector<std::unique_ptr<Ngs2Voice>> voices;
+
+    u64 render_count = 0;
+    u64 last_process_tick = 0;
+    float last_process_ratio = 0.0f;
+    std::chrono::steady_clock::duration process_time{};
+
+protected:
+    virtual std::unique_ptr<Ngs2Voice> CreateVoice(u32 index) = 0;
+};
+
+class Ngs2System : public std::enable_shared_from_this<Ngs2System> {
+public:
+    Ngs2System(const OrbisNgs2SystemOption* option, const OrbisNgs2ContextBufferInfo& buffer_info,
+               OrbisNgs2BufferFreeHandler host_free);
+    ~Ngs2System();
+
+    s32 Render(const OrbisNgs2RenderBufferInfo* buffers, u32 num_buffers);
+
+    /// Fails once the system is being destroyed.
+    bool AddRack(std::unique_ptr<Ngs2Rack> rack);
+    void DestroyRack(Ngs2Rack* rack);
+
+    /// Makes the next render sort the voices again, called whenever the patch graph changes.
+    void InvalidateRenderOrder() {
+        is_sorted = false;
+    }
+
+    OrbisNgs2Handle Handle() const {
+        return reinterpret_cast<OrbisNgs2Handle>(this);
+    }
+
+    /// Guards the voice graph. Recursive since the guest may lock the system and then control
+    /// voices from the same thread.
+    std::recursive_mutex mutex;
+
+    std::string name;
+    OrbisNgs2ContextBufferInfo buffer_info;
+    OrbisNgs2BufferFreeHandler host_free;
+    uintptr_t user_data = 0;
+    u32 uid;
+    u32 sample_rate;
+    u32 num_grain_samples;
+    u32 max_grain_samples;
+    std::vector<std::unique_ptr<Ngs2Rack>> racks;
+
+    u64 render_count = 0;
+    u64 last_render_tick = 0;
+    float last_render_ratio = 0.0f;
+
+    /// Set under the mutex when the guest destroys the system, its handles are gone by then.
+    bool is_destroyed = false;
+
+private:
+    void ProcessSources(std::span<Ngs2Voice* const> sources, u32 num_samples);
+
+    /// Orders every voice so each one renders after all voices patched into it.
+    void SortRenderOrder();
+
+    bool is_sorted = true;
+    std::vector<Ngs2Voice*> render_order;
+    std::vector<Ngs2Voice*> active_sources;
+    std::vector<float> mix_buffer;
+    std::chrono::steady_clock::duration render_time_total{};
+};
+
+/// Size of the guest buffer a rack asks for, the host keeps its own state so this is nominal.
+size_t RackQueryBufferSize(u32 rack_id, const OrbisNgs2RackOption* option);
+s32 RackCreate(Ngs2System& system, u32 rack_id, const OrbisNgs2RackOption* option,
+               const OrbisNgs2ContextBufferInfo& buffer_info, Ngs2Rack** out_rack);
+
+/// Handles given to the guest are host object addresses, validated against this registry.
+/// The registry owns the systems, rack and voice handles refer to their system weakly and are
+/// only unregistered with it locked.
+void RegisterSystem(std::shared_ptr<Ngs2System> system);
+/// Drops every handle of the system and returns the registry's reference to it.
+std::shared_ptr<Ngs2System> UnregisterSystem(Ngs2System& system);
+void RegisterHandle(OrbisNgs2Handle handle, OrbisNgs2HandleType type, Ngs2System& owner);
+void UnregisterHandle(OrbisNgs2Handle handle);
+/// System owning a live handle of the given type, nullptr for anything else.
+std::shared_ptr<Ngs2System> HandleOwner(OrbisNgs2Handle handle, OrbisNgs2HandleType type);
+std::vector<OrbisNgs2Handle> EnumHandles(OrbisNgs2HandleType type);
+
+/// Resolves a rack or voice handle and keeps its system locked while the guard lives, so the
+/// object can't be destroyed by another thread in the meantime.
+template <typename T>
+class LockedHandle {
+public:
+    LockedHandle(OrbisNgs2Handle handle, OrbisNgs2HandleType type)
+        : system{HandleOwner(handle, type)} {
+        if (!system) {
+            return;
+        }
+        lock = std::unique_lock{system->mutex};
+        // The object may have been destroyed while waiting for the lock.
+        if (HandleOwner(handle, type) != system) {
+            lock.unlock();
+            return;
+        }
+        object = reinterpret_cast<T*>(handle);
+    }
+
+    explicit operator bool() const {
+        return object != nullptr;
+    }
+
+    T* operator->() const {
+        return object;
+    }
+
+    T* get() const {
+        return object;
+    }
+
+private:
+    /// Declared before the lock so the mutex is released before the system can be freed.
+    std::shared_ptr<Ngs2System> system;
+    std::unique_lock<std::recursive_mutex> lock;
+    T* object = nullptr;
+};
+
 s32 HandleReportInvalid(OrbisNgs2Handle handle, u32 handleType);
 void* MemoryClear(void* buffer, size_t size);
 s32 SystemCleanup(OrbisNgs2Handle systemHandle, OrbisNgs2ContextBufferInfo* outInfo);
@@ -1,12 +1,124 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cmath>
+
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_mastering.h"
 
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
 
 using namespace Libraries::Kernel;
 
-namespace Libraries::Ngs2 {} // namespace Libraries::Ngs2
+namespace Libraries::Ngs2 {
+
+// Time for the limiter to recover most of its gain reduction.
+static constexpr float LimiterReleaseSeconds = 0.05f;
+
+Ngs2MasteringVoice::Ngs2MasteringVoice(Ngs2Rack& rack, u32 index) : Ngs2Voice(rack, index) {
+    SetChannels(2, 2);
+}
+
+void Ngs2MasteringVoice::Limit(u32 num_samples) {
+    const float release =
+        1.0f - std::exp(-1.0f / (LimiterReleaseSeconds * rack.system.sample_rate));
+    for (u32 i = 0; i < num_samples; ++i) {
+        float peak = 0.0f;
+        for (u32 channel = 0; channel < num_output_channels; ++channel) {
+            peak = std::max(peak, std::abs(OutputChannel(channel)[i]));
+        }
+        limiter_peak = std::max(limiter_peak, peak);
+        // Clamp instantly on overshoot, then ease back towards unity.
+        const float wanted = peak > limiter_threshold ? limiter_threshold / peak : 1.0f;
+        limiter_gain = wanted < limiter_gain ? wanted : limiter_gain + (1.0f - limiter_gain) * release;
+        for (u32 channel = 0; channel < num_output_channels; ++channel) {
+            OutputChannel(channel)[i] *= limiter_gain;
+        }
+    }
+}
+
+void Ngs2MasteringVoice::Process(u32 num_samples) {
+    for (u32 channel = 0; channel < num_output_channels; ++channel) {
+        const float* in = InputChannel(channel);
+        float* out = OutputChannel(channel);
+        float peak = 0.0f;
+        for (u32 i = 0; i < num_samples; ++i) {
+            peak = std::max(peak, std::abs(in[i]));
+        }
+        input_peaks[channel] = peak;
+        std::copy_n(in, num_samples, out);
+        ScaleRamp(out, gain, target_gain, num_samples);
+    }
+    gain = target_gain;
+
+    limiter_peak = 0.0f;
+    if (limiter_enabled) {
+        Limit(num_samples);
+    }
+
+    for (u32 channel = 0; channel < num_output_channels; ++channel) {
+        const float* out = OutputChannel(channel);
+        float peak = 0.0f;
+        for (u32 i = 0; i < num_samples; ++i) {
+            peak = std::max(peak, std::abs(out[i]));
+        }
+        output_peaks[channel] = peak;
+    }
+}
+
+s32 Ngs2MasteringVoice::ControlParam(const OrbisNgs2VoiceParamHeader* param) {
+    switch (param->id) {
+    case ORBIS_NGS2_MASTERING_VOICE_PARAM_SETUP: {
+        const auto* setup = reinterpret_cast<const OrbisNgs2MasteringVoiceSetupParam*>(param);
+        if (setup->numInputChannels == 0 ||
+            setup->numInputChannels > ORBIS_NGS2_MAX_VOICE_CHANNELS) {
+            return ORBIS_NGS2_ERROR_INVALID_NUM_CHANNELS;
+        }
+        SetChannels(setup->numInputChannels, setup->numInputChannels);
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_MASTERING_VOICE_PARAM_LIMITER: {
+        const auto* limiter = reinterpret_cast<const OrbisNgs2MasteringVoiceLimiterParam*>(param);
+        limiter_enabled = limiter->enableFlag != 0;
+        limiter_threshold = limiter->threshold > 0.0f ? limiter->threshold : 1.0f;
+        limiter_gain = 1.0f;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_MASTERING_VOICE_PARAM_GAIN: {
+        const auto* param_gain = reinterpret_cast<const OrbisNgs2MasteringVoiceGainParam*>(param);
+        target_gain = param_gain->fbwLevel;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_MASTERING_VOICE_PARAM_OUTPUT: {
+        const auto* output_param =
+            reinterpret_cast<const OrbisNgs2MasteringVoiceOutputParam*>(param);
+        output_id = output_param->outputId;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_MASTERING_VOICE_PARAM_MATRIX:
+    case ORBIS_NGS2_MASTERING_VOICE_PARAM_LFE:
+    case ORBIS_NGS2_MASTERING_VOICE_PARAM_PEAK_METER:
+        LOG_DEBUG(Lib_Ngs2, "Ignoring mastering voice param {:#x}", param->id);
+        return ORBIS_OK;
+    default:
+        return Ngs2Voice::ControlParam(param);
+    }
+}
+
+void Ngs2MasteringVoice::GetState(void* out_state, size_t state_size) const {
+    if (state_size < sizeof(OrbisNgs2MasteringVoiceState)) {
+        Ngs2Voice::GetState(out_state, state_size);
+        return;
+    }
+    auto* state = static_cast<OrbisNgs2MasteringVoiceState*>(out_state);
+    state->voiceState.stateFlags = state_flags;
+    state->limiterPeakLevel = limiter_peak;
+    state->limiterPressLevel = 1.0f - limiter_gain;
+    std::ranges::copy(input_peaks, state->aInputPeakHeight);
+    std::ranges::copy(output_peaks, state->aOutputPeakHeight);
+}
+
+} // namespace Libraries::Ngs2
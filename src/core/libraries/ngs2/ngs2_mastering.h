@@ -4,10 +4,17 @@
 #pragma once
 
 #include "ngs2.h"
+#include "ngs2_impl.h"
 
 namespace Libraries::Ngs2 {
 
-class Ngs2Mastering;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_SETUP = 0x30000001;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_MATRIX = 0x30000002;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_LFE = 0x30000003;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_LIMITER = 0x30000004;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_GAIN = 0x30000005;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_OUTPUT = 0x30000006;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_PEAK_METER = 0x30000007;
 
 struct OrbisNgs2MasteringRackOption {
     OrbisNgs2RackOption rackOption;
@@ -78,4 +85,42 @@ struct OrbisNgs2MasteringRackInfo {
     u32 reserved;
 };
 
+/// Final stage voice applying gain and a peak limiter before writing to a render buffer.
+class Ngs2MasteringVoice : public Ngs2Voice {
+public:
+    Ngs2MasteringVoice(Ngs2Rack& rack, u32 index);
+
+    void Process(u32 num_samples) override;
+    std::optional<u32> OutputIndex() const override {
+        return output_id;
+    }
+    void GetState(void* out_state, size_t state_size) const override;
+
+protected:
+    s32 ControlParam(const OrbisNgs2VoiceParamHeader* param) override;
+
+private:
+    void Limit(u32 num_samples);
+
+    u32 output_id = 0;
+    float gain = 1.0f;
+    float target_gain = 1.0f;
+    bool limiter_enabled = false;
+    float limiter_threshold = 1.0f;
+    float limiter_gain = 1.0f;
+    float limiter_peak = 0.0f;
+    std::array<float, ORBIS_NGS2_MAX_VOICE_CHANNELS> input_peaks{};
+    std::array<float, ORBIS_NGS2_MAX_VOICE_CHANNELS> output_peaks{};
+};
+
+class Ngs2Mastering : public Ngs2Rack {
+public:
+    using Ngs2Rack::Ngs2Rack;
+
+protected:
+    std::unique_ptr<Ngs2Voice> CreateVoice(u32 index) override {
+        return std::make_unique<Ngs2MasteringVoice>(*this, index);
+    }
+};
+
 } // namespace Libraries::Ngs2
@@ -1,12 +1,409 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_sampler.h"
 
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
+#include "core/libraries/libs.h"
 
 using namespace Libraries::Kernel;
 
-namespace Libraries::Ngs2 {} // namespace Libraries::Ngs2
+namespace Libraries::Ngs2 {
+
+// PS-ADPCM frames hold 28 samples in 16 bytes.
+static constexpr u32 VagFrameSize = 16;
+static constexpr u32 VagFrameSamples = 28;
+
+static constexpr std::array<std::array<float, 2>, 5> VagCoefficients = {{
+    {0.0f, 0.0f},
+    {60.0f / 64.0f, 0.0f},
+    {115.0f / 64.0f, -52.0f / 64.0f},
+    {98.0f / 64.0f, -55.0f / 64.0f},
+    {122.0f / 64.0f, -60.0f / 64.0f},
+}};
+
+template <typename T, bool BigEndian>
+static T ReadSample(const u8* src) {
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    if constexpr (BigEndian && sizeof(T) > 1) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+template <bool BigEndian>
+static s32 ReadS24(const u8* src) {
+    const u32 value = BigEndian ? (u32(src[0]) << 16) | (u32(src[1]) << 8) | src[2]
+                                : (u32(src[2]) << 16) | (u32(src[1]) << 8) | src[0];
+    return static_cast<s32>(value << 8) >> 8;
+}
+
+static void DecodeVag(const u8* src, u32 size, u32 num_channels, std::vector<float>& out) {
+    // Multi-channel data interleaves whole frames, one per channel.
+    const u32 num_frames = size / (VagFrameSize * num_channels);
+    out.resize(num_frames * VagFrameSamples * num_channels);
+    for (u32 channel = 0; channel < num_channels; ++channel) {
+        float history[2]{};
+        for (u32 frame = 0; frame < num_frames; ++frame) {
+            const u8* header = src + (frame * num_channels + channel) * VagFrameSize;
+            const u32 shift = header[0] & 0xf;
+            const auto& coeffs = VagCoefficients[std::min<u32>(header[0] >> 4, 4)];
+            for (u32 i = 0; i < VagFrameSamples; ++i) {
+                const u8 byte = header[2 + i / 2];
+                const s32 nibble = static_cast<s8>((i & 1 ? byte >> 4 : byte & 0xf) << 4) >> 4;
+                const float sample = static_cast<float>((nibble << 12) >> shift) +
+                                     history[0] * coeffs[0] + history[1] * coeffs[1];
+                history[1] = history[0];
+                history[0] = sample;
+                out[((frame * VagFrameSamples) + i) * num_channels + channel] =
+                    std::clamp(sample, -32768.0f, 32767.0f) / 32768.0f;
+            }
+        }
+    }
+}
+
+template <typename F>
+static void DecodePcm(const u8* src, u32 size, u32 sample_size, std::vector<float>& out,
+                      F&& convert) {
+    const u32 num_samples = size / sample_size;
+    out.resize(num_samples);
+    for (u32 i = 0; i < num_samples; ++i) {
+        out[i] = convert(src + i * sample_size);
+    }
+}
+
+/// Decodes a waveform block to interleaved floats, returns false for unsupported formats.
+static bool DecodeBlock(u32 waveform_type, u32 num_channels, const u8* src, u32 size,
+                        std::vector<float>& out) {
+    switch (waveform_type) {
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_U8:
+        DecodePcm(src, size, 1, out, [](const u8* s) { return (s[0] - 128) / 128.0f; });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_I16L:
+        DecodePcm(src, size, 2, out,
+                  [](const u8* s) { return ReadSample<s16, false>(s) / 32768.0f; });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_I16B:
+        DecodePcm(src, size, 2, out,
+                  [](const u8* s) { return ReadSample<s16, true>(s) / 32768.0f; });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_I24L:
+        DecodePcm(src, size, 3, out, [](const u8* s) { return ReadS24<false>(s) / 8388608.0f; });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_I24B:
+        DecodePcm(src, size, 3, out, [](const u8* s) { return ReadS24<true>(s) / 8388608.0f; });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_I32L:
+        DecodePcm(src, size, 4, out,
+                  [](const u8* s) { return ReadSample<s32, false>(s) / 2147483648.0f; });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_I32B:
+        DecodePcm(src, size, 4, out,
+                  [](const u8* s) { return ReadSample<s32, true>(s) / 2147483648.0f; });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_F32L:
+        DecodePcm(src, size, 4, out, [](const u8* s) {
+            return std::bit_cast<float>(ReadSample<u32, false>(s));
+        });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_PCM_F32B:
+        DecodePcm(src, size, 4, out,
+                  [](const u8* s) { return std::bit_cast<float>(ReadSample<u32, true>(s)); });
+        return true;
+    case ORBIS_NGS2_WAVEFORM_TYPE_VAG:
+        DecodeVag(src, size, num_channels, out);
+        return true;
+    default:
+        return false;
+    }
+}
+
+void Ngs2SamplerVoice::Reset() {
+    blocks.clear();
+    pending_callbacks.clear();
+    decoded_valid = false;
+    position = 0.0;
+    exit_loop = false;
+    starved = false;
+}
+
+bool Ngs2SamplerVoice::PrepareBlock() {
+    while (!decoded_valid) {
+        if (blocks.empty()) {
+            return false;
+        }
+        const Block& block = blocks.front();
+        const u32 num_channels = std::max(format.numChannels, 1u);
+        if (!DecodeBlock(format.waveformType, num_channels, block.data, block.info.dataSize,
+                         decoded)) {
+            LOG_ERROR(Lib_Ngs2, "Unsupported waveform type {:#x}, playing silence",
+                      format.waveformType);
+            decoded.assign(block.info.numSamples * num_channels, 0.0f);
+        }
+        const u32 total_frames = static_cast<u32>(decoded.size() / num_channels);
+        const u32 skip = std::min(block.info.numSkipSamples, total_frames);
+        decoded_frames = total_frames - skip;
+        if (block.info.numSamples != 0) {
+            decoded_frames = std::min(decoded_frames, block.info.numSamples);
+        }
+        if (skip != 0) {
+            decoded.erase(decoded.begin(), decoded.begin() + skip * num_channels);
+        }
+        decoded_valid = true;
+        if (decoded_frames == 0) {
+            FinishBlock();
+        }
+    }
+    return true;
+}
+
+void Ngs2SamplerVoice::FinishBlock() {
+    Block& block = blocks.front();
+    num_decoded_samples += decoded_frames;
+    decoded_data_size += block.info.dataSize;
+    if (!exit_loop && block.repeated_count < block.info.numRepeats) {
+        // Loop the block without decoding it again.
+        ++block.repeated_count;
+        return;
+    }
+    exit_loop = false;
+    last_user_data = block.info.userData;
+    last_waveform_data = block.data;
+    pending_callbacks.push_back(
+        {block.info.userData, block.data, block.info.dataSize, block.repeated_count});
+    blocks.pop_front();
+    decoded_valid = false;
+}
+
+void Ngs2SamplerVoice::Process(u32 num_samples) {
+    const u32 num_channels = num_output_channels;
+    const double step = static_cast<double>(pitch) * format.sampleRate / rack.system.sample_rate;
+    u32 i = 0;
+    while (i < num_samples) {
+        if (step <= 0.0 || !PrepareBlock()) {
+            starved = step > 0.0;
+            for (u32 channel = 0; channel < num_channels; ++channel) {
+                std::fill(OutputChannel(channel) + i, OutputChannel(channel) + num_samples, 0.0f);
+            }
+            break;
+        }
+        if (position >= decoded_frames) {
+            // A frame offset set before the block was queued can point past it, skip the frames
+            // it covers instead of reading beyond the decoded data.
+            position -= decoded_frames;
+            FinishBlock();
+            continue;
+        }
+        const float* data = decoded.data();
+        const u32 last_frame = decoded_frames - 1;
+        if (step == 1.0 && position == static_cast<u32>(position)) {
+            // Common case of matching rates, a plain deinterleave.
+            const u32 frame = static_cast<u32>(position);
+            const u32 count = std::min(num_samples - i, decoded_frames - frame);
+            for (u32 channel = 0; channel < num_channels; ++channel) {
+                float* out = OutputChannel(channel) + i;
+                const float* src = data + frame * num_channels + channel;
+                for (u32 j = 0; j < count; ++j) {
+                    out[j] = src[j * num_channels];
+                }
+            }
+            i += count;
+            position += count;
+        } else {
+            for (; i < num_samples && position < decoded_frames; ++i, position += step) {
+                const u32 frame = static_cast<u32>(position);
+                const float t = static_cast<float>(position - frame);
+                const float* a = data + frame * num_channels;
+                const float* b = data + std::min(frame + 1, last_frame) * num_channels;
+                for (u32 channel = 0; channel < num_channels; ++channel) {
+                    OutputChannel(channel)[i] = a[channel] + (b[channel] - a[channel]) * t;
+                }
+            }
+        }
+        if (position >= decoded_frames) {
+            position -= decoded_frames;
+            FinishBlock();
+        }
+    }
+
+    const float from = envelope.Height();
+    const float to = envelope.Advance(num_samples, rack.system.sample_rate);
+    for (u32 channel = 0; channel < num_channels; ++channel) {
+        ScaleRamp(OutputChannel(channel), from, to, num_samples);
+    }
+}
+
+void Ngs2SamplerVoice::FlushCallbacks() {
+    for (const auto& callback : pending_callbacks) {
+        RunCallback(ORBIS_NGS2_VOICE_CALLBACK_FLAG_WAVEFORM_BLOCK_END, callback.user_data,
+                    callback.data, callback.data_size, callback.repeated_count);
+    }
+    pending_callbacks.clear();
+
+    if (user_fx != nullptr) {
+        std::array<float*, ORBIS_NGS2_MAX_VOICE_CHANNELS> channels{};
+        for (u32 channel = 0; channel < num_output_channels; ++channel) {
+            channels[channel] = OutputChannel(channel);
+        }
+        OrbisNgs2UserFxProcessContext context{};
+        context.aChannelData = channels.data();
+        context.userData0 = user_fx_data[0];
+        context.userData1 = user_fx_data[1];
+        context.userData2 = user_fx_data[2];
+        context.numChannels = num_output_channels;
+        context.numGrainSamples = rack.system.num_grain_samples;
+        context.sampleRate = rack.system.sample_rate;
+        Core::ExecuteGuest(user_fx, &context);
+    }
+
+    // The voice ends once its data ran out and block end callbacks queued nothing new, or once
+    // the release envelope has faded out.
+    if ((starved && blocks.empty()) || envelope.IsFinished()) {
+        state_flags = 0;
+        Reset();
+    }
+    starved = false;
+}
+
+s32 Ngs2SamplerVoice::ControlParam(const OrbisNgs2VoiceParamHeader* param) {
+    switch (param->id) {
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_SETUP: {
+        const auto* setup = reinterpret_cast<const OrbisNgs2SamplerVoiceSetupParam*>(param);
+        if (setup->format.numChannels == 0 ||
+            setup->format.numChannels > ORBIS_NGS2_MAX_VOICE_CHANNELS) {
+            return ORBIS_NGS2_ERROR_INVALID_WAVEFORM_FORMAT;
+        }
+        format = setup->format;
+        SetChannels(0, format.numChannels);
+        Reset();
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_BLOCKS: {
+        const auto* param_blocks =
+            reinterpret_cast<const OrbisNgs2SamplerVoiceWaveformBlocksParam*>(param);
+        if (param_blocks->numBlocks != 0 && param_blocks->aBlock == nullptr) {
+            return ORBIS_NGS2_ERROR_INVALID_WAVEFORM_BLOCK_ADDRESS;
+        }
+        // Streaming voices append blocks while playing, otherwise the queue is replaced.
+        if (!(state_flags & ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING)) {
+            blocks.clear();
+            decoded_valid = false;
+            position = 0.0;
+        }
+        const auto* base = static_cast<const u8*>(param_blocks->data);
+        for (u32 i = 0; i < param_blocks->numBlocks; ++i) {
+            const auto& info = param_blocks->aBlock[i];
+            blocks.push_back({base + info.dataOffset, info, 0});
+        }
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_ADDRESS: {
+        const auto* address =
+            reinterpret_cast<const OrbisNgs2SamplerVoiceWaveformAddressParam*>(param);
+        const auto* from = static_cast<const u8*>(address->from);
+        const auto* to = static_cast<const u8*>(address->to);
+        for (auto& block : blocks) {
+            if (block.data >= from) {
+                block.data = to + (block.data - from);
+            }
+        }
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_FRAME_OFFSET: {
+        const auto* offset =
+            reinterpret_cast<const OrbisNgs2SamplerVoiceWaveformFrameOffsetParam*>(param);
+        // Without a queued block the offset is checked once playback reaches one.
+        if (PrepareBlock() && offset->frameOffset >= decoded_frames) {
+            return ORBIS_NGS2_ERROR_INVALID_WAVEFORM_FRAME;
+        }
+        position = offset->frameOffset;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_EXIT_LOOP:
+        exit_loop = true;
+        return ORBIS_OK;
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_PITCH: {
+        const auto* param_pitch = reinterpret_cast<const OrbisNgs2SamplerVoicePitchParam*>(param);
+        pitch = param_pitch->ratio;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_ENVELOPE: {
+        const auto* param_envelope =
+            reinterpret_cast<const OrbisNgs2SamplerVoiceEnvelopeParam*>(param);
+        if (param_envelope->numForwardPoints + param_envelope->numReleasePoints != 0 &&
+            param_envelope->aPoint == nullptr) {
+            return ORBIS_NGS2_ERROR_INVALID_ENVELOPE_POINT_ADDRESS;
+        }
+        envelope.SetPoints(param_envelope->aPoint, param_envelope->numForwardPoints,
+                           param_envelope->numReleasePoints);
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_USER_FX: {
+        const auto* fx = reinterpret_cast<const OrbisNgs2SamplerVoiceUserFxParam*>(param);
+        user_fx = fx->handler;
+        user_fx_data[0] = fx->userData0;
+        user_fx_data[1] = fx->userData1;
+        user_fx_data[2] = fx->userData2;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_DISTORTION:
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_PEAK_METER:
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_FILTER:
+    case ORBIS_NGS2_SAMPLER_VOICE_PARAM_NUM_FILTERS:
+        LOG_DEBUG(Lib_Ngs2, "Ignoring sampler voice param {:#x}", param->id);
+        return ORBIS_OK;
+    default:
+        return Ngs2Voice::ControlParam(param);
+    }
+}
+
+s32 Ngs2SamplerVoice::HandleEvent(u32 event_id) {
+    switch (event_id) {
+    case ORBIS_NGS2_VOICE_EVENT_PLAY:
+        envelope.Start();
+        for (auto& block : blocks) {
+            block.repeated_count = 0;
+        }
+        break;
+    case ORBIS_NGS2_VOICE_EVENT_STOP:
+        if (envelope.HasRelease() && IsActive()) {
+            // Keep playing until the release section fades the voice out.
+            envelope.Release();
+            return ORBIS_OK;
+        }
+        Reset();
+        break;
+    case ORBIS_NGS2_VOICE_EVENT_STOP_IMM:
+    case ORBIS_NGS2_VOICE_EVENT_KILL:
+        Reset();
+        break;
+    default:
+        break;
+    }
+    return Ngs2Voice::HandleEvent(event_id);
+}
+
+void Ngs2SamplerVoice::GetState(void* out_state, size_t state_size) const {
+    if (state_size < sizeof(OrbisNgs2SamplerVoiceState)) {
+        Ngs2Voice::GetState(out_state, state_size);
+        return;
+    }
+    auto* state = static_cast<OrbisNgs2SamplerVoiceState*>(out_state);
+    state->voiceState.stateFlags = state_flags;
+    state->envelopeHeight = envelope.Height();
+    state->peakHeight = 0.0f;
+    state->numDecodedSamples = num_decoded_samples;
+    state->decodedDataSize = decoded_data_size;
+    state->userData = last_user_data;
+    state->waveformData = last_waveform_data;
+}
+
+} // namespace Libraries::Ngs2
@@ -3,11 +3,25 @@
 
 #pragma once
 
+#include <deque>
+
 #include "ngs2.h"
+#include "ngs2_impl.h"
 
 namespace Libraries::Ngs2 {
 
-class Ngs2Sampler;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_SETUP = 0x10000001;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_BLOCKS = 0x10000002;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_ADDRESS = 0x10000003;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_FRAME_OFFSET = 0x10000004;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_EXIT_LOOP = 0x10000005;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_PITCH = 0x10000006;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_ENVELOPE = 0x10000007;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_DISTORTION = 0x10000008;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_USER_FX = 0x10000009;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_PEAK_METER = 0x1000000A;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_FILTER = 0x1000000B;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_NUM_FILTERS = 0x1000000C;
 
 struct OrbisNgs2SamplerRackOption {
     OrbisNgs2RackOption rackOption;
@@ -159,4 +173,68 @@ struct OrbisNgs2SamplerRackInfo {
     u32 maxAjmAtrac9Decoders;
 };
 
+/// Source voice playing queued waveform blocks with pitch and envelope control.
+class Ngs2SamplerVoice : public Ngs2Voice {
+public:
+    using Ngs2Voice::Ngs2Voice;
+
+    void Process(u32 num_samples) override;
+    void FlushCallbacks() override;
+    void GetState(void* out_state, size_t state_size) const override;
+
+protected:
+    s32 ControlParam(const OrbisNgs2VoiceParamHeader* param) override;
+    s32 HandleEvent(u32 event_id) override;
+
+private:
+    struct Block {
+        const u8* data;
+        OrbisNgs2WaveformBlock info;
+        u32 repeated_count;
+    };
+
+    struct PendingCallback {
+        uintptr_t user_data;
+        const void* data;
+        u32 data_size;
+        u32 repeated_count;
+    };
+
+    /// Decodes the front block if needed, returns false when the queue ran dry.
+    bool PrepareBlock();
+    void FinishBlock();
+    void Reset();
+
+    OrbisNgs2WaveformFormat format{};
+    std::deque<Block> blocks;
+    /// Interleaved samples of the front block, limited to its skip and sample counts.
+    std::vector<float> decoded;
+    bool decoded_valid = false;
+    u32 decoded_frames = 0;
+    double position = 0.0;
+    float pitch = 1.0f;
+    bool exit_loop = false;
+    bool starved = false;
+    Ngs2Envelope envelope;
+    std::vector<PendingCallback> pending_callbacks;
+
+    OrbisNgs2UserFxProcessHandler user_fx = nullptr;
+    uintptr_t user_fx_data[3]{};
+
+    u64 num_decoded_samples = 0;
+    u64 decoded_data_size = 0;
+    uintptr_t last_user_data = 0;
+    const void* last_waveform_data = nullptr;
+};
+
+class Ngs2Sampler : public Ngs2Rack {
+public:
+    using Ngs2Rack::Ngs2Rack;
+
+protected:
+    std::unique_ptr<Ngs2Voice> CreateVoice(u32 index) override {
+        return std::make_unique<Ngs2SamplerVoice>(*this, index);
+    }
+};
+
 } // namespace Libraries::Ngs2
@@ -1,12 +1,90 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_submixer.h"
 
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
 
 using namespace Libraries::Kernel;
 
-namespace Libraries::Ngs2 {} // namespace Libraries::Ngs2
+namespace Libraries::Ngs2 {
+
+Ngs2SubmixerVoice::Ngs2SubmixerVoice(Ngs2Rack& rack, u32 index) : Ngs2Voice(rack, index) {
+    SetChannels(2, 2);
+}
+
+void Ngs2SubmixerVoice::Process(u32 num_samples) {
+    const float from = envelope.Height();
+    const float to = envelope.Advance(num_samples, rack.system.sample_rate);
+    for (u32 channel = 0; channel < num_output_channels; ++channel) {
+        float* out = OutputChannel(channel);
+        std::copy_n(InputChannel(channel), num_samples, out);
+        ScaleRamp(out, from, to, num_samples);
+    }
+    if (envelope.IsFinished()) {
+        state_flags = 0;
+    }
+}
+
+s32 Ngs2SubmixerVoice::ControlParam(const OrbisNgs2VoiceParamHeader* param) {
+    switch (param->id) {
+    case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_SETUP: {
+        const auto* setup = reinterpret_cast<const OrbisNgs2SubmixerVoiceSetupParam*>(param);
+        if (setup->numIoChannels == 0 || setup->numIoChannels > ORBIS_NGS2_MAX_VOICE_CHANNELS) {
+            return ORBIS_NGS2_ERROR_INVALID_NUM_CHANNELS;
+        }
+        SetChannels(setup->numIoChannels, setup->numIoChannels);
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_ENVELOPE: {
+        const auto* param_envelope =
+            reinterpret_cast<const OrbisNgs2SubmixerVoiceEnvelopeParam*>(param);
+        if (param_envelope->numForwardPoints + param_envelope->numReleasePoints != 0 &&
+            param_envelope->aPoint == nullptr) {
+            return ORBIS_NGS2_ERROR_INVALID_ENVELOPE_POINT_ADDRESS;
+        }
+        envelope.SetPoints(param_envelope->aPoint, param_envelope->numForwardPoints,
+                           param_envelope->numReleasePoints);
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_COMPRESSOR:
+    case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_DISTORTION:
+    case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_USER_FX:
+    case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_PEAK_METER:
+    case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_FILTER:
+    case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_NUM_FILTERS:
+        LOG_DEBUG(Lib_Ngs2, "Ignoring submixer voice param {:#x}", param->id);
+        return ORBIS_OK;
+    default:
+        return Ngs2Voice::ControlParam(param);
+    }
+}
+
+s32 Ngs2SubmixerVoice::HandleEvent(u32 event_id) {
+    if (event_id == ORBIS_NGS2_VOICE_EVENT_PLAY) {
+        envelope.Start();
+    } else if (event_id == ORBIS_NGS2_VOICE_EVENT_STOP && envelope.HasRelease() && IsActive()) {
+        envelope.Release();
+        return ORBIS_OK;
+    }
+    return Ngs2Voice::HandleEvent(event_id);
+}
+
+void Ngs2SubmixerVoice::GetState(void* out_state, size_t state_size) const {
+    if (state_size < sizeof(OrbisNgs2SubmixerVoiceState)) {
+        Ngs2Voice::GetState(out_state, state_size);
+        return;
+    }
+    auto* state = static_cast<OrbisNgs2SubmixerVoiceState*>(out_state);
+    state->voiceState.stateFlags = state_flags;
+    state->envelopeHeight = envelope.Height();
+    state->peakHeight = 0.0f;
+    state->compressorHeight = 0.0f;
+}
+
+} // namespace Libraries::Ngs2
@@ -4,10 +4,18 @@
 #pragma once
 
 #include "ngs2.h"
+#include "ngs2_impl.h"
 
 namespace Libraries::Ngs2 {
 
-class Ngs2Submixer;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_SETUP = 0x20000001;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_ENVELOPE = 0x20000002;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_COMPRESSOR = 0x20000003;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_DISTORTION = 0x20000004;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_USER_FX = 0x20000005;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_PEAK_METER = 0x20000006;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_FILTER = 0x20000007;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_NUM_FILTERS = 0x20000008;
 
 struct OrbisNgs2SubmixerRackOption {
     OrbisNgs2RackOption rackOption;
@@ -123,4 +131,31 @@ struct OrbisNgs2SubmixerRackInfo {
     u32 maxInputs;
 };
 
+/// Bus voice mixing its patched inputs through an envelope. Also stands in for the reverb and
+/// equalizer racks, which pass their input through unchanged.
+class Ngs2SubmixerVoice : public Ngs2Voice {
+public:
+    Ngs2SubmixerVoice(Ngs2Rack& rack, u32 index);
+
+    void Process(u32 num_samples) override;
+    void GetState(void* out_state, size_t state_size) const override;
+
+protected:
+    s32 ControlParam(const OrbisNgs2VoiceParamHeader* param) override;
+    s32 HandleEvent(u32 event_id) override;
+
+private:
+    Ngs2Envelope envelope;
+};
+
+class Ngs2Submixer : public Ngs2Rack {
+public:
+    using Ngs2Rack::Ngs2Rack;
+
+protected:
+    std::unique_ptr<Ngs2Voice> CreateVoice(u32 index) override {
+        return std::make_unique<Ngs2SubmixerVoice>(*this, index);
+    }
+};
+
 } // namespace Libraries::Ngs2
@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
+#include "common/config.h"
 #include "common/logging/log.h"
 #include "common/singleton.h"
 #include "core/file_format/playgo_chunk.h"
@@ -15,6 +18,76 @@ namespace Libraries::PlayGo {
 static constexpr OrbisPlayGoHandle PlaygoHandle = 1;
 static std::unique_ptr<PlaygoFile> playgo;
 
+// Install speeds other than Full only get a share of the simulated bandwidth.
+static constexpr u64 TrickleBandwidthDivisor = 4;
+static constexpr s64 SuspendTimeoutMs = 30 * 1000;
+
+static s64 GetTickMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static u64 GetInstallRate() {
+    switch (playgo->speed) {
+    case OrbisPlayGoInstallSpeed::Full:
+        return playgo->install_bandwidth;
+    case OrbisPlayGoInstallSpeed::Trickle:
+        return playgo->install_bandwidth / TrickleBandwidthDivisor;
+    default:
+        return 0;
+    }
+}
+
+static void AdvanceInstall(s64 tick) {
+    if (tick <= playgo->install_tick) {
+        return;
+    }
+    const u64 total = playgo->install_offsets.empty() ? 0 : playgo->install_offsets.back();
+    playgo->installed_size = std::min(
+        total, playgo->installed_size + GetInstallRate() * (tick - playgo->install_tick) / 1000);
+    playgo->install_tick = tick;
+}
+
+/// Brings the simulated install up to date. Must be called with the speed mutex held.
+static void UpdateInstall() {
+    const s64 now = GetTickMs();
+    if (playgo->speed == OrbisPlayGoInstallSpeed::Suspended &&
+        now - playgo->speed_tick > SuspendTimeoutMs) {
+        // A suspended install resumes on its own after a while.
+        AdvanceInstall(playgo->speed_tick + SuspendTimeoutMs);
+        playgo->speed = OrbisPlayGoInstallSpeed::Trickle;
+    }
+    AdvanceInstall(now);
+}
+
+static void StartInstall(u32 kib_per_second) {
+    playgo->install_offsets.resize(playgo->GetChunkCount());
+    u64 offset = 0;
+    for (u32 i = 0; i < playgo->GetChunkCount(); i++) {
+        offset += playgo->GetChunk(i).total_size;
+        playgo->install_offsets[i] = offset;
+    }
+    // The initial chunk is needed to boot, so it is always on disk.
+    playgo->installed_size = playgo->install_offsets.empty() ? 0 : playgo->install_offsets[0];
+    playgo->install_bandwidth = u64(kib_per_second) * 1024;
+    playgo->install_tick = GetTickMs();
+}
+
+/// Bytes of a chunk that are on disk. Must be called with the speed mutex held.
+static u64 GetChunkInstalledSize(OrbisPlayGoChunkId chunk_id) {
+    const u64 total_size = playgo->GetChunk(chunk_id).total_size;
+    if (playgo->install_bandwidth == 0) {
+        return total_size;
+    }
+    const u64 end = playgo->install_offsets[chunk_id];
+    const u64 start = end - total_size;
+    return std::clamp(playgo->installed_size, start, end) - start;
+}
+
+static bool IsChunkInstalled(OrbisPlayGoChunkId chunk_id) {
+    return GetChunkInstalledSize(chunk_id) == playgo->GetChunk(chunk_id).total_size;
+}
+
 s32 PS4_SYSV_ABI sceDbgPlayGoRequestNextChunk() {
     LOG_ERROR(Lib_PlayGo, "(STUBBED)called");
     return ORBIS_OK;
@@ -57,12 +130,12 @@ s32 PS4_SYSV_ABI scePlayGoGetChunkId(OrbisPlayGoHandle handle, OrbisPlayGoChunkI
     }
 
     if (outChunkIdList == nullptr) {
-        *outEntries = playgo->chunks.size();
+        *outEntries = playgo->GetChunkCount();
         return ORBIS_OK;
     }
 
-    if (numberOfEntries > playgo->chunks.size()) {
-        numberOfEntries = playgo->chunks.size();
+    if (numberOfEntries > playgo->GetChunkCount()) {
+        numberOfEntries = playgo->GetChunkCount();
     }
 
     for (u32 i = 0; i < numberOfEntries; i++) {
@@ -84,8 +157,31 @@ s32 PS4_SYSV_ABI scePlayGoGetEta(OrbisPlayGoHandle handle, const OrbisPlayGoChun
     if (numberOfEntries == 0) {
         return ORBIS_PLAYGO_ERROR_BAD_SIZE;
     }
+    if (!playgo) {
+        return ORBIS_PLAYGO_ERROR_NOT_INITIALIZED;
+    }
 
-    *outEta = 0; // all is loaded
+    std::scoped_lock lk{playgo->GetSpeedMutex()};
+    if (playgo->install_bandwidth == 0) {
+        *outEta = 0; // all is loaded
+        return ORBIS_OK;
+    }
+
+    UpdateInstall();
+    u64 install_end = 0;
+    for (u32 i = 0; i < numberOfEntries; i++) {
+        if (chunkIds[i] >= playgo->GetChunkCount()) {
+            return ORBIS_PLAYGO_ERROR_BAD_CHUNK_ID;
+        }
+        install_end = std::max(install_end, playgo->install_offsets[chunkIds[i]]);
+    }
+    if (install_end <= playgo->installed_size) {
+        *outEta = 0;
+        return ORBIS_OK;
+    }
+    const u64 rate = GetInstallRate();
+    *outEta = rate == 0 ? -1 : static_cast<OrbisPlayGoEta>(
+                                   (install_end - playgo->installed_size + rate - 1) / rate);
     return ORBIS_OK;
 }
 
@@ -104,14 +200,7 @@ s32 PS4_SYSV_ABI scePlayGoGetInstallSpeed(OrbisPlayGoHandle handle,
     }
 
     std::scoped_lock lk{playgo->GetSpeedMutex()};
-
-    if (playgo->speed == OrbisPlayGoInstallSpeed::Suspended) {
-        using namespace std::chrono;
-        if ((duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count() -
-             playgo->speed_tick) > 30 * 1000) { // 30sec
-            playgo->speed = OrbisPlayGoInstallSpeed::Trickle;
-        }
-    }
+    UpdateInstall();
     *outSpeed = playgo->speed;
 
     return ORBIS_OK;
@@ -157,9 +246,12 @@ s32 PS4_SYSV_ABI scePlayGoGetLocus(OrbisPlayGoHandle handle, const OrbisPlayGoCh
         return ORBIS_PLAYGO_ERROR_NOT_SUPPORT_PLAYGO;
     }
 
+    std::scoped_lock lk{playgo->GetSpeedMutex()};
+    UpdateInstall();
     for (int i = 0; i < numberOfEntries; i++) {
-        if (chunkIds[i] < playgo->chunks.size()) {
-            outLoci[i] = OrbisPlayGoLocus::LocalFast;
+        if (chunkIds[i] < playgo->GetChunkCount()) {
+            outLoci[i] = IsChunkInstalled(chunkIds[i]) ? OrbisPlayGoLocus::LocalFast
+                                                        : OrbisPlayGoLocus::NotDownloaded;
         } else {
             outLoci[i] = OrbisPlayGoLocus::NotDownloaded;
             return ORBIS_PLAYGO_ERROR_BAD_CHUNK_ID;
@@ -192,17 +284,21 @@ s32 PS4_SYSV_ABI scePlayGoGetProgress(OrbisPlayGoHandle handle, const OrbisPlayG
     outProgress->progressSize = 0;
     outProgress->totalSize = 0;
 
+    std::scoped_lock lk{playgo->GetSpeedMutex()};
+    UpdateInstall();
+    u64 progress_size = 0;
     u64 total_size = 0;
     for (u32 i = 0; i < numberOfEntries; i++) {
         u32 chunk_id = chunkIds[i];
-        if (chunk_id < playgo->chunks.size()) {
-            total_size += playgo->chunks[chunk_id].total_size;
+        if (chunk_id < playgo->GetChunkCount()) {
+            progress_size += GetChunkInstalledSize(chunk_id);
+            total_size += playgo->GetChunk(chunk_id).total_size;
         } else {
             return ORBIS_PLAYGO_ERROR_BAD_CHUNK_ID;
         }
     }
 
-    outProgress->progressSize = total_size;
+    outProgress->progressSize = progress_size;
     outProgress->totalSize = total_size;
 
     return ORBIS_OK;
@@ -224,7 +320,19 @@ s32 PS4_SYSV_ABI scePlayGoGetToDoList(OrbisPlayGoHandle handle, OrbisPlayGoToDo*
     if (!playgo) {
         return ORBIS_PLAYGO_ERROR_NOT_INITIALIZED;
     }
-    *outEntries = 0; // nothing to do
+
+    std::scoped_lock lk{playgo->GetSpeedMutex()};
+    UpdateInstall();
+    u32 count = 0;
+    for (const auto& todo : playgo->todo_list) {
+        if (count == numberOfEntries) {
+            break;
+        }
+        if (todo.locus != OrbisPlayGoLocus::NotDownloaded && !IsChunkInstalled(todo.chunkId)) {
+            outTodoList[count++] = todo;
+        }
+    }
+    *outEntries = count;
     return ORBIS_OK;
 }
 
@@ -256,6 +364,9 @@ s32 PS4_SYSV_ABI scePlayGoInitialize(OrbisPlayGoInitParams* param) {
     const auto file_path = mnt->GetHostPath("/app0/sce_sys/playgo-chunk.dat");
     if (!playgo->Open(file_path)) {
         LOG_WARNING(Lib_PlayGo, "Could not open PlayGo file");
+    } else if (const u32 bandwidth = Config::getPlayGoInstallBandwidth(); bandwidth != 0) {
+        LOG_INFO(Lib_PlayGo, "Simulating a streaming install at {} KiB/s", bandwidth);
+        StartInstall(bandwidth);
     }
 
     s32 system_lang = 0;
@@ -333,10 +444,9 @@ s32 PS4_SYSV_ABI scePlayGoSetInstallSpeed(OrbisPlayGoHandle handle, OrbisPlayGoI
     }
 
     std::scoped_lock lk{playgo->GetSpeedMutex()};
-    using namespace std::chrono;
+    UpdateInstall();
     playgo->speed = speed;
-    playgo->speed_tick =
-        duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+    playgo->speed_tick = GetTickMs();
 
     return ORBIS_OK;
 }
@@ -372,6 +482,14 @@ s32 PS4_SYSV_ABI scePlayGoSetToDoList(OrbisPlayGoHandle handle, const OrbisPlayG
     if (!playgo) {
         return ORBIS_PLAYGO_ERROR_NOT_INITIALIZED;
     }
+    for (u32 i = 0; i < numberOfEntries; i++) {
+        if (todoList[i].chunkId >= playgo->GetChunkCount()) {
+            return ORBIS_PLAYGO_ERROR_BAD_CHUNK_ID;
+        }
+    }
+
+    std::scoped_lock lk{playgo->GetSpeedMutex()};
+    playgo->todo_list.assign(todoList, todoList + numberOfEntries);
     return ORBIS_OK;
 }
 
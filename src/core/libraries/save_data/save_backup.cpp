@@ -36,6 +36,28 @@ static std::deque<BackupRequest> g_result_queue;
 static std::atomic_int g_backup_progress = 0;
 static std::atomic g_backup_status = WorkerStatus::NotStarted;
 
+// Files that did not change since the previous backup are hard linked from it instead of being
+// copied again. Falls back to a copy where links are not supported.
+static void CopyIncremental(const fs::path& src, const fs::path& dst, const fs::path& prev) {
+    if (fs::is_directory(src)) {
+        fs::create_directory(dst);
+        for (const auto& entry : fs::directory_iterator(src)) {
+            const auto filename = entry.path().filename();
+            CopyIncremental(entry.path(), dst / filename, prev / filename);
+        }
+        return;
+    }
+    std::error_code ec;
+    if (fs::is_regular_file(prev, ec) && fs::file_size(prev, ec) == fs::file_size(src) &&
+        fs::last_write_time(src) < fs::last_write_time(prev, ec) && !ec) {
+        fs::create_hard_link(prev, dst, ec);
+        if (!ec) {
+            return;
+        }
+    }
+    fs::copy(src, dst, fs::copy_options::recursive);
+}
+
 static void backup(const std::filesystem::path& dir_name) {
     std::unique_lock lk{g_backup_running_mutex};
     if (!fs::exists(dir_name)) {
@@ -64,7 +86,7 @@ static void backup(const std::filesystem::path& dir_name) {
 
     fs::create_directory(backup_dir_tmp);
     for (const auto& file : backup_files) {
-        fs::copy(file, backup_dir_tmp / file.filename(), fs::copy_options::recursive);
+        CopyIncremental(file, backup_dir_tmp / file.filename(), backup_dir / file.filename());
         current_count++;
         g_backup_progress = current_count * 100 / total_count;
     }
@@ -6,14 +6,20 @@
 #include <condition_variable>
 #include <filesystem>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <thread>
 #include <utility>
+#include <vector>
 #include <fmt/format.h>
 
+#include <boost/icl/interval_set.hpp>
 #include "boost/icl/concept/interval.hpp"
+#include "common/config.h"
 #include "common/elf_info.h"
 #include "common/logging/log.h"
 #include "common/path_util.h"
+#include "common/polyfill_thread.h"
 #include "common/singleton.h"
 #include "common/thread.h"
 #include "core/file_sys/fs.h"
@@ -40,30 +46,72 @@ struct SlotData {
     PSF sfo;
     std::vector<u8> memory_cache;
     size_t memory_cache_size{};
+    boost::icl::interval_set<u64> dirty_ranges; ///< Written by the guest, not yet on disk
+    u64 bytes_requested{};
+    u64 bytes_written{};
 };
 
 static std::mutex g_slot_mtx;
+static std::mutex g_flush_io_mtx;
 static std::unordered_map<u32, SlotData> g_attached_slots;
 
-void PersistMemory(u32 slot_id, bool lock) {
-    std::unique_lock lck{g_slot_mtx, std::defer_lock};
-    if (lock) {
-        lck.lock();
+static std::jthread g_flush_thread;
+static std::condition_variable_any g_flush_cv;
+static bool g_flush_pending{};
+
+static void LoadMemory(SlotData& data) {
+    auto& memory = data.memory_cache;
+    if (!memory.empty()) {
+        return;
     }
-    auto& data = g_attached_slots[slot_id];
-    auto memoryPath = data.folder_path / FilenameSaveDataMemory;
+    memory.resize(data.memory_cache_size);
+    IOFile f{data.folder_path / FilenameSaveDataMemory, Common::FS::FileAccessMode::Read};
+    if (f.IsOpen()) {
+        f.Seek(0);
+        f.ReadSpan(std::span{memory});
+    }
+}
+
+/// Copy of the dirty part of a slot, so memory.dat can be written without holding g_slot_mtx.
+struct FlushRequest {
+    u32 slot_id;
+    OrbisUserServiceUserId user_id;
+    std::string game_serial;
+    std::filesystem::path folder_path;
+    std::vector<u8> memory;
+    boost::icl::interval_set<u64> dirty_ranges;
+};
+
+// Writes the dirty ranges back to memory.dat, or the whole memory if the file is missing.
+// Returns the number of bytes written, `error` is set if it failed.
+static u64 WriteMemoryFile(const FlushRequest& request, std::string& error) {
+    auto memoryPath = request.folder_path / FilenameSaveDataMemory;
     fs::create_directories(memoryPath.parent_path());
 
     int n = 0;
     std::string errMsg;
     while (n++ < 10) {
         try {
+            u64 bytes_written = 0;
             IOFile f;
-            int r = f.Open(memoryPath, Common::FS::FileAccessMode::Write);
+            int r = f.Open(memoryPath, Common::FS::FileAccessMode::ReadWrite);
+            if (f.IsOpen()) {
+                for (const auto& range : request.dirty_ranges) {
+                    const u64 size = range.upper() - range.lower();
+                    f.Seek(static_cast<s64>(range.lower()));
+                    f.WriteRaw<u8>(request.memory.data() + range.lower(), size);
+                    bytes_written += size;
+                }
+            } else {
+                r = f.Open(memoryPath, Common::FS::FileAccessMode::Write);
+                if (f.IsOpen()) {
+                    f.WriteRaw<u8>(request.memory.data(), request.memory.size());
+                    bytes_written += request.memory.size();
+                }
+            }
             if (f.IsOpen()) {
-                f.WriteRaw<u8>(data.memory_cache.data(), data.memory_cache.size());
                 f.Close();
-                return;
+                return bytes_written;
             }
             const auto err = std::error_code{r, std::iostream_category()};
             throw std::filesystem::filesystem_error{err.message(), err};
@@ -72,12 +120,113 @@ void PersistMemory(u32 slot_id, bool lock) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
         }
     }
-    const MsgDialog::MsgDialogState dialog{MsgDialog::MsgDialogState::UserState{
-        .type = MsgDialog::ButtonType::OK,
-        .msg = "Failed to persist save memory:\n" + errMsg + "\nat " +
-               Common::FS::PathToUTF8String(memoryPath),
-    }};
-    MsgDialog::ShowMsgDialog(dialog);
+    error = "Failed to persist save memory:\n" + errMsg + "\nat " +
+            Common::FS::PathToUTF8String(memoryPath);
+    return 0;
+}
+
+// Must be called without g_slot_mtx held, the dialog blocks until the user dismisses it.
+static void ShowFlushErrors(std::span<const std::string> errors) {
+    for (const auto& error : errors) {
+        const MsgDialog::MsgDialogState dialog{MsgDialog::MsgDialogState::UserState{
+            .type = MsgDialog::ButtonType::OK,
+            .msg = error,
+        }};
+        MsgDialog::ShowMsgDialog(dialog);
+    }
+}
+
+// Writes out the dirty slots, or only `slot_filter` if set. g_slot_mtx is only held to take
+// the dirty ranges and to account for the result, so guest save calls never wait on the file
+// I/O and its retries. g_flush_io_mtx keeps older copies from landing after newer ones.
+static std::vector<std::string> FlushSlots(std::optional<u32> slot_filter = {}) {
+    std::scoped_lock io_lk{g_flush_io_mtx};
+    std::vector<FlushRequest> requests;
+    {
+        std::scoped_lock lk{g_slot_mtx};
+        for (auto& [slot_id, data] : g_attached_slots) {
+            if (data.dirty_ranges.empty() || (slot_filter && *slot_filter != slot_id)) {
+                continue;
+            }
+            requests.push_back(FlushRequest{
+                .slot_id = slot_id,
+                .user_id = data.user_id,
+                .game_serial = data.game_serial,
+                .folder_path = data.folder_path,
+                .memory = data.memory_cache,
+                .dirty_ranges = std::exchange(data.dirty_ranges, {}),
+            });
+        }
+        if (!slot_filter) {
+            g_flush_pending = false;
+        }
+    }
+
+    std::vector<std::string> errors;
+    for (auto& request : requests) {
+        std::string error;
+        const u64 bytes_written = WriteMemoryFile(request, error);
+        {
+            std::scoped_lock lk{g_slot_mtx};
+            const auto it = g_attached_slots.find(request.slot_id);
+            if (it != g_attached_slots.end() && it->second.folder_path == request.folder_path) {
+                auto& data = it->second;
+                if (!error.empty()) {
+                    // Keep the ranges dirty so the next flush retries them.
+                    data.dirty_ranges += request.dirty_ranges;
+                } else {
+                    data.bytes_written += bytes_written;
+                    LOG_DEBUG(Lib_SaveData,
+                              "Save memory flushed, {} bytes written for {} requested",
+                              data.bytes_written, data.bytes_requested);
+                }
+            }
+        }
+        if (!error.empty()) {
+            errors.push_back(std::move(error));
+            continue;
+        }
+        Backup::NewRequest(request.user_id, request.game_serial, GetSaveDir(request.slot_id),
+                           Backup::OrbisSaveDataEventType::__DO_NOT_SAVE);
+    }
+    return errors;
+}
+
+// Coalesces guest writes: the first write after a flush arms a timer, and everything written
+// before it expires reaches the disk and the backup in one go.
+static void FlushThreadBody(std::stop_token stoken) {
+    Common::SetCurrentThreadName("shadPS4:SaveData:MemoryFlush");
+    while (!stoken.stop_requested()) {
+        {
+            std::unique_lock lk{g_slot_mtx};
+            Common::CondvarWait(g_flush_cv, lk, stoken, [] { return g_flush_pending; });
+        }
+        const auto delay = std::chrono::milliseconds(Config::getSaveMemoryFlushDelay());
+        Common::StoppableTimedWait(stoken, delay);
+        ShowFlushErrors(FlushSlots());
+    }
+}
+
+// Must be called with g_slot_mtx held.
+static void ScheduleFlush() {
+    static std::once_flag flag;
+    std::call_once(flag, [] {
+        g_flush_thread = std::jthread{FlushThreadBody};
+        std::at_quick_exit([] {
+            g_flush_thread.request_stop();
+            g_flush_thread.join();
+            // The process is going away, a dialog could not be answered anymore.
+            for (const auto& error : FlushSlots()) {
+                LOG_ERROR(Lib_SaveData, "{}", error);
+            }
+        });
+    });
+    g_flush_pending = true;
+    g_flush_cv.notify_one();
+}
+
+void PersistMemory(u32 slot_id) {
+    ShowFlushErrors(FlushSlots(slot_id));
 }
 
 std::string GetSaveDir(u32 slot_id) {
@@ -99,6 +248,11 @@ std::filesystem::path GetSavePath(OrbisUserServiceUserId user_id, u32 slot_id,
 
 size_t SetupSaveMemory(OrbisUserServiceUserId user_id, u32 slot_id, std::string_view game_serial,
                        size_t memory_size) {
+    // Showing a dialog here would stall the setup, the slot is replaced anyway.
+    for (const auto& error : FlushSlots(slot_id)) {
+        LOG_ERROR(Lib_SaveData, "{}", error);
+    }
+
     std::lock_guard lck{g_slot_mtx};
 
     const auto save_dir = GetSavePath(user_id, slot_id, game_serial);
@@ -196,15 +350,8 @@ void SaveSFO(u32 slot_id) {
 void ReadMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
     std::lock_guard lk{g_slot_mtx};
     auto& data = g_attached_slots[slot_id];
+    LoadMemory(data);
     auto& memory = data.memory_cache;
-    if (memory.empty()) { // Load file
-        memory.resize(data.memory_cache_size);
-        IOFile f{data.folder_path / FilenameSaveDataMemory, Common::FS::FileAccessMode::Read};
-        if (f.IsOpen()) {
-            f.Seek(0);
-            f.ReadSpan(std::span{memory});
-        }
-    }
     s64 read_size = buf_size;
     if (read_size + offset > memory.size()) {
         read_size = memory.size() - offset;
@@ -215,13 +362,16 @@ void ReadMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
 void WriteMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
     std::lock_guard lk{g_slot_mtx};
     auto& data = g_attached_slots[slot_id];
+    // Load first so a partial write doesn't drop the rest of the saved memory.
+    LoadMemory(data);
     auto& memory = data.memory_cache;
     if (offset + buf_size > memory.size()) {
         memory.resize(offset + buf_size);
     }
     std::memcpy(memory.data() + offset, buf, buf_size);
-    PersistMemory(slot_id, false);
-    Backup::NewRequest(data.user_id, data.game_serial, GetSaveDir(slot_id),
-                       Backup::OrbisSaveDataEventType::__DO_NOT_SAVE);
+    data.dirty_ranges += decltype(data.dirty_ranges)::interval_type::right_open(
+        static_cast<u64>(offset), static_cast<u64>(offset) + buf_size);
+    data.bytes_requested += buf_size;
+    ScheduleFlush();
 }
 } // namespace Libraries::SaveData::SaveMemory
\ No newline at end of file
@@ -14,7 +14,7 @@ using OrbisUserServiceUserId = s32;
 
 namespace Libraries::SaveData::SaveMemory {
 
-void PersistMemory(u32 slot_id, bool lock = true);
+void PersistMemory(u32 slot_id);
 
 [[nodiscard]] std::string GetSaveDir(u32 slot_id);
 
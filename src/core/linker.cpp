@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+
 #include "common/alignment.h"
 #include "common/arch.h"
 #include "common/assert.h"
@@ -65,9 +67,14 @@ void Linker::Execute(const std::vector<std::string>& args) {
     static_tls_size = module->tls.offset = module->tls.image_size;
 
     // Relocate all modules
+    const auto relocate_start = std::chrono::steady_clock::now();
     for (const auto& m : m_modules) {
         Relocate(m.get());
     }
+    LOG_INFO(Core_Linker, "Relocated {} modules in {} ms", m_modules.size(),
+             std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - relocate_start)
+                 .count());
 
     // Configure the direct and flexible memory regions.
     u64 fmem_size = ORBIS_FLEXIBLE_MEMORY_SIZE;
@@ -158,11 +165,17 @@ s32 Linker::LoadModule(const std::filesystem::path& elf_name, bool is_dynamic) {
         return -1;
     }
 
+    const auto load_start = std::chrono::steady_clock::now();
     auto module = std::make_unique<Module>(memory, elf_name, max_tls_index);
     if (!module->IsValid()) {
         LOG_ERROR(Core_Linker, "Provided file {} is not valid ELF file", elf_name.string());
         return -1;
     }
+    LOG_INFO(Core_Linker, "Loaded module {} with {} exported symbols in {} ms",
+             elf_name.filename().string(), module->export_sym.GetSize(),
+             std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - load_start)
+                 .count());
 
     num_static_modules += !is_dynamic;
     m_modules.emplace_back(std::move(module));
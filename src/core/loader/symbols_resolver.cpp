@@ -11,6 +11,11 @@
 namespace Core::Loader {
 
 void SymbolsResolver::AddSymbol(const SymbolResolver& s, u64 virtual_addr) {
+    // The first registration of a name wins, matching the order lookups used to scan in.
+    if (m_symbol_index.find(SymbolKeyView::From(s)) == m_symbol_index.end()) {
+        m_symbol_index.emplace(SymbolKey{s.name, s.library, s.module, s.library_version, s.type},
+                               static_cast<u32>(m_symbols.size()));
+    }
     m_symbols.emplace_back(GenerateName(s), s.nidName, virtual_addr);
 }
 
@@ -20,15 +25,11 @@ std::string SymbolsResolver::GenerateName(const SymbolResolver& s) {
 }
 
 const SymbolRecord* SymbolsResolver::FindSymbol(const SymbolResolver& s) const {
-    const std::string name = GenerateName(s);
-    for (u32 i = 0; i < m_symbols.size(); i++) {
-        if (m_symbols[i].name == name) {
-            return &m_symbols[i];
-        }
+    const auto it = m_symbol_index.find(SymbolKeyView::From(s));
+    if (it == m_symbol_index.end()) {
+        return nullptr;
     }
-
-    // LOG_INFO(Core_Linker, "Unresolved! {}", name);
-    return nullptr;
+    return &m_symbols[it->second];
 }
 
 void SymbolsResolver::DebugDump(const std::filesystem::path& file_name) {
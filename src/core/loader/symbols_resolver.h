@@ -6,8 +6,11 @@
 #include <filesystem>
 #include <span>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <tsl/robin_map.h>
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/types.h"
 
 namespace Core::Loader {
@@ -73,7 +76,67 @@ public:
     }
 
 private:
+    /// Identity of a symbol as used by lookups, views into a SymbolResolver.
+    struct SymbolKeyView {
+        std::string_view name;
+        std::string_view library;
+        std::string_view module;
+        u16 library_version;
+        SymbolType type;
+
+        static SymbolKeyView From(const SymbolResolver& s) {
+            return {s.name, s.library, s.module, s.library_version, s.type};
+        }
+
+        bool operator==(const SymbolKeyView&) const = default;
+    };
+
+    /// Owning copy of a SymbolKeyView stored in the index.
+    struct SymbolKey {
+        std::string name;
+        std::string library;
+        std::string module;
+        u16 library_version;
+        SymbolType type;
+
+        SymbolKeyView View() const {
+            return {name, library, module, library_version, type};
+        }
+    };
+
+    /// Hashes and compares owned and viewed keys alike, so lookups don't build a string.
+    struct SymbolKeyHash {
+        using is_transparent = void;
+
+        size_t operator()(const SymbolKeyView& key) const {
+            u64 hash = std::hash<std::string_view>{}(key.name);
+            hash = HashCombine(hash, std::hash<std::string_view>{}(key.library));
+            hash = HashCombine(hash, std::hash<std::string_view>{}(key.module));
+            return HashCombine(hash, (u64(key.library_version) << 8) | u64(key.type));
+        }
+        size_t operator()(const SymbolKey& key) const {
+            return (*this)(key.View());
+        }
+    };
+
+    struct SymbolKeyEqual {
+        using is_transparent = void;
+
+        static SymbolKeyView View(const SymbolKeyView& key) {
+            return key;
+        }
+        static SymbolKeyView View(const SymbolKey& key) {
+            return key.View();
+        }
+
+        template <typename L, typename R>
+        bool operator()(const L& lhs, const R& rhs) const {
+            return View(lhs) == View(rhs);
+        }
+    };
+
     std::vector<SymbolRecord> m_symbols;
+    tsl::robin_map<SymbolKey, u32, SymbolKeyHash, SymbolKeyEqual> m_symbol_index;
 };
 
 } // namespace Core::Loader
@@ -217,10 +217,11 @@ PAddr MemoryManager::Allocate(PAddr search_start, PAddr search_end, u64 size, u6
     }
 
     // Add the allocated region to the list and commit its pages.
-    auto& area = CarveDmemArea(mapping_start, size)->second;
+    const auto new_dmem_handle = CarveDmemArea(mapping_start, size);
+    auto& area = new_dmem_handle->second;
     area.memory_type = memory_type;
     area.dma_type = DMAType::Allocated;
-    MergeAdjacent(dmem_map, dmem_area);
+    MergeAdjacent(dmem_map, new_dmem_handle);
     return mapping_start;
 }
 
@@ -755,7 +756,7 @@ s32 MemoryManager::UnmapMemoryImpl(VAddr virtual_addr, u64 size) {
 
 s32 MemoryManager::QueryProtection(VAddr addr, void** start, void** end, u32* prot) {
     ASSERT_MSG(IsValidMapping(addr), "Attempted to access invalid address {:#x}", addr);
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     const auto it = FindVMA(addr);
     const auto& vma = it->second;
@@ -868,7 +869,7 @@ s32 MemoryManager::Protect(VAddr addr, u64 size, MemoryProt prot) {
 
 s32 MemoryManager::VirtualQuery(VAddr addr, s32 flags,
                                 ::Libraries::Kernel::OrbisVirtualQueryInfo* info) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     // FindVMA on addresses before the vma_map return garbage data.
     auto query_addr =
@@ -913,7 +914,7 @@ s32 MemoryManager::VirtualQuery(VAddr addr, s32 flags,
 
 s32 MemoryManager::DirectMemoryQuery(PAddr addr, bool find_next,
                                      ::Libraries::Kernel::OrbisQueryInfo* out_info) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     if (addr >= total_direct_size) {
         LOG_WARNING(Kernel_Vmm, "Unable to find allocated direct memory region to query!");
@@ -948,7 +949,7 @@ s32 MemoryManager::DirectMemoryQuery(PAddr addr, bool find_next,
 
 s32 MemoryManager::DirectQueryAvailable(PAddr search_start, PAddr search_end, u64 alignment,
                                         PAddr* phys_addr_out, u64* size_out) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     auto dmem_area = FindDmemArea(search_start);
     PAddr paddr{};
@@ -1071,6 +1072,8 @@ void MemoryManager::NameVirtualRange(VAddr virtual_addr, u64 size, std::string_v
 
 s32 MemoryManager::GetDirectMemoryType(PAddr addr, s32* directMemoryTypeOut,
                                        void** directMemoryStartOut, void** directMemoryEndOut) {
+    std::shared_lock lk{mutex};
+
     if (addr >= total_direct_size) {
         LOG_ERROR(Kernel_Vmm, "Unable to find allocated direct memory region to check type!");
         return ORBIS_KERNEL_ERROR_ENOENT;
@@ -1090,6 +1093,8 @@ s32 MemoryManager::GetDirectMemoryType(PAddr addr, s32* directMemoryTypeOut,
 
 s32 MemoryManager::IsStack(VAddr addr, void** start, void** end) {
     ASSERT_MSG(IsValidMapping(addr), "Attempted to access invalid address {:#x}", addr);
+    std::shared_lock lk{mutex};
+
     const auto& vma = FindVMA(addr)->second;
     if (vma.IsFree()) {
         return ORBIS_KERNEL_ERROR_EACCES;
@@ -1114,7 +1119,7 @@ s32 MemoryManager::IsStack(VAddr addr, void** start, void** end) {
 }
 
 s32 MemoryManager::GetMemoryPoolStats(::Libraries::Kernel::OrbisKernelMemoryPoolBlockStats* stats) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     // Run through dmem_map, determine how much physical memory is currently committed
     constexpr u64 block_size = 64_KB;
@@ -1218,14 +1223,15 @@ MemoryManager::VMAHandle MemoryManager::CarveVMA(VAddr virtual_addr, u64 size) {
 
     ASSERT_MSG(end_in_vma <= vma.size, "Mapping cannot fit inside free region");
 
-    if (end_in_vma != vma.size) {
-        // Split VMA at the end of the allocated region
-        Split(vma_handle, end_in_vma);
-    }
+    const bool split_end = end_in_vma != vma.size;
     if (start_in_vma != 0) {
         // Split VMA at the start of the allocated region
         vma_handle = Split(vma_handle, start_in_vma);
     }
+    if (split_end) {
+        // Split VMA at the end of the allocated region, the insert invalidates vma_handle.
+        vma_handle = std::prev(Split(vma_handle, size));
+    }
 
     return vma_handle;
 }
@@ -1242,14 +1248,15 @@ MemoryManager::DMemHandle MemoryManager::CarveDmemArea(PAddr addr, u64 size) {
     ASSERT_MSG(end_in_vma <= area.size, "Mapping cannot fit inside free region: size = {:#x}",
                size);
 
-    if (end_in_vma != area.size) {
-        // Split VMA at the end of the allocated region
-        Split(dmem_handle, end_in_vma);
-    }
+    const bool split_end = end_in_vma != area.size;
     if (start_in_area != 0) {
         // Split VMA at the start of the allocated region
         dmem_handle = Split(dmem_handle, start_in_area);
     }
+    if (split_end) {
+        // Split VMA at the end of the allocated region, the insert invalidates dmem_handle.
+        dmem_handle = std::prev(Split(dmem_handle, size));
+    }
 
     return dmem_handle;
 }
@@ -1266,14 +1273,15 @@ MemoryManager::FMemHandle MemoryManager::CarveFmemArea(PAddr addr, u64 size) {
     ASSERT_MSG(end_in_vma <= area.size, "Mapping cannot fit inside free region: size = {:#x}",
                size);
 
-    if (end_in_vma != area.size) {
-        // Split VMA at the end of the allocated region
-        Split(fmem_handle, end_in_vma);
-    }
+    const bool split_end = end_in_vma != area.size;
     if (start_in_area != 0) {
         // Split VMA at the start of the allocated region
         fmem_handle = Split(fmem_handle, start_in_area);
     }
+    if (split_end) {
+        // Split VMA at the end of the allocated region, the insert invalidates fmem_handle.
+        fmem_handle = std::prev(Split(fmem_handle, size));
+    }
 
     return fmem_handle;
 }
@@ -3,10 +3,11 @@
 
 #pragma once
 
-#include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <boost/container/flat_map.hpp>
 #include "common/enum.h"
 #include "common/singleton.h"
 #include "common/types.h"
@@ -157,13 +158,16 @@ struct VirtualMemoryArea {
 };
 
 class MemoryManager {
-    using DMemMap = std::map<PAddr, DirectMemoryArea>;
+    // Areas are kept in sorted arrays, lookups are a binary search over contiguous memory.
+    // Inserting or erasing an area invalidates handles at and after it, so handles must be
+    // looked up again after Split, Carve* and MergeAdjacent, except for the one they return.
+    using DMemMap = boost::container::flat_map<PAddr, DirectMemoryArea>;
     using DMemHandle = DMemMap::iterator;
 
-    using FMemMap = std::map<PAddr, FlexibleMemoryArea>;
+    using FMemMap = boost::container::flat_map<PAddr, FlexibleMemoryArea>;
     using FMemHandle = FMemMap::iterator;
 
-    using VMAMap = std::map<VAddr, VirtualMemoryArea>;
+    using VMAMap = boost::container::flat_map<VAddr, VirtualMemoryArea>;
     using VMAHandle = VMAMap::iterator;
 
 public:
@@ -353,7 +357,8 @@ private:
     DMemMap dmem_map;
     FMemMap fmem_map;
     VMAMap vma_map;
-    std::mutex mutex;
+    /// Queries that only inspect the maps take this shared, anything modifying them exclusive.
+    std::shared_mutex mutex;
     u64 total_direct_size{};
     u64 total_flexible_size{};
     u64 flexible_usage{};
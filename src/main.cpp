@@ -54,6 +54,8 @@ int main(int argc, char* argv[]) {
                     "  -i, --ignore-game-patch       Disable automatic loading of game patch\n"
                     "  -f, --fullscreen <true|false> Specify window initial fullscreen "
                     "state. Does not overwrite the config file.\n"
+                    "  --headless [none|hash|png]    Render offscreen without a window, log "
+                    "frame timings and optionally capture every frame.\n"
                     "  --add-game-folder <folder>    Adds a new game folder to the config.\n"
                     "  --set-addon-folder <folder>   Sets the addon folder to the config.\n"
                     "  --log-append                  Append log output to file instead of "
@@ -116,6 +118,24 @@ int main(int argc, char* argv[]) {
              Config::setIsFullscreen(is_fullscreen);
          }},
         {"--fullscreen", [&](int& i) { arg_map["-f"](i); }},
+        {"--headless",
+         [&](int& i) {
+             Config::setIsHeadless(true);
+             if (i + 1 >= argc) {
+                 return;
+             }
+             const std::string capture_param(argv[i + 1]);
+             if (capture_param == "none") {
+                 Config::setFrameCaptureMode("None");
+             } else if (capture_param == "hash") {
+                 Config::setFrameCaptureMode("Hash");
+             } else if (capture_param == "png") {
+                 Config::setFrameCaptureMode("Png");
+             } else {
+                 return;
+             }
+             ++i;
+         }},
         {"--add-game-folder",
          [&](int& i) {
              if (++i >= argc) {
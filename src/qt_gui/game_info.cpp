@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QProgressDialog>
 
 #include "common/path_util.h"
@@ -10,11 +12,80 @@
 // Maximum depth to search for games in subdirectories
 const int max_recursion_depth = 5;
 
-void ScanDirectoryRecursively(const QString& dir, QStringList& filePaths, int current_depth = 0) {
+// Bump whenever the layout of the game list index changes
+constexpr int game_index_version = 1;
+
+// Delay before rescanning after a watched directory changed, so bursts of changes coalesce
+constexpr int rescan_delay_ms = 1000;
+
+static QString GameIndexPath() {
+    QString path;
+    Common::FS::PathToQString(path, Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) /
+                                        "game_list_index.json");
+    return path;
+}
+
+// Modification times of everything readGameInfo looks at, a change in any of them means the
+// cached metadata is stale.
+static QString GameIndexStamp(const QString& game_dir) {
+    QString stamp;
+    for (const QString& dir : {game_dir, game_dir + "-UPDATE", game_dir + "-patch"}) {
+        for (const QString& path : {dir, dir + "/sce_sys/param.sfo", dir + "/sce_sys/icon0.png"}) {
+            const QFileInfo info(path);
+            stamp += QString::number(info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0);
+            stamp += ':';
+        }
+    }
+    return stamp;
+}
+
+static QString PathString(const std::filesystem::path& path) {
+    QString result;
+    Common::FS::PathToQString(result, path);
+    return result;
+}
+
+static QJsonObject GameToIndexEntry(const GameInfo& game, const QString& stamp) {
+    QJsonObject entry;
+    entry["stamp"] = stamp;
+    entry["icon_path"] = PathString(game.icon_path);
+    entry["pic_path"] = PathString(game.pic_path);
+    entry["snd0_path"] = PathString(game.snd0_path);
+    entry["name"] = QString::fromStdString(game.name);
+    entry["serial"] = QString::fromStdString(game.serial);
+    entry["version"] = QString::fromStdString(game.version);
+    entry["region"] = QString::fromStdString(game.region);
+    entry["fw"] = QString::fromStdString(game.fw);
+    entry["save_dir"] = QString::fromStdString(game.save_dir);
+    entry["play_time"] = QString::fromStdString(game.play_time);
+    entry["size"] = QString::fromStdString(game.size);
+    return entry;
+}
+
+static GameInfo GameFromIndexEntry(const QString& path, const QJsonObject& entry) {
+    GameInfo game;
+    game.path = Common::FS::PathFromQString(path);
+    game.icon_path = Common::FS::PathFromQString(entry["icon_path"].toString());
+    game.pic_path = Common::FS::PathFromQString(entry["pic_path"].toString());
+    game.snd0_path = Common::FS::PathFromQString(entry["snd0_path"].toString());
+    game.name = entry["name"].toString().toStdString();
+    game.serial = entry["serial"].toString().toStdString();
+    game.version = entry["version"].toString().toStdString();
+    game.region = entry["region"].toString().toStdString();
+    game.fw = entry["fw"].toString().toStdString();
+    game.save_dir = entry["save_dir"].toString().toStdString();
+    game.play_time = entry["play_time"].toString().toStdString();
+    game.size = entry["size"].toString().toStdString();
+    return game;
+}
+
+void ScanDirectoryRecursively(const QString& dir, QStringList& filePaths, QStringList& scannedDirs,
+                              int current_depth = 0) {
     // Stop recursion if we've reached the maximum depth
     if (current_depth >= max_recursion_depth) {
         return;
     }
+    scannedDirs.append(dir);
 
     QDir directory(dir);
     QFileInfoList entries = directory.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
@@ -29,45 +100,137 @@ void ScanDirectoryRecursively(const QString& dir, QStringList& filePaths, int cu
             filePaths.append(entry.absoluteFilePath());
         } else {
             // If not a game directory, recursively scan it with increased depth
-            ScanDirectoryRecursively(entry.absoluteFilePath(), filePaths, current_depth + 1);
+            ScanDirectoryRecursively(entry.absoluteFilePath(), filePaths, scannedDirs,
+                                     current_depth + 1);
         }
     }
 }
 
-GameInfoClass::GameInfoClass() = default;
+GameInfoClass::GameInfoClass() {
+    m_rescan_timer.setSingleShot(true);
+    m_rescan_timer.setInterval(rescan_delay_ms);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, &m_rescan_timer,
+            qOverload<>(&QTimer::start));
+    connect(&m_rescan_timer, &QTimer::timeout, this, &GameInfoClass::GameListChanged);
+    LoadIndex();
+}
+
 GameInfoClass::~GameInfoClass() = default;
 
+void GameInfoClass::LoadIndex() {
+    QFile index_file(GameIndexPath());
+    if (!index_file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonDocument json_doc = QJsonDocument::fromJson(index_file.readAll());
+    const QJsonObject root = json_doc.object();
+    if (root["version"].toInt() != game_index_version) {
+        return;
+    }
+    m_index = root["games"].toObject();
+}
+
+void GameInfoClass::SaveIndex() {
+    QJsonObject root;
+    root["version"] = game_index_version;
+    root["games"] = m_index;
+
+    QFile index_file(GameIndexPath());
+    if (!index_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return;
+    }
+    index_file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
+
+void GameInfoClass::WatchDirectories(const QStringList& scanned_dirs,
+                                     const QStringList& game_dirs) {
+    if (const QStringList watched = m_watcher.directories(); !watched.isEmpty()) {
+        m_watcher.removePaths(watched);
+    }
+    // Installing or removing a game touches a scanned directory, while updating one in place
+    // touches its own root or sce_sys directory.
+    QStringList paths = scanned_dirs;
+    for (const QString& dir : game_dirs) {
+        paths.append(dir);
+        paths.append(dir + "/sce_sys");
+    }
+    m_watcher.addPaths(paths);
+}
+
 void GameInfoClass::GetGameInfo(QWidget* parent) {
+    QStringList scannedDirs;
     QStringList filePaths;
     for (const auto& installLoc : Config::getGameInstallDirs()) {
         QString installDir;
         Common::FS::PathToQString(installDir, installLoc);
-        ScanDirectoryRecursively(installDir, filePaths, 0);
+        ScanDirectoryRecursively(installDir, filePaths, scannedDirs, 0);
+    }
+
+    // Only games whose files changed since the last scan need their param.sfo parsed again.
+    QHash<QString, QString> stamps;
+    QHash<QString, GameInfo> cached;
+    for (const QString& path : filePaths) {
+        const QString stamp = GameIndexStamp(path);
+        stamps.insert(path, stamp);
+        if (const QJsonObject entry = m_index.value(path).toObject();
+            entry.value("stamp").toString() == stamp) {
+            cached.insert(path, GameFromIndexEntry(path, entry));
+        }
     }
 
     m_games = QtConcurrent::mapped(filePaths, [&](const QString& path) {
+                  if (const auto it = cached.constFind(path); it != cached.cend()) {
+                      GameInfo game = it.value();
+                      game.icon = QImage(PathString(game.icon_path));
+                      return game;
+                  }
                   return readGameInfo(Common::FS::PathFromQString(path));
               }).results();
 
     // used to retrieve values after performing a search
     m_games_backup = m_games;
 
+    // Folder sizes of indexed games are still valid, so only walk the ones that changed.
+    QList<GameInfo*> unsized;
+    for (auto& game : m_games) {
+        if (!Config::GetLoadGameSizeEnabled()) {
+            game.size = GameListUtils::FormatSize(0).toStdString();
+        } else if (game.size.empty()) {
+            unsized.append(&game);
+        }
+    }
+
     // Progress bar, please be patient :)
     QProgressDialog dialog(tr("Loading game list, please wait :3"), tr("Cancel"), 0, 0, parent);
     dialog.setWindowTitle(tr("Loading..."));
 
     QFutureWatcher<void> futureWatcher;
-    GameListUtils game_util;
     bool finished = false;
-    futureWatcher.setFuture(QtConcurrent::map(m_games, game_util.GetFolderSize));
+    futureWatcher.setFuture(QtConcurrent::map(
+        unsized, [](GameInfo* game) { GameListUtils::GetFolderSize(*game); }));
     connect(&futureWatcher, &QFutureWatcher<void>::finished, [&]() {
         dialog.reset();
         std::sort(m_games.begin(), m_games.end(), CompareStrings);
     });
     connect(&dialog, &QProgressDialog::canceled, &futureWatcher, &QFutureWatcher<void>::cancel);
-    dialog.setRange(0, m_games.size());
+    dialog.setRange(0, unsized.size());
     connect(&futureWatcher, &QFutureWatcher<void>::progressValueChanged, &dialog,
             &QProgressDialog::setValue);
 
     dialog.exec();
+
+    // Rebuild the index from this scan, which also drops games that were removed.
+    QJsonObject index;
+    for (const auto& game : m_games) {
+        const QString path = PathString(game.path);
+        QJsonObject entry = GameToIndexEntry(game, stamps.value(path));
+        if (!Config::GetLoadGameSizeEnabled()) {
+            entry["size"] = m_index.value(path).toObject().value("size");
+        }
+        index.insert(path, entry);
+    }
+    m_index = std::move(index);
+    SaveIndex();
+
+    WatchDirectories(scannedDirs, filePaths);
 }
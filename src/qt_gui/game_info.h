@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include <QFileSystemWatcher>
 #include <QFutureWatcher>
+#include <QJsonObject>
+#include <QTimer>
 #include <QtConcurrent>
 
 #include "common/config.h"
@@ -97,4 +100,18 @@ public:
         }
         return game;
     }
+
+signals:
+    /// Emitted shortly after a watched install or game directory changes on disk.
+    void GameListChanged();
+
+private:
+    void LoadIndex();
+    void SaveIndex();
+    void WatchDirectories(const QStringList& scanned_dirs, const QStringList& game_dirs);
+
+    /// On-disk cache of PSF metadata and folder sizes, keyed by game path.
+    QJsonObject m_index;
+    QFileSystemWatcher m_watcher;
+    QTimer m_rescan_timer;
 };
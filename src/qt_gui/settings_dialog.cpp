@@ -120,7 +120,7 @@ SettingsDialog::SettingsDialog(std::shared_ptr<gui_settings> gui_settings,
     ui->buttonBox->button(QDialogButtonBox::StandardButton::Close)->setFocus();
 
     channelMap = {{tr("Release"), "Release"}, {tr("Nightly"), "Nightly"}};
-    logTypeMap = {{tr("async"), "async"}, {tr("sync"), "sync"}};
+    logTypeMap = {{tr("async"), "async"}, {tr("sync"), "sync"}, {tr("binary"), "binary"}};
     screenModeMap = {{tr("Fullscreen (Borderless)"), "Fullscreen (Borderless)"},
                      {tr("Windowed"), "Windowed"},
                      {tr("Fullscreen"), "Fullscreen"}};
@@ -189,6 +189,8 @@ struct Info {
 
     PersistentSrtInfo srt_info;
     std::vector<u32> flattened_ud_buf;
+    /// Flat buffer saved with a shader dump, used instead of walking the SRT in guest memory.
+    std::span<const u32> recorded_flat_buf;
 
     struct Interpolation {
         Qualifier primary;
@@ -277,6 +279,12 @@ struct Info {
     void RefreshFlatBuf() {
         flattened_ud_buf.resize(srt_info.flattened_bufsize_dw);
         ASSERT(user_data.size() <= NumUserDataRegs);
+        if (!recorded_flat_buf.empty()) {
+            ASSERT(recorded_flat_buf.size() == flattened_ud_buf.size());
+            std::memcpy(flattened_ud_buf.data(), recorded_flat_buf.data(),
+                        recorded_flat_buf.size_bytes());
+            return;
+        }
         std::memcpy(flattened_ud_buf.data(), user_data.data(), user_data.size_bytes());
         // Run the JIT program to walk the SRT and write the leaves to a flat buffer
         if (srt_info.walker_func) {
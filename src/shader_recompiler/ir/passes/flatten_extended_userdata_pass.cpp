@@ -2,6 +2,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <boost/container/flat_map.hpp>
 #include <xbyak/xbyak.h>
@@ -25,8 +27,13 @@
 
 using namespace Xbyak::util;
 
+// The walkers of all shaders share one code buffer, recognized by address in the access
+// violation handler. Shaders may be translated on several threads, so walkers are emitted under
+// a lock and the handler only reads the end of the walkers finished so far.
+static std::mutex g_srt_codegen_mutex;
 static Xbyak::CodeGenerator g_srt_codegen(32_MB);
 static const u8* g_srt_codegen_start = nullptr;
+static std::atomic<const u8*> g_srt_codegen_end = nullptr;
 
 namespace {
 
@@ -60,7 +67,7 @@ static void DumpSrtProgram(const Shader::Info& info, const u8* code, size_t code
 static bool SrtWalkerSignalHandler(void* context, void* fault_address) {
     // Only handle if the fault address is within the SRT code range
     const u8* code_start = g_srt_codegen_start;
-    const u8* code_end = code_start + g_srt_codegen.getSize();
+    const u8* code_end = g_srt_codegen_end.load(std::memory_order_acquire);
     const void* code = Common::GetRip(context);
     if (code < code_start || code >= code_end) {
         return false; // Not in SRT code range
@@ -189,12 +196,13 @@ static void VisitPointer(u32 off_dw, IR::Inst* subtree, PassInfo& pass_info,
 }
 
 static void GenerateSrtProgram(Info& info, PassInfo& pass_info) {
-    Xbyak::CodeGenerator& c = g_srt_codegen;
-
     if (pass_info.srt_roots.empty()) {
         return;
     }
 
+    std::scoped_lock lk{g_srt_codegen_mutex};
+    Xbyak::CodeGenerator& c = g_srt_codegen;
+
     // Register the signal handler for SRT walker, if not already registered
     if (g_srt_codegen_start == nullptr) {
         g_srt_codegen_start = c.getCurr();
@@ -214,6 +222,7 @@ static void GenerateSrtProgram(Info& info, PassInfo& pass_info) {
 
     c.ret();
     c.ready();
+    g_srt_codegen_end.store(c.getCurr(), std::memory_order_release);
 
     if (Config::dumpShaders()) {
         size_t codesize = c.getCurr() - reinterpret_cast<const u8*>(info.srt_info.walker_func);
@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+
 #include "shader_recompiler/frontend/control_flow_graph.h"
 #include "shader_recompiler/frontend/decode.h"
 #include "shader_recompiler/frontend/structured_control_flow.h"
@@ -28,8 +30,38 @@ IR::BlockList GenerateBlocks(const IR::AbstractSyntaxList& syntax_list) {
     return blocks;
 }
 
+/// Records how long each translation step took when statistics were requested.
+class StepTimer {
+    using Clock = std::chrono::steady_clock;
+
+public:
+    explicit StepTimer(TranslateStats* stats_) : stats{stats_}, start{Clock::now()} {}
+
+    void Mark(std::string_view step) {
+        if (!stats) {
+            return;
+        }
+        const auto now = Clock::now();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+        stats->step_us.emplace_back(step, elapsed.count());
+        start = now;
+    }
+
+private:
+    TranslateStats* stats;
+    Clock::time_point start;
+};
+
+Pools& GetThreadPools() {
+    thread_local Pools pools;
+    return pools;
+}
+
 IR::Program TranslateProgram(std::span<const u32> code, Pools& pools, Info& info,
-                             RuntimeInfo& runtime_info, const Profile& profile) {
+                             RuntimeInfo& runtime_info, const Profile& profile,
+                             TranslateStats* stats) {
+    StepTimer timer{stats};
+
     // Ensure first instruction is expected.
     constexpr u32 token_mov_vcchi = 0xBEEB03FF;
     if (code[0] != token_mov_vcchi) {
@@ -45,6 +77,7 @@ IR::Program TranslateProgram(std::span<const u32> code, Pools& pools, Info& info
     while (!slice.atEnd()) {
         program.ins_list.emplace_back(decoder.decodeInstruction(slice));
     }
+    timer.Mark("Decode");
 
     // Clear any previous pooled data.
     pools.ReleaseContents();
@@ -52,42 +85,70 @@ IR::Program TranslateProgram(std::span<const u32> code, Pools& pools, Info& info
     // Create control flow graph
     Common::ObjectPool<Gcn::Block> gcn_block_pool{64};
     Gcn::CFG cfg{gcn_block_pool, program.ins_list};
+    timer.Mark("CFG");
 
     // Structurize control flow graph and create program.
     program.syntax_list = Shader::Gcn::BuildASL(pools.inst_pool, pools.block_pool, cfg,
                                                 program.info, runtime_info, profile);
     program.blocks = GenerateBlocks(program.syntax_list);
     program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front());
+    timer.Mark("BuildASL");
 
     // Run optimization passes
     if (!profile.support_float64) {
         Shader::Optimization::LowerFp64ToFp32(program);
+        timer.Mark("LowerFp64ToFp32");
     }
     Shader::Optimization::SsaRewritePass(program.post_order_blocks);
+    timer.Mark("SsaRewritePass");
     Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
+    timer.Mark("ConstantPropagationPass");
     Shader::Optimization::IdentityRemovalPass(program.blocks);
+    timer.Mark("IdentityRemovalPass");
     if (info.l_stage == LogicalStage::TessellationControl) {
         Shader::Optimization::TessellationPreprocess(program, runtime_info);
+        timer.Mark("TessellationPreprocess");
         Shader::Optimization::HullShaderTransform(program, runtime_info);
+        timer.Mark("HullShaderTransform");
     } else if (info.l_stage == LogicalStage::TessellationEval) {
         Shader::Optimization::TessellationPreprocess(program, runtime_info);
+        timer.Mark("TessellationPreprocess");
         Shader::Optimization::DomainShaderTransform(program, runtime_info);
+        timer.Mark("DomainShaderTransform");
     }
     Shader::Optimization::RingAccessElimination(program, runtime_info);
+    timer.Mark("RingAccessElimination");
     Shader::Optimization::ReadLaneEliminationPass(program);
+    timer.Mark("ReadLaneEliminationPass");
     Shader::Optimization::FlattenExtendedUserdataPass(program);
+    timer.Mark("FlattenExtendedUserdataPass");
     Shader::Optimization::ResourceTrackingPass(program);
+    timer.Mark("ResourceTrackingPass");
     Shader::Optimization::LowerBufferFormatToRaw(program);
+    timer.Mark("LowerBufferFormatToRaw");
     Shader::Optimization::SharedMemorySimplifyPass(program, profile);
+    timer.Mark("SharedMemorySimplifyPass");
     Shader::Optimization::SharedMemoryToStoragePass(program, runtime_info, profile);
+    timer.Mark("SharedMemoryToStoragePass");
     Shader::Optimization::SharedMemoryBarrierPass(program, runtime_info, profile);
+    timer.Mark("SharedMemoryBarrierPass");
     Shader::Optimization::IdentityRemovalPass(program.blocks);
+    timer.Mark("IdentityRemovalPass");
     Shader::Optimization::DeadCodeEliminationPass(program);
+    timer.Mark("DeadCodeEliminationPass");
     Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
+    timer.Mark("ConstantPropagationPass");
     Shader::Optimization::CollectShaderInfoPass(program, profile);
+    timer.Mark("CollectShaderInfoPass");
 
     Shader::IR::DumpProgram(program, info);
 
+    if (stats) {
+        stats->num_gcn_insts = static_cast<u32>(program.ins_list.size());
+        for (const IR::Block* block : program.blocks) {
+            stats->num_ir_insts += static_cast<u32>(block->size());
+        }
+    }
     return program;
 }
 
@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <string_view>
+#include <utility>
+#include <boost/container/small_vector.hpp>
+
 #include "common/object_pool.h"
 #include "shader_recompiler/ir/basic_block.h"
 #include "shader_recompiler/ir/program.h"
@@ -27,7 +31,29 @@ struct Pools {
     }
 };
 
+/// Timing and size figures of a single translation, for tracking recompiler regressions.
+struct TranslateStats {
+    boost::container::small_vector<std::pair<std::string_view, u64>, 32> step_us;
+    u32 num_gcn_insts{};
+    u32 num_ir_insts{};
+
+    [[nodiscard]] u64 TotalUs() const {
+        u64 total = 0;
+        for (const auto& [_, us] : step_us) {
+            total += us;
+        }
+        return total;
+    }
+};
+
+/// Returns the pools of the calling thread. Programs translated with them stay valid until the
+/// next translation on the same thread.
+[[nodiscard]] Pools& GetThreadPools();
+
+/// Translation may run concurrently on several threads as long as each one uses its own pools.
+/// The only state shared between translations is the SRT walker code buffer, which is locked.
 [[nodiscard]] IR::Program TranslateProgram(std::span<const u32> code, Pools& pools, Info& info,
-                                           RuntimeInfo& runtime_info, const Profile& profile);
+                                           RuntimeInfo& runtime_info, const Profile& profile,
+                                           TranslateStats* stats = nullptr);
 
 } // namespace Shader
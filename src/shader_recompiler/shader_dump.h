@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <type_traits>
+#include <vector>
+
+#include "common/io_file.h"
+#include "common/types.h"
+#include "shader_recompiler/info.h"
+#include "shader_recompiler/profile.h"
+#include "shader_recompiler/runtime_info.h"
+
+namespace Shader {
+
+/**
+ * Translation inputs saved next to a dumped shader, so that it can be translated again offline
+ * without the guest memory it was read from. Only readable by the build that wrote it.
+ */
+struct ShaderDumpContext {
+    static constexpr u32 Magic = 0x58544353; // SCTX
+
+    struct Header {
+        u32 magic = Magic;
+        u32 header_size = sizeof(Header);
+        Stage stage;
+        LogicalStage l_stage;
+        u64 hash;
+        std::array<u32, NumUserDataRegs> user_data;
+        RuntimeInfo runtime_info; ///< As it was before translation modified it.
+        Profile profile;
+        bool direct_memory_access;
+        u32 fetch_shader_sgpr_base;
+        u32 num_flat_buf_dw;
+        u32 num_fetch_code_dw;
+        u32 num_copy_code_dw;
+    };
+    static_assert(std::is_trivially_copyable_v<Header>);
+
+    Header header{};
+    std::vector<u32> flat_buf;   ///< User data with the SRT leaves the walker flattened.
+    std::vector<u32> fetch_code; ///< Fetch shader called by a vertex shader.
+    std::vector<u32> copy_code;  ///< Copy shader that goes with a geometry shader.
+
+    bool Save(const std::filesystem::path& path) {
+        const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write};
+        header.num_flat_buf_dw = static_cast<u32>(flat_buf.size());
+        header.num_fetch_code_dw = static_cast<u32>(fetch_code.size());
+        header.num_copy_code_dw = static_cast<u32>(copy_code.size());
+        const auto write = [&](std::span<const u32> data) {
+            return file.WriteSpan(data) == data.size();
+        };
+        return file.WriteObject(header) && write(flat_buf) && write(fetch_code) && write(copy_code);
+    }
+
+    bool Load(const std::filesystem::path& path) {
+        const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read};
+        if (!file.ReadObject(header) || header.magic != Magic ||
+            header.header_size != sizeof(Header)) {
+            return false;
+        }
+        flat_buf.resize(header.num_flat_buf_dw);
+        fetch_code.resize(header.num_fetch_code_dw);
+        copy_code.resize(header.num_copy_code_dw);
+        const auto read = [&](std::span<u32> data) { return file.ReadSpan(data) == data.size(); };
+        return read(flat_buf) && read(fetch_code) && read(copy_code);
+    }
+};
+
+} // namespace Shader
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <boost/preprocessor/stringize.hpp>
 
 #include "common/assert.h"
@@ -50,6 +51,46 @@ static const char* acb_task_name[] = NAME_ARRAY(ACB_TASK, MAX_NAMES);
 
 std::array<u8, 48_KB> Liverpool::ConstantEngine::constants_heap;
 
+static constexpr u32 NumContextRegs = 0x400;
+
+// Pipeline key groups of every context register, so register writes can tell the pipeline cache
+// which parts of its key went stale.
+static constexpr auto ContextRegDirtyFlags = [] {
+    std::array<u8, NumContextRegs> flags{};
+    const auto mark = [&](size_t reg_index, size_t size, u32 flag) {
+        const size_t first = reg_index - Liverpool::ContextRegWordOffset;
+        for (size_t i = first; i < first + size / sizeof(u32); ++i) {
+            flags[i] |= flag;
+        }
+    };
+#define MARK_DIRTY(field, flag)                                                                    \
+    mark(offsetof(Liverpool::Regs, field) / sizeof(u32), sizeof(Liverpool::Regs::field), flag)
+    MARK_DIRTY(depth_buffer, Liverpool::DirtyDepthTarget);
+    MARK_DIRTY(depth_render_override, Liverpool::DirtyRasterState);
+    MARK_DIRTY(clipper_control, Liverpool::DirtyRasterState);
+    MARK_DIRTY(polygon_control, Liverpool::DirtyRasterState);
+    MARK_DIRTY(stage_enable, Liverpool::DirtyRasterState);
+    MARK_DIRTY(ls_hs_config, Liverpool::DirtyRasterState);
+    MARK_DIRTY(color_shader_mask, Liverpool::DirtyRasterState);
+    MARK_DIRTY(color_control, Liverpool::DirtyRasterState | Liverpool::DirtyColorTargets);
+    MARK_DIRTY(color_target_mask, Liverpool::DirtyColorTargets);
+    MARK_DIRTY(color_export_format, Liverpool::DirtyColorTargets);
+    MARK_DIRTY(blend_control, Liverpool::DirtyColorTargets);
+    MARK_DIRTY(color_buffers, Liverpool::DirtyColorTargets);
+#undef MARK_DIRTY
+    return flags;
+}();
+
+static constexpr u32 PrimitiveTypeReg = offsetof(Liverpool::Regs, primitive_type) / sizeof(u32);
+
+static u32 GetContextRegsDirtyFlags(u32 reg_offset, u32 num_regs) {
+    u32 flags = 0;
+    for (u32 i = reg_offset; i < std::min(reg_offset + num_regs, NumContextRegs); ++i) {
+        flags |= ContextRegDirtyFlags[i];
+    }
+    return flags;
+}
+
 static std::span<const u32> NextPacket(std::span<const u32> span, size_t offset) {
     if (offset > span.size()) {
         LOG_ERROR(
@@ -109,29 +150,30 @@ void Liverpool::Process(std::stop_token stoken) {
         while (num_submits || num_commands) {
             ProcessCommands();
 
-            curr_qid = (curr_qid + 1) % num_mapped_queues;
+            curr_qid = NextQueueId(curr_qid);
 
             auto& queue = mapped_queues[curr_qid];
-
-            Task::Handle task{};
-            {
-                std::scoped_lock lock{queue.m_access};
-                if (queue.submits.empty()) {
-                    continue;
-                }
-                task = queue.submits.front();
+            if (!queue.current.handle && !PopSubmit(curr_qid)) {
+                continue;
             }
+
+            const auto task = queue.current.handle;
             task.resume();
 
             if (task.done()) {
                 task.destroy();
 
-                std::scoped_lock lock{queue.m_access};
-                queue.submits.pop();
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - queue.current.submit_time);
+                queue.total_process_us.fetch_add(elapsed.count(), std::memory_order_relaxed);
+                queue.num_completed.fetch_add(1, std::memory_order_relaxed);
+                queue.depth.fetch_sub(1, std::memory_order_relaxed);
+                queue.current = {};
 
-                --num_submits;
-                std::scoped_lock lock2{submit_mutex};
-                submit_cv.notify_all();
+                if (--num_submits == 0) {
+                    std::scoped_lock lk{submit_mutex};
+                    submit_cv.notify_all();
+                }
             }
         }
 
@@ -148,6 +190,66 @@ void Liverpool::Process(std::stop_token stoken) {
     }
 }
 
+u32 Liverpool::NextQueueId(int qid) {
+    // Graphics is given a turn between every async compute queue so that a busy set of compute
+    // queues can't starve it, while compute still advances while the graphics task waits.
+    const u32 num_queues = num_mapped_queues.load(std::memory_order_acquire);
+    if (num_queues == 1 || qid < 0) {
+        return GfxQueueId;
+    }
+    if (qid != GfxQueueId) {
+        last_asc_qid = static_cast<u32>(qid);
+        return GfxQueueId;
+    }
+    const u32 next = last_asc_qid + 1;
+    return next < num_queues ? next : GfxQueueId + 1;
+}
+
+void Liverpool::PushSubmit(u32 qid, Task::Handle handle) {
+    auto& queue = mapped_queues[qid];
+
+    // Counters are raised before publishing so the processor can't retire the task first.
+    const u32 depth = queue.depth.fetch_add(1, std::memory_order_relaxed) + 1;
+    u32 max_depth = queue.max_depth.load(std::memory_order_relaxed);
+    while (depth > max_depth &&
+           !queue.max_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {
+    }
+    queue.num_submitted.fetch_add(1, std::memory_order_relaxed);
+    ++num_submits;
+
+    // Guest threads must never block on a busy GPU, spill into the overflow queue instead.
+    const Submission submission{handle, std::chrono::steady_clock::now()};
+    if (queue.has_overflow.load(std::memory_order_acquire) ||
+        !queue.submits.TryEmplace(submission)) {
+        std::scoped_lock lk{queue.overflow_mutex};
+        queue.overflow.push(submission);
+        queue.has_overflow.store(true, std::memory_order_release);
+    }
+
+    std::scoped_lock lk{submit_mutex};
+    submit_cv.notify_one();
+}
+
+bool Liverpool::PopSubmit(u32 qid) {
+    auto& queue = mapped_queues[qid];
+    if (queue.submits.TryPop(queue.current)) {
+        return true;
+    }
+    if (!queue.has_overflow.load(std::memory_order_acquire)) {
+        return false;
+    }
+    std::scoped_lock lk{queue.overflow_mutex};
+    if (queue.overflow.empty()) {
+        return false;
+    }
+    queue.current = queue.overflow.front();
+    queue.overflow.pop();
+    if (queue.overflow.empty()) {
+        queue.has_overflow.store(false, std::memory_order_release);
+    }
+    return true;
+}
+
 Liverpool::Task Liverpool::ProcessCeUpdate(std::span<const u32> ccb) {
     FIBER_ENTER(ccb_task_name);
 
@@ -301,6 +403,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::ClearState: {
                 regs.SetDefaults();
+                dirty_flags = DirtyAll;
                 break;
             }
             case PM4ItOpcode::SetConfigReg: {
@@ -316,6 +419,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 const auto* payload = reinterpret_cast<const u32*>(header + 2);
 
                 std::memcpy(&regs.reg_array[reg_addr], payload, (count - 1) * sizeof(u32));
+                dirty_flags |= GetContextRegsDirtyFlags(set_data->reg_offset, count - 1);
 
                 // In the case of HW, render target memory has alignment as color block operates on
                 // tiles. There is no information of actual resource extents stored in CB context
@@ -401,8 +505,11 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::SetUconfigReg: {
                 const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
-                std::memcpy(&regs.reg_array[UconfigRegWordOffset + set_data->reg_offset],
-                            header + 2, (count - 1) * sizeof(u32));
+                const auto reg_addr = UconfigRegWordOffset + set_data->reg_offset;
+                std::memcpy(&regs.reg_array[reg_addr], header + 2, (count - 1) * sizeof(u32));
+                if (reg_addr <= PrimitiveTypeReg && PrimitiveTypeReg < reg_addr + count - 1) {
+                    dirty_flags |= DirtyRasterState;
+                }
                 break;
             }
             case PM4ItOpcode::SetPredication: {
@@ -739,7 +846,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 // instead and allow other tasks to run.
                 const u64* wait_addr = wait_reg_mem->Address<u64*>();
                 if (vo_port->IsVoLabel(wait_addr) &&
-                    num_submits == mapped_queues[GfxQueueId].submits.size()) {
+                    num_submits == mapped_queues[GfxQueueId].depth.load()) {
                     vo_port->WaitVoLabel([&] { return wait_reg_mem->Test(regs.reg_array); });
                     break;
                 }
@@ -1090,38 +1197,26 @@ std::pair<std::span<const u32>, std::span<const u32>> Liverpool::CopyCmdBuffers(
 }
 
 void Liverpool::SubmitGfx(std::span<const u32> dcb, std::span<const u32> ccb) {
-    auto& queue = mapped_queues[GfxQueueId];
-
     if (Config::copyGPUCmdBuffers()) {
         std::tie(dcb, ccb) = CopyCmdBuffers(dcb, ccb);
     }
 
     auto task = ProcessGraphics(dcb, ccb);
-    {
-        std::scoped_lock lock{queue.m_access};
-        queue.submits.emplace(task.handle);
-    }
-
-    std::scoped_lock lk{submit_mutex};
-    ++num_submits;
-    submit_cv.notify_one();
+    PushSubmit(GfxQueueId, task.handle);
 }
 
 void Liverpool::SubmitAsc(u32 gnm_vqid, std::span<const u32> acb) {
     ASSERT_MSG(gnm_vqid > 0 && gnm_vqid < NumTotalQueues, "Invalid virtual ASC queue index");
-    auto& queue = mapped_queues[gnm_vqid];
 
     const auto vqid = gnm_vqid - 1;
     const auto& task = ProcessCompute(acb, vqid);
-    {
-        std::scoped_lock lock{queue.m_access};
-        queue.submits.emplace(task.handle);
-    }
 
-    std::scoped_lock lk{submit_mutex};
-    num_mapped_queues = std::max(num_mapped_queues, gnm_vqid + 1);
-    ++num_submits;
-    submit_cv.notify_one();
+    u32 num_queues = num_mapped_queues.load(std::memory_order_relaxed);
+    while (num_queues < gnm_vqid + 1 &&
+           !num_mapped_queues.compare_exchange_weak(num_queues, gnm_vqid + 1,
+                                                    std::memory_order_release)) {
+    }
+    PushSubmit(gnm_vqid, task.handle);
 }
 
 } // namespace AmdGpu
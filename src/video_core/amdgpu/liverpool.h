@@ -4,6 +4,7 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <condition_variable>
 #include <coroutine>
 #include <exception>
@@ -11,11 +12,13 @@
 #include <semaphore>
 #include <span>
 #include <thread>
+#include <utility>
 #include <vector>
 #include <queue>
 
 #include "common/assert.h"
 #include "common/bit_field.h"
+#include "common/bounded_threadsafe_queue.h"
 #include "common/polyfill_thread.h"
 #include "common/slot_vector.h"
 #include "common/types.h"
@@ -1516,6 +1519,44 @@ public:
     void SubmitGfx(std::span<const u32> dcb, std::span<const u32> ccb);
     void SubmitAsc(u32 gnm_vqid, std::span<const u32> acb);
 
+    /// Submission counters of a single hardware queue.
+    struct QueueStats {
+        u64 num_submitted;
+        u64 num_completed;
+        u32 depth;
+        u32 max_depth;
+        u64 total_process_us;
+    };
+
+    /// Number of hardware queues that received submissions so far, graphics included.
+    u32 GetNumMappedQueues() const {
+        return num_mapped_queues.load(std::memory_order_acquire);
+    }
+
+    QueueStats GetQueueStats(u32 qid) const {
+        const auto& queue = mapped_queues[qid];
+        return QueueStats{
+            .num_submitted = queue.num_submitted.load(std::memory_order_relaxed),
+            .num_completed = queue.num_completed.load(std::memory_order_relaxed),
+            .depth = queue.depth.load(std::memory_order_relaxed),
+            .max_depth = queue.max_depth.load(std::memory_order_relaxed),
+            .total_process_us = queue.total_process_us.load(std::memory_order_relaxed),
+        };
+    }
+
+    /// Register groups the graphics pipeline key is derived from.
+    enum DirtyFlags : u32 {
+        DirtyDepthTarget = 1u << 0,
+        DirtyRasterState = 1u << 1,
+        DirtyColorTargets = 1u << 2,
+        DirtyAll = DirtyDepthTarget | DirtyRasterState | DirtyColorTargets,
+    };
+
+    /// Returns the groups written since the previous call. Called from the GPU thread only.
+    u32 ConsumeDirtyFlags() {
+        return std::exchange(dirty_flags, 0u);
+    }
+
     void SubmitDone() noexcept {
         std::scoped_lock lk{submit_mutex};
         mapped_queues[GfxQueueId].ccb_buffer_offset = 0;
@@ -1568,8 +1609,6 @@ public:
 
     void ReserveCopyBufferSpace() {
         GpuQueue& gfx_queue = mapped_queues[GfxQueueId];
-        std::scoped_lock<std::mutex> lk(gfx_queue.m_access);
-
         constexpr size_t GfxReservedSize = 2_MB >> 2;
         gfx_queue.ccb_buffer.reserve(GfxReservedSize);
         gfx_queue.dcb_buffer.reserve(GfxReservedSize);
@@ -1632,18 +1671,40 @@ private:
 
     void ProcessCommands();
     void Process(std::stop_token stoken);
+    void PushSubmit(u32 qid, Task::Handle handle);
+    bool PopSubmit(u32 qid);
+    u32 NextQueueId(int qid);
+
+    struct Submission {
+        Task::Handle handle{};
+        std::chrono::steady_clock::time_point submit_time{};
+    };
+
+    static constexpr size_t MaxPendingSubmits = 512;
 
     struct GpuQueue {
-        std::mutex m_access{};
         std::atomic<u32> dcb_buffer_offset;
         std::atomic<u32> ccb_buffer_offset;
         std::vector<u32> dcb_buffer;
         std::vector<u32> ccb_buffer;
-        std::queue<Task::Handle> submits{};
+        /// Filled by guest threads, drained only by the command processor thread.
+        Common::MPSCQueue<Submission, MaxPendingSubmits> submits;
+        /// Submissions that did not fit into `submits`. Once it is used every later submission
+        /// goes here as well until the processor has drained it, which keeps them in order.
+        std::mutex overflow_mutex;
+        std::queue<Submission> overflow;
+        std::atomic<bool> has_overflow{};
+        /// Task currently being executed, owned by the command processor thread.
+        Submission current{};
+        std::atomic<u32> depth{};
+        std::atomic<u32> max_depth{};
+        std::atomic<u64> num_submitted{};
+        std::atomic<u64> num_completed{};
+        std::atomic<u64> total_process_us{};
         ComputeProgram cs_state{};
     };
     std::array<GpuQueue, NumTotalQueues> mapped_queues{};
-    u32 num_mapped_queues{1u}; // GFX is always available
+    std::atomic<u32> num_mapped_queues{1u}; // GFX is always available
 
     VAddr indirect_args_addr{};
     u32 num_counter_pairs{};
@@ -1678,6 +1739,8 @@ private:
     std::queue<Common::UniqueFunction<void>> command_queue{};
     std::thread::id gpu_id;
     int curr_qid{-1};
+    u32 last_asc_qid{GfxQueueId};
+    u32 dirty_flags{DirtyAll};
 };
 
 static_assert(GFX6_3D_REG_INDEX(ps_program) == 0x2C08);
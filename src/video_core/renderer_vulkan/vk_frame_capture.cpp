@@ -0,0 +1,237 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <png.h>
+#include <xxhash.h>
+
+#include "common/config.h"
+#include "common/elf_info.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "video_core/renderer_vulkan/vk_frame_capture.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_platform.h"
+#include "video_core/renderer_vulkan/vk_presenter.h"
+
+#include <vk_mem_alloc.h>
+
+namespace Vulkan {
+
+constexpr u32 BytesPerPixel = 4;
+
+FrameCapture::FrameCapture(const Instance& instance_, u32 num_frames)
+    : instance{instance_}, readbacks(num_frames) {
+    const auto capture_mode = Config::getFrameCaptureMode();
+    if (capture_mode == "Hash") {
+        mode = Mode::Hash;
+    } else if (capture_mode == "Png") {
+        mode = Mode::Png;
+    }
+
+    const vk::PhysicalDevice physical_device = instance.GetPhysicalDevice();
+    const auto family_properties = physical_device.getQueueFamilyProperties();
+    const u32 valid_bits =
+        family_properties[instance.GetGraphicsQueueFamilyIndex()].timestampValidBits;
+    if (valid_bits != 0) {
+        timestamp_mask = valid_bits >= 64 ? ~u64{0} : (u64{1} << valid_bits) - 1;
+        timestamp_period = physical_device.getProperties().limits.timestampPeriod;
+        query_pool = Check<"create frame timestamp query pool">(
+            instance.GetDevice().createQueryPoolUnique(vk::QueryPoolCreateInfo{
+                .queryType = vk::QueryType::eTimestamp,
+                .queryCount = num_frames,
+            }));
+    } else {
+        LOG_WARNING(Render_Vulkan, "Graphics queue has no timestamps, GPU frame times disabled");
+    }
+
+    const auto serial = Common::ElfInfo::Instance().GameSerial();
+    capture_dir = Common::FS::GetUserPath(Common::FS::PathType::ScreenshotsDir) /
+                  (serial.empty() ? std::string{"headless"} : std::string{serial});
+    std::error_code ec;
+    std::filesystem::create_directories(capture_dir, ec);
+    const auto stats_path = capture_dir / "frames.csv";
+    if (stats_file.Open(stats_path, Common::FS::FileAccessMode::Write,
+                        Common::FS::FileType::TextFile) != 0) {
+        LOG_ERROR(Render_Vulkan, "Failed to open {} for frame stats", stats_path.string());
+        return;
+    }
+    stats_file.WriteString(std::string_view{"frame,cpu_ms,gpu_ms,hash\n"});
+    LOG_INFO(Render_Vulkan, "Running headless, frame stats go to {}", stats_path.string());
+}
+
+FrameCapture::~FrameCapture() {
+    if (num_resolved == 0) {
+        return;
+    }
+    LOG_INFO(Render_Vulkan, "Headless run: {} frames, average cpu {:.3f} ms, gpu {:.3f} ms",
+             num_resolved + 1, total_cpu_ms / num_resolved, total_gpu_ms / num_resolved);
+}
+
+void FrameCapture::Record(vk::CommandBuffer cmdbuf, const Frame& frame, bool measure) {
+    const vk::ImageSubresourceRange frame_subresources = {
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = VK_REMAINING_ARRAY_LAYERS,
+    };
+    const bool read_back = measure && mode != Mode::None;
+    Readback& readback = readbacks[frame.id];
+    if (read_back && (readback.width != frame.width || readback.height != frame.height)) {
+        ResizeReadback(readback, frame.width, frame.height);
+    }
+
+    const vk::ImageLayout release_layout =
+        read_back ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::eGeneral;
+    if (read_back) {
+        const vk::ImageMemoryBarrier2 pre_barrier = {
+            .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
+            .dstStageMask = vk::PipelineStageFlagBits2::eCopy,
+            .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+            .oldLayout = vk::ImageLayout::eGeneral,
+            .newLayout = vk::ImageLayout::eTransferSrcOptimal,
+            .image = frame.image,
+            .subresourceRange = frame_subresources,
+        };
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &pre_barrier,
+        });
+        cmdbuf.copyImageToBuffer(frame.image, vk::ImageLayout::eTransferSrcOptimal,
+                                 *readback.buffer,
+                                 vk::BufferImageCopy{
+                                     .imageSubresource{
+                                         .aspectMask = vk::ImageAspectFlagBits::eColor,
+                                         .mipLevel = 0,
+                                         .baseArrayLayer = 0,
+                                         .layerCount = 1,
+                                     },
+                                     .imageExtent = {frame.width, frame.height, 1},
+                                 });
+    }
+
+    const vk::BufferMemoryBarrier2 host_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eHost,
+        .dstAccessMask = vk::AccessFlagBits2::eHostRead,
+        .buffer = read_back ? vk::Buffer{*readback.buffer} : vk::Buffer{},
+        .size = VK_WHOLE_SIZE,
+    };
+    const vk::ImageMemoryBarrier2 post_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderRead,
+        .oldLayout = release_layout,
+        .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+        .image = frame.image,
+        .subresourceRange = frame_subresources,
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .bufferMemoryBarrierCount = read_back ? 1U : 0U,
+        .pBufferMemoryBarriers = &host_barrier,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &post_barrier,
+    });
+
+    if (!measure) {
+        return;
+    }
+    if (query_pool) {
+        cmdbuf.resetQueryPool(*query_pool, frame.id, 1);
+        cmdbuf.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, *query_pool, frame.id);
+    }
+    readback.frame_num = num_recorded++;
+    readback.cpu_time = Clock::now();
+}
+
+void FrameCapture::Resolve(const Frame& frame) {
+    const Readback& readback = readbacks[frame.id];
+
+    double cpu_ms = 0.0;
+    if (last_cpu_time) {
+        cpu_ms =
+            std::chrono::duration<double, std::milli>(readback.cpu_time - *last_cpu_time).count();
+    }
+    last_cpu_time = readback.cpu_time;
+
+    // The timestamp is taken once the frame finished rendering, so consecutive ones give the
+    // GPU frame time including any idle gaps.
+    double gpu_ms = 0.0;
+    if (query_pool) {
+        u64 timestamp{};
+        const auto result = instance.GetDevice().getQueryPoolResults(
+            *query_pool, frame.id, 1, sizeof(timestamp), &timestamp, sizeof(timestamp),
+            vk::QueryResultFlagBits::e64);
+        if (result == vk::Result::eSuccess) {
+            timestamp &= timestamp_mask;
+            if (last_gpu_timestamp) {
+                const u64 delta = (timestamp - *last_gpu_timestamp) & timestamp_mask;
+                gpu_ms = static_cast<double>(delta) * timestamp_period / 1'000'000.0;
+            }
+            last_gpu_timestamp = timestamp;
+        }
+    }
+
+    std::string hash;
+    if (mode != Mode::None) {
+        vmaInvalidateAllocation(instance.GetAllocator(), readback.buffer->allocation, 0,
+                                VK_WHOLE_SIZE);
+        const size_t size = size_t(readback.width) * readback.height * BytesPerPixel;
+        hash = fmt::format("{:016x}", XXH3_64bits(readback.data, size));
+        if (mode == Mode::Png) {
+            WritePng(readback);
+        }
+    }
+
+    LOG_DEBUG(Render_Vulkan, "Frame {}: cpu {:.3f} ms, gpu {:.3f} ms {}", readback.frame_num,
+              cpu_ms, gpu_ms, hash);
+    if (stats_file.IsOpen()) {
+        stats_file.WriteString(
+            fmt::format("{},{:.3f},{:.3f},{}\n", readback.frame_num, cpu_ms, gpu_ms, hash));
+    }
+    if (readback.frame_num > 0) {
+        total_cpu_ms += cpu_ms;
+        total_gpu_ms += gpu_ms;
+        ++num_resolved;
+    }
+}
+
+void FrameCapture::ResizeReadback(Readback& readback, u32 width, u32 height) {
+    const vk::BufferCreateInfo buffer_ci = {
+        .size = u64(width) * height * BytesPerPixel,
+        .usage = vk::BufferUsageFlagBits::eTransferDst,
+    };
+    VmaAllocationInfo alloc_info{};
+    readback.buffer.emplace(instance.GetDevice(), instance.GetAllocator());
+    readback.buffer->Create(buffer_ci, VideoCore::MemoryUsage::Download, &alloc_info);
+    readback.data = static_cast<u8*>(alloc_info.pMappedData);
+    readback.width = width;
+    readback.height = height;
+}
+
+void FrameCapture::WritePng(const Readback& readback) const {
+    // Frames are BGRA with undefined alpha, store them as plain RGB.
+    const size_t num_pixels = size_t(readback.width) * readback.height;
+    std::vector<u8> rgb(num_pixels * 3);
+    for (size_t i = 0; i < num_pixels; ++i) {
+        const u8* pixel = readback.data + i * BytesPerPixel;
+        rgb[i * 3 + 0] = pixel[2];
+        rgb[i * 3 + 1] = pixel[1];
+        rgb[i * 3 + 2] = pixel[0];
+    }
+
+    png_image image{};
+    image.version = PNG_IMAGE_VERSION;
+    image.width = readback.width;
+    image.height = readback.height;
+    image.format = PNG_FORMAT_RGB;
+    const auto path = capture_dir / fmt::format("frame_{:06}.png", readback.frame_num);
+    if (!png_image_write_to_file(&image, path.string().c_str(), 0, rgb.data(), 0, nullptr)) {
+        LOG_ERROR(Render_Vulkan, "Failed to write {}: {}", path.string(), image.message);
+    }
+}
+
+} // namespace Vulkan
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include "common/io_file.h"
+#include "common/types.h"
+#include "video_core/buffer_cache/buffer.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+class Instance;
+struct Frame;
+
+/**
+ * Measures the frames presented in headless mode and optionally reads them back to hash them
+ * or write them out as PNG. Results land in a per-game CSV inside the screenshots folder.
+ * PNGs are encoded on the presenting thread, so their CPU frame times are not representative.
+ */
+class FrameCapture {
+public:
+    /// Format of the headless frames, what the readback and PNG writer expect.
+    static constexpr vk::Format FrameFormat = vk::Format::eB8G8R8A8Unorm;
+
+    enum class Mode {
+        None,
+        Hash,
+        Png,
+    };
+
+    explicit FrameCapture(const Instance& instance, u32 num_frames);
+    ~FrameCapture();
+
+    /// Records the frame readback and its timestamp when measured, then releases the frame
+    /// to the shader read layout the windowed present leaves it in.
+    void Record(vk::CommandBuffer cmdbuf, const Frame& frame, bool measure);
+
+    /// Reports a measured frame. Its present fence must have been signaled.
+    void Resolve(const Frame& frame);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Readback {
+        std::optional<VideoCore::UniqueBuffer> buffer;
+        u8* data{};
+        u32 width{};
+        u32 height{};
+        u64 frame_num{};
+        Clock::time_point cpu_time{};
+    };
+
+    void ResizeReadback(Readback& readback, u32 width, u32 height);
+
+    void WritePng(const Readback& readback) const;
+
+private:
+    const Instance& instance;
+    Mode mode{Mode::None};
+    std::vector<Readback> readbacks;
+    vk::UniqueQueryPool query_pool;
+    double timestamp_period{};
+    u64 timestamp_mask{};
+    u64 num_recorded{};
+    std::optional<Clock::time_point> last_cpu_time;
+    std::optional<u64> last_gpu_timestamp;
+    double total_cpu_ms{};
+    double total_gpu_ms{};
+    u64 num_resolved{};
+    std::filesystem::path capture_dir;
+    Common::FS::IOFile stats_file;
+};
+
+} // namespace Vulkan
@@ -7,6 +7,7 @@
 #include <boost/container/static_vector.hpp>
 
 #include "common/assert.h"
+#include "common/thread_worker.h"
 #include "shader_recompiler/backend/spirv/emit_spirv_quad_rect.h"
 #include "shader_recompiler/frontend/fetch_shader.h"
 #include "video_core/amdgpu/resource.h"
@@ -43,12 +44,12 @@ GraphicsPipeline::GraphicsPipeline(
     vk::PipelineCache pipeline_cache, std::span<const Shader::Info*, MaxShaderStages> infos,
     std::span<const Shader::RuntimeInfo, MaxShaderStages> runtime_infos,
     std::optional<const Shader::Gcn::FetchShaderData> fetch_shader_,
-    std::span<const vk::ShaderModule> modules)
+    std::span<const vk::ShaderModule> modules, Common::ThreadWorker* worker)
     : Pipeline{instance, scheduler, desc_heap, profile, pipeline_cache}, key{key_},
       fetch_shader{std::move(fetch_shader_)} {
     const vk::Device device = instance.GetDevice();
     std::ranges::copy(infos, stages.begin());
-    BuildDescSetLayout();
+    const auto bindings = BuildDescSetLayout();
     const auto debug_str = GetDebugString();
 
     const vk::PushConstantRange push_constants = {
@@ -69,16 +70,42 @@ GraphicsPipeline::GraphicsPipeline(
                "Failed to create graphics pipeline layout: {}", vk::to_string(layout_result));
     pipeline_layout = std::move(layout);
     SetObjectName(device, *pipeline_layout, "Graphics PipelineLayout {}", debug_str);
+    CreateDescriptorTemplate(bindings);
 
-    VertexInputs<vk::VertexInputAttributeDescription> vertex_attributes;
-    VertexInputs<vk::VertexInputBindingDescription> vertex_bindings;
-    VertexInputs<vk::VertexInputBindingDivisorDescriptionEXT> divisors;
-    VertexInputs<AmdGpu::Buffer> guest_buffers;
+    // Everything that reads guest state (sharps, runtime info) is captured here, so the pipeline
+    // itself may be created on a worker thread while the command processor keeps going.
+    BuildState state{
+        .pipeline_cache = pipeline_cache,
+        .fs_info = runtime_infos[u32(Shader::LogicalStage::Fragment)].fs_info,
+    };
+    std::ranges::copy(modules, state.modules.begin());
     if (!instance.IsVertexInputDynamicState()) {
         const auto& vs_info = runtime_infos[u32(Shader::LogicalStage::Vertex)].vs_info;
-        GetVertexInputs(vertex_attributes, vertex_bindings, divisors, guest_buffers,
-                        vs_info.step_rate_0, vs_info.step_rate_1);
+        VertexInputs<AmdGpu::Buffer> guest_buffers;
+        GetVertexInputs(state.vertex_attributes, state.vertex_bindings, state.divisors,
+                        guest_buffers, vs_info.step_rate_0, vs_info.step_rate_1);
+    }
+
+    if (!worker) {
+        Build(state, debug_str);
+        return;
     }
+    worker->QueueWork([this, state = std::move(state), debug_str] {
+        Build(state, debug_str);
+    });
+}
+
+GraphicsPipeline::~GraphicsPipeline() {
+    // A pipeline still being built on a worker references this object.
+    is_ready.wait(false, std::memory_order_acquire);
+}
+
+void GraphicsPipeline::Build(const BuildState& state, const std::string& debug_str) {
+    const vk::Device device = instance.GetDevice();
+    const auto& vertex_attributes = state.vertex_attributes;
+    const auto& vertex_bindings = state.vertex_bindings;
+    const auto& divisors = state.divisors;
+    const auto& modules = state.modules;
 
     const vk::PipelineVertexInputDivisorStateCreateInfo divisor_state = {
         .vertexBindingDivisorCount = static_cast<u32>(divisors.size()),
@@ -104,7 +131,7 @@ GraphicsPipeline::GraphicsPipeline(
 
     const bool is_rect_list = key.prim_type == AmdGpu::PrimitiveType::RectList;
     const bool is_quad_list = key.prim_type == AmdGpu::PrimitiveType::QuadList;
-    const auto& fs_info = runtime_infos[u32(Shader::LogicalStage::Fragment)].fs_info;
+    const auto& fs_info = state.fs_info;
     const vk::PipelineTessellationStateCreateInfo tessellation_state = {
         .patchControlPoints = is_rect_list ? 3U : (is_quad_list ? 4U : key.patch_control_points),
     };
@@ -185,7 +212,7 @@ GraphicsPipeline::GraphicsPipeline(
     boost::container::static_vector<vk::PipelineShaderStageCreateInfo, MaxShaderStages>
         shader_stages;
     auto stage = u32(Shader::LogicalStage::Vertex);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eVertex,
             .module = modules[stage],
@@ -193,7 +220,7 @@ GraphicsPipeline::GraphicsPipeline(
         });
     }
     stage = u32(Shader::LogicalStage::Geometry);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eGeometry,
             .module = modules[stage],
@@ -201,7 +228,7 @@ GraphicsPipeline::GraphicsPipeline(
         });
     }
     stage = u32(Shader::LogicalStage::TessellationControl);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eTessellationControl,
             .module = modules[stage],
@@ -217,7 +244,7 @@ GraphicsPipeline::GraphicsPipeline(
         });
     }
     stage = u32(Shader::LogicalStage::TessellationEval);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eTessellationEvaluation,
             .module = modules[stage],
@@ -233,7 +260,7 @@ GraphicsPipeline::GraphicsPipeline(
         });
     }
     stage = u32(Shader::LogicalStage::Fragment);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eFragment,
             .module = modules[stage],
@@ -377,14 +404,15 @@ GraphicsPipeline::GraphicsPipeline(
     };
 
     auto [pipeline_result, pipe] =
-        device.createGraphicsPipelineUnique(pipeline_cache, pipeline_info);
+        device.createGraphicsPipelineUnique(state.pipeline_cache, pipeline_info);
     ASSERT_MSG(pipeline_result == vk::Result::eSuccess, "Failed to create graphics pipeline: {}",
                vk::to_string(pipeline_result));
     pipeline = std::move(pipe);
     SetObjectName(device, *pipeline, "Graphics Pipeline {}", debug_str);
-}
 
-GraphicsPipeline::~GraphicsPipeline() = default;
+    is_ready.store(true, std::memory_order_release);
+    is_ready.notify_all();
+}
 
 template <typename Attribute, typename Binding>
 void GraphicsPipeline::GetVertexInputs(
@@ -438,8 +466,8 @@ template void GraphicsPipeline::GetVertexInputs(
     VertexInputs<vk::VertexInputBindingDivisorDescriptionEXT>& divisors,
     VertexInputs<AmdGpu::Buffer>& guest_buffers, u32 step_rate_0, u32 step_rate_1) const;
 
-void GraphicsPipeline::BuildDescSetLayout() {
-    boost::container::small_vector<vk::DescriptorSetLayoutBinding, 32> bindings;
+Pipeline::DescriptorBindings GraphicsPipeline::BuildDescSetLayout() {
+    DescriptorBindings bindings;
     u32 binding{};
 
     for (const auto* stage : stages) {
@@ -490,6 +518,7 @@ void GraphicsPipeline::BuildDescSetLayout() {
     ASSERT_MSG(layout_result == vk::Result::eSuccess,
                "Failed to create graphics descriptor set layout: {}", vk::to_string(layout_result));
     desc_layout = std::move(layout);
+    return bindings;
 }
 
 } // namespace Vulkan
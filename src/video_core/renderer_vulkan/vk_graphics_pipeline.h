@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/container/static_vector.hpp>
 #include <xxhash.h>
 
@@ -12,6 +13,10 @@
 #include "video_core/renderer_vulkan/vk_common.h"
 #include "video_core/renderer_vulkan/vk_pipeline_common.h"
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace VideoCore {
 class BufferCache;
 class TextureCache;
@@ -75,9 +80,15 @@ public:
                      std::span<const Shader::Info*, MaxShaderStages> stages,
                      std::span<const Shader::RuntimeInfo, MaxShaderStages> runtime_infos,
                      std::optional<const Shader::Gcn::FetchShaderData> fetch_shader,
-                     std::span<const vk::ShaderModule> modules);
+                     std::span<const vk::ShaderModule> modules,
+                     Common::ThreadWorker* worker = nullptr);
     ~GraphicsPipeline();
 
+    /// Returns true once the pipeline object has been created and can be bound.
+    bool IsReady() const noexcept {
+        return is_ready.load(std::memory_order_acquire);
+    }
+
     const std::optional<const Shader::Gcn::FetchShaderData>& GetFetchShader() const noexcept {
         return fetch_shader;
     }
@@ -94,11 +105,22 @@ public:
                          u32 step_rate_1) const;
 
 private:
-    void BuildDescSetLayout();
+    struct BuildState {
+        vk::PipelineCache pipeline_cache;
+        Shader::FragmentRuntimeInfo fs_info;
+        std::array<vk::ShaderModule, MaxShaderStages> modules{};
+        VertexInputs<vk::VertexInputAttributeDescription> vertex_attributes;
+        VertexInputs<vk::VertexInputBindingDescription> vertex_bindings;
+        VertexInputs<vk::VertexInputBindingDivisorDescriptionEXT> divisors;
+    };
+
+    DescriptorBindings BuildDescSetLayout();
+    void Build(const BuildState& state, const std::string& debug_str);
 
 private:
     GraphicsPipelineKey key;
     std::optional<const Shader::Gcn::FetchShaderData> fetch_shader{};
+    std::atomic<bool> is_ready{};
 };
 
 } // namespace Vulkan
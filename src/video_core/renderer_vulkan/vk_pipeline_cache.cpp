@@ -1,17 +1,24 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <cstdlib>
 #include <ranges>
+#include <xxhash.h>
 
 #include "common/config.h"
+#include "common/div_ceil.h"
+#include "common/elf_info.h"
 #include "common/hash.h"
 #include "common/io_file.h"
 #include "common/path_util.h"
+#include "common/thread_worker.h"
 #include "core/debug_state.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
 #include "shader_recompiler/info.h"
 #include "shader_recompiler/recompiler.h"
 #include "shader_recompiler/runtime_info.h"
+#include "shader_recompiler/shader_dump.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
 #include "video_core/renderer_vulkan/vk_presenter.h"
@@ -28,6 +35,24 @@ using Shader::Stage;
 
 constexpr static auto SpirvVersion1_6 = 0x00010600U;
 
+constexpr static u32 PipelineCacheMagic = 0x43505653; // "SVPC"
+constexpr static u32 PipelineCacheVersion = 1;
+
+/// Header prepended to the driver pipeline cache blob. The driver validates its own data as well,
+/// but some implementations crash on truncated or foreign blobs, so we reject those up front.
+struct PipelineCacheHeader {
+    u32 magic;
+    u32 version;
+    u32 vendor_id;
+    u32 device_id;
+    u32 driver_version;
+    std::array<u8, VK_UUID_SIZE> uuid;
+    u64 data_size;
+    u64 data_hash;
+};
+
+static PipelineCache* g_active_pipeline_cache{};
+
 constexpr static std::array DescriptorHeapSizes = {
     vk::DescriptorPoolSize{vk::DescriptorType::eUniformBuffer, 512},
     vk::DescriptorPoolSize{vk::DescriptorType::eStorageBuffer, 8192},
@@ -268,26 +293,78 @@ PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
         .max_viewport_height = instance.GetMaxViewportHeight(),
         .max_shared_memory_size = instance.MaxComputeSharedMemorySize(),
     };
-    auto [cache_result, cache] = instance.GetDevice().createPipelineCacheUnique({});
+
+    const auto initial_data = LoadPipelineCache();
+    const vk::PipelineCacheCreateInfo cache_ci = {
+        .initialDataSize = initial_data.size(),
+        .pInitialData = initial_data.data(),
+    };
+    auto [cache_result, cache] = instance.GetDevice().createPipelineCacheUnique(cache_ci);
     ASSERT_MSG(cache_result == vk::Result::eSuccess, "Failed to create pipeline cache: {}",
                vk::to_string(cache_result));
     pipeline_cache = std::move(cache);
+
+    if (Config::asyncShaderCompile()) {
+        const u32 num_workers = std::max(std::thread::hardware_concurrency() / 4, 1U);
+        LOG_INFO(Render_Vulkan, "Compiling pipelines asynchronously on {} workers", num_workers);
+        compile_worker = std::make_unique<Common::ThreadWorker>(num_workers, "PipelineCompiler");
+    }
+
+    // The emulator leaves through std::quick_exit, so destructors are not guaranteed to run.
+    // The GPU thread is still running at that point, Shutdown stops it from compiling more.
+    if (Config::pipelineCacheEnable()) {
+        static bool exit_handler_registered = false;
+        g_active_pipeline_cache = this;
+        if (!std::exchange(exit_handler_registered, true)) {
+            std::at_quick_exit([] {
+                if (g_active_pipeline_cache) {
+                    g_active_pipeline_cache->Shutdown();
+                }
+            });
+        }
+    }
+}
+
+PipelineCache::~PipelineCache() {
+    Shutdown();
+    if (g_active_pipeline_cache == this) {
+        g_active_pipeline_cache = nullptr;
+    }
 }
 
-PipelineCache::~PipelineCache() = default;
+void PipelineCache::Shutdown() {
+    {
+        std::scoped_lock lk{compile_mutex};
+        if (std::exchange(is_shut_down, true)) {
+            return;
+        }
+    }
+    // Nothing new can be queued now. Let the queued builds finish writing to the driver cache
+    // before its data is read back.
+    compile_worker.reset();
+    SavePipelineCache();
+}
 
 const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
     if (!RefreshGraphicsKey()) {
         return nullptr;
     }
+    if (last_graphics_pipeline && graphics_key == last_graphics_key) {
+        return last_graphics_pipeline->IsReady() ? last_graphics_pipeline : nullptr;
+    }
     const auto [it, is_new] = graphics_pipelines.try_emplace(graphics_key);
     if (is_new) {
+        std::scoped_lock lk{compile_mutex};
+        if (is_shut_down) {
+            graphics_pipelines.erase(it);
+            return nullptr;
+        }
         const auto pipeline_hash = std::hash<GraphicsPipelineKey>{}(graphics_key);
         LOG_INFO(Render_Vulkan, "Compiling graphics pipeline {:#x}", pipeline_hash);
 
-        it.value() = std::make_unique<GraphicsPipeline>(instance, scheduler, desc_heap, profile,
-                                                        graphics_key, *pipeline_cache, infos,
-                                                        runtime_infos, fetch_shader, modules);
+        it.value() = std::make_unique<GraphicsPipeline>(
+            instance, scheduler, desc_heap, profile, graphics_key, *pipeline_cache, infos,
+            runtime_infos, fetch_shader, modules, compile_worker.get());
         if (Config::collectShadersForDebug()) {
             for (auto stage = 0; stage < MaxShaderStages; ++stage) {
                 if (infos[stage]) {
@@ -297,7 +374,10 @@ const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
             }
         }
     }
-    return it->second.get();
+    last_graphics_key = graphics_key;
+    last_graphics_pipeline = it->second.get();
+    // Skip draws until an asynchronously compiled pipeline becomes available.
+    return last_graphics_pipeline->IsReady() ? last_graphics_pipeline : nullptr;
 }
 
 const ComputePipeline* PipelineCache::GetComputePipeline() {
@@ -306,6 +386,11 @@ const ComputePipeline* PipelineCache::GetComputePipeline() {
     }
     const auto [it, is_new] = compute_pipelines.try_emplace(compute_key);
     if (is_new) {
+        std::scoped_lock lk{compile_mutex};
+        if (is_shut_down) {
+            compute_pipelines.erase(it);
+            return nullptr;
+        }
         const auto pipeline_hash = std::hash<ComputePipelineKey>{}(compute_key);
         LOG_INFO(Render_Vulkan, "Compiling compute pipeline {:#x}", pipeline_hash);
 
@@ -321,57 +406,82 @@ const ComputePipeline* PipelineCache::GetComputePipeline() {
 }
 
 bool PipelineCache::RefreshGraphicsKey() {
-    std::memset(&graphics_key, 0, sizeof(GraphicsPipelineKey));
     const auto& regs = liverpool->regs;
     auto& key = graphics_key;
 
+    graphics_key_dirty |= liverpool->ConsumeDirtyFlags();
+    const u32 dirty = graphics_key_dirty;
+    DebugState.CountPipelineKeyRefresh(dirty != 0);
+
     const bool db_enabled = regs.depth_buffer.DepthValid() || regs.depth_buffer.StencilValid();
 
-    key.z_format = regs.depth_buffer.DepthValid() ? regs.depth_buffer.z_info.format.Value()
-                                                  : Liverpool::DepthBuffer::ZFormat::Invalid;
-    key.stencil_format = regs.depth_buffer.StencilValid()
-                             ? regs.depth_buffer.stencil_info.format.Value()
-                             : Liverpool::DepthBuffer::StencilFormat::Invalid;
-    key.depth_clamp_enable = !regs.depth_render_override.disable_viewport_clamp;
-    key.depth_clip_enable = regs.clipper_control.ZclipEnable();
-    key.clip_space = regs.clipper_control.clip_space;
-    key.provoking_vtx_last = regs.polygon_control.provoking_vtx_last;
-    key.prim_type = regs.primitive_type;
-    key.polygon_mode = regs.polygon_control.PolyMode();
-    key.patch_control_points =
-        regs.stage_enable.hs_en ? regs.ls_hs_config.hs_input_control_points.Value() : 0;
-    key.logic_op = regs.color_control.rop3;
-    key.depth_samples = db_enabled ? regs.depth_buffer.NumSamples() : 1;
-    key.num_samples = key.depth_samples;
-    key.cb_shader_mask = regs.color_shader_mask;
+    if (dirty & Liverpool::DirtyDepthTarget) {
+        key.z_format = regs.depth_buffer.DepthValid() ? regs.depth_buffer.z_info.format.Value()
+                                                      : Liverpool::DepthBuffer::ZFormat::Invalid;
+        key.stencil_format = regs.depth_buffer.StencilValid()
+                                 ? regs.depth_buffer.stencil_info.format.Value()
+                                 : Liverpool::DepthBuffer::StencilFormat::Invalid;
+        key.depth_samples = db_enabled ? regs.depth_buffer.NumSamples() : 1;
+    }
+    if (dirty & Liverpool::DirtyRasterState) {
+        key.depth_clamp_enable = !regs.depth_render_override.disable_viewport_clamp;
+        key.depth_clip_enable = regs.clipper_control.ZclipEnable();
+        key.clip_space = regs.clipper_control.clip_space;
+        key.provoking_vtx_last = regs.polygon_control.provoking_vtx_last;
+        key.prim_type = regs.primitive_type;
+        key.polygon_mode = regs.polygon_control.PolyMode();
+        key.patch_control_points =
+            regs.stage_enable.hs_en ? regs.ls_hs_config.hs_input_control_points.Value() : 0;
+        key.logic_op = regs.color_control.rop3;
+        key.cb_shader_mask = regs.color_shader_mask;
+    }
 
     const bool skip_cb_binding =
         regs.color_control.mode == AmdGpu::Liverpool::ColorControl::OperationMode::Disable;
 
     // First pass to fill render target information needed by shader recompiler
-    for (s32 cb = 0; cb < Liverpool::NumColorBuffers && !skip_cb_binding; ++cb) {
-        const auto& col_buf = regs.color_buffers[cb];
-        if (!col_buf || !regs.color_target_mask.GetMask(cb)) {
-            // No attachment bound or writing to it is disabled.
-            continue;
-        }
+    if (dirty & Liverpool::DirtyColorTargets) {
+        color_targets = {};
+        for (s32 cb = 0; cb < Liverpool::NumColorBuffers && !skip_cb_binding; ++cb) {
+            const auto& col_buf = regs.color_buffers[cb];
+            if (!col_buf || !regs.color_target_mask.GetMask(cb)) {
+                // No attachment bound or writing to it is disabled.
+                continue;
+            }
 
-        // Fill color target information
-        key.color_buffers[cb] = Shader::PsColorBuffer{
-            .data_format = col_buf.GetDataFmt(),
-            .num_format = col_buf.GetNumberFmt(),
-            .num_conversion = col_buf.GetNumberConversion(),
-            .export_format = regs.color_export_format.GetFormat(cb),
-            .swizzle = col_buf.Swizzle(),
-        };
+            // Fill color target information
+            color_targets[cb] = Shader::PsColorBuffer{
+                .data_format = col_buf.GetDataFmt(),
+                .num_format = col_buf.GetNumberFmt(),
+                .num_conversion = col_buf.GetNumberConversion(),
+                .export_format = regs.color_export_format.GetFormat(cb),
+                .swizzle = col_buf.Swizzle(),
+            };
+        }
     }
+    key.color_buffers = color_targets;
 
-    // Compile and bind shader stages
+    // Compile and bind shader stages. They depend on user data and guest memory as well as
+    // registers, so they are looked up on every draw.
+    key.stage_hashes = {};
+    key.vertex_buffer_formats = {};
     if (!RefreshGraphicsStages()) {
         return false;
     }
 
+    // The rest only changes with the targets or the set of outputs the fragment shader writes.
+    if (!(dirty & (Liverpool::DirtyDepthTarget | Liverpool::DirtyColorTargets)) &&
+        key.mrt_mask == masked_mrt_mask) {
+        key.color_buffers = masked_color_targets;
+        graphics_key_dirty = 0;
+        return true;
+    }
+
     // Second pass to mask out render targets not written by shader and fill remaining info
+    key.blend_controls = {};
+    key.write_masks = {};
+    key.color_samples = {};
+    key.num_samples = key.depth_samples;
     u8 color_samples = 0;
     bool all_color_samples_same = true;
     for (s32 cb = 0; cb < key.num_color_attachments && !skip_cb_binding; ++cb) {
@@ -411,6 +521,9 @@ bool PipelineCache::RefreshGraphicsKey() {
         }
     }
 
+    masked_color_targets = key.color_buffers;
+    masked_mrt_mask = key.mrt_mask;
+    graphics_key_dirty = 0;
     return true;
 }
 
@@ -532,9 +645,39 @@ vk::ShaderModule PipelineCache::CompileModule(Shader::Info& info, Shader::Runtim
              perm_idx != 0 ? "(permutation)" : "");
     DumpShader(code, info.pgm_hash, info.stage, perm_idx, "bin");
 
-    const auto ir_program = Shader::TranslateProgram(code, pools, info, runtime_info, profile);
+    // Translation modifies the runtime info, the dump needs it as it was given.
+    std::optional<Shader::RuntimeInfo> dump_runtime_info;
+    if (Config::dumpShaders()) {
+        dump_runtime_info = runtime_info;
+    }
+
+    // Timing every pass is only worth it when someone reads the numbers.
+    const bool collect_stats =
+        Common::Log::CanLog(Common::Log::Class::Render_Vulkan, Common::Log::Level::Debug);
+    auto& pools = Shader::GetThreadPools();
+    Shader::TranslateStats stats;
+    const auto ir_program = Shader::TranslateProgram(code, pools, info, runtime_info, profile,
+                                                     collect_stats ? &stats : nullptr);
+    const auto emit_start = collect_stats ? std::chrono::steady_clock::now()
+                                          : std::chrono::steady_clock::time_point{};
     auto spv = Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, ir_program, binding);
+    if (collect_stats) {
+        const auto emit_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - emit_start)
+                                 .count();
+        LOG_DEBUG(Render_Vulkan,
+                  "Shader {:#x}: {} GCN -> {} IR instructions -> {} SPIR-V bytes, translate "
+                  "{}us, emit {}us",
+                  info.pgm_hash, stats.num_gcn_insts, stats.num_ir_insts,
+                  spv.size() * sizeof(u32), stats.TotalUs(), emit_us);
+        for (const auto& [step, us] : stats.step_us) {
+            LOG_TRACE(Render_Vulkan, "  {}: {}us", step, us);
+        }
+    }
     DumpShader(spv, info.pgm_hash, info.stage, perm_idx, "spv");
+    if (dump_runtime_info) {
+        DumpShaderContext(info, *dump_runtime_info, perm_idx);
+    }
 
     vk::ShaderModule module;
 
@@ -596,6 +739,10 @@ PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stag
 
 std::optional<vk::ShaderModule> PipelineCache::ReplaceShader(vk::ShaderModule module,
                                                              std::span<const u32> spv_code) {
+    if (compile_worker) {
+        // Pending pipeline builds may still reference the module being destroyed.
+        compile_worker->WaitForRequests();
+    }
     std::optional<vk::ShaderModule> new_module{};
     for (const auto& [_, program] : program_cache) {
         for (auto& m : program->modules) {
@@ -608,6 +755,7 @@ std::optional<vk::ShaderModule> PipelineCache::ReplaceShader(vk::ShaderModule mo
         }
     }
     if (module_related_pipelines.contains(module)) {
+        last_graphics_pipeline = nullptr;
         auto& pipeline_keys = module_related_pipelines[module];
         for (auto& key : pipeline_keys) {
             if (std::holds_alternative<GraphicsPipelineKey>(key)) {
@@ -646,6 +794,132 @@ void PipelineCache::DumpShader(std::span<const u32> code, u64 hash, Shader::Stag
     file.WriteSpan(code);
 }
 
+void PipelineCache::DumpShaderContext(const Shader::Info& info,
+                                      const Shader::RuntimeInfo& runtime_info, size_t perm_idx) {
+    Shader::ShaderDumpContext context{};
+    auto& header = context.header;
+    header.stage = info.stage;
+    header.l_stage = info.l_stage;
+    header.hash = info.pgm_hash;
+    std::ranges::copy(info.user_data, header.user_data.begin());
+    header.runtime_info = runtime_info;
+    header.profile = profile;
+    header.direct_memory_access = Config::directMemoryAccess();
+    context.flat_buf = info.flattened_ud_buf;
+    if (const auto fetch_data = Shader::Gcn::ParseFetchShader(info)) {
+        header.fetch_shader_sgpr_base = info.fetch_shader_sgpr_base;
+        context.fetch_code.assign(fetch_data->code,
+                                  fetch_data->code + Common::DivCeil(fetch_data->size, 4U));
+    }
+    if (info.stage == Shader::Stage::Geometry) {
+        context.copy_code.assign(runtime_info.gs_info.vs_copy.begin(),
+                                 runtime_info.gs_info.vs_copy.end());
+    }
+
+    using namespace Common::FS;
+    const auto dump_dir = GetUserPath(PathType::ShaderDir) / "dumps";
+    const auto filename = fmt::format("{}.ctx", GetShaderName(info.stage, info.pgm_hash, perm_idx));
+    if (!context.Save(dump_dir / filename)) {
+        LOG_ERROR(Render_Vulkan, "Failed to dump translation inputs of shader {:#x}",
+                  info.pgm_hash);
+    }
+}
+
+std::filesystem::path PipelineCache::GetPipelineCachePath() const {
+    using namespace Common::FS;
+    const auto serial = Common::ElfInfo::Instance().GameSerial();
+    return GetUserPath(PathType::ShaderDir) / "cache" / fmt::format("{}.bin", serial);
+}
+
+std::vector<u8> PipelineCache::LoadPipelineCache() {
+    if (!Config::pipelineCacheEnable()) {
+        return {};
+    }
+
+    using namespace Common::FS;
+    const auto cache_path = GetPipelineCachePath();
+    if (!std::filesystem::exists(cache_path)) {
+        return {};
+    }
+    const auto file = IOFile{cache_path, FileAccessMode::Read};
+    PipelineCacheHeader header{};
+    if (!file.IsOpen() || !file.ReadObject(header)) {
+        LOG_WARNING(Render_Vulkan, "Failed to read pipeline cache header from {}",
+                    PathToUTF8String(cache_path));
+        return {};
+    }
+    if (header.magic != PipelineCacheMagic || header.version != PipelineCacheVersion ||
+        header.vendor_id != instance.GetVendorID() || header.device_id != instance.GetDeviceID() ||
+        header.driver_version != instance.GetDriverVersion() ||
+        header.uuid != instance.GetPipelineCacheUUID() ||
+        header.data_size != file.GetSize() - sizeof(PipelineCacheHeader)) {
+        LOG_INFO(Render_Vulkan, "Pipeline cache is stale or was created by another device, "
+                                "discarding it");
+        return {};
+    }
+
+    std::vector<u8> data(header.data_size);
+    if (file.Read(data) != data.size() || XXH3_64bits(data.data(), data.size()) != header.data_hash) {
+        LOG_WARNING(Render_Vulkan, "Pipeline cache is corrupted, discarding it");
+        return {};
+    }
+    LOG_INFO(Render_Vulkan, "Loaded {} KiB of pipeline cache data", data.size() / 1024);
+    return data;
+}
+
+void PipelineCache::SavePipelineCache() {
+    if (!Config::pipelineCacheEnable() || !pipeline_cache) {
+        return;
+    }
+
+    const auto [result, data] = instance.GetDevice().getPipelineCacheData(*pipeline_cache);
+    if (result != vk::Result::eSuccess) {
+        LOG_WARNING(Render_Vulkan, "Failed to retrieve pipeline cache data: {}",
+                    vk::to_string(result));
+        return;
+    }
+    if (data.empty()) {
+        return;
+    }
+
+    using namespace Common::FS;
+    const auto cache_path = GetPipelineCachePath();
+    const auto cache_dir = cache_path.parent_path();
+    if (!std::filesystem::exists(cache_dir)) {
+        std::filesystem::create_directories(cache_dir);
+    }
+
+    const PipelineCacheHeader header = {
+        .magic = PipelineCacheMagic,
+        .version = PipelineCacheVersion,
+        .vendor_id = instance.GetVendorID(),
+        .device_id = instance.GetDeviceID(),
+        .driver_version = instance.GetDriverVersion(),
+        .uuid = instance.GetPipelineCacheUUID(),
+        .data_size = data.size(),
+        .data_hash = XXH3_64bits(data.data(), data.size()),
+    };
+
+    // Write to a temporary file first so an interrupted save never leaves a truncated cache.
+    auto temp_path = cache_path;
+    temp_path += ".tmp";
+    {
+        const auto file = IOFile{temp_path, FileAccessMode::Write};
+        if (!file.IsOpen() || !file.WriteObject(header) || file.Write(data) != data.size()) {
+            LOG_WARNING(Render_Vulkan, "Failed to write pipeline cache to {}",
+                        PathToUTF8String(temp_path));
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, cache_path, ec);
+    if (ec) {
+        LOG_WARNING(Render_Vulkan, "Failed to replace pipeline cache: {}", ec.message());
+        return;
+    }
+    LOG_INFO(Render_Vulkan, "Saved {} KiB of pipeline cache data", data.size() / 1024);
+}
+
 std::optional<std::vector<u32>> PipelineCache::GetShaderPatch(u64 hash, Shader::Stage stage,
                                                               size_t perm_idx,
                                                               std::string_view ext) {
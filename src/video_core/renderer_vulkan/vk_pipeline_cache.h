@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <filesystem>
+#include <mutex>
 #include <variant>
 #include <tsl/robin_map.h>
 #include "shader_recompiler/profile.h"
@@ -19,6 +21,10 @@ struct std::hash<vk::ShaderModule> {
     }
 };
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace Shader {
 struct Info;
 }
@@ -72,6 +78,15 @@ public:
         return profile;
     }
 
+    /// Lets queued pipeline builds finish, stops the compile workers and saves the pipeline
+    /// cache. Pipelines requested afterwards are not built. Safe to call while the GPU thread
+    /// still draws, and only the first call does anything.
+    void Shutdown();
+
+    /// Writes the driver pipeline cache blob to disk so the next run can reuse it. Only the
+    /// driver's data is kept; translated shaders and pipeline keys are rebuilt every run.
+    void SavePipelineCache();
+
 private:
     bool RefreshGraphicsKey();
     bool RefreshGraphicsStages();
@@ -79,6 +94,9 @@ private:
 
     void DumpShader(std::span<const u32> code, u64 hash, Shader::Stage stage, size_t perm_idx,
                     std::string_view ext);
+    /// Saves what translating the shader needed besides its code, for offline replay.
+    void DumpShaderContext(const Shader::Info& info, const Shader::RuntimeInfo& runtime_info,
+                           size_t perm_idx);
     std::optional<std::vector<u32>> GetShaderPatch(u64 hash, Shader::Stage stage, size_t perm_idx,
                                                    std::string_view ext);
     vk::ShaderModule CompileModule(Shader::Info& info, Shader::RuntimeInfo& runtime_info,
@@ -86,6 +104,9 @@ private:
                                    Shader::Backend::Bindings& binding);
     const Shader::RuntimeInfo& BuildRuntimeInfo(Shader::Stage stage, Shader::LogicalStage l_stage);
 
+    std::filesystem::path GetPipelineCachePath() const;
+    std::vector<u8> LoadPipelineCache();
+
 private:
     const Instance& instance;
     Scheduler& scheduler;
@@ -94,10 +115,14 @@ private:
     vk::UniquePipelineCache pipeline_cache;
     vk::UniquePipelineLayout pipeline_layout;
     Shader::Profile profile{};
-    Shader::Pools pools;
     tsl::robin_map<size_t, std::unique_ptr<Program>> program_cache;
     tsl::robin_map<ComputePipelineKey, std::unique_ptr<ComputePipeline>> compute_pipelines;
     tsl::robin_map<GraphicsPipelineKey, std::unique_ptr<GraphicsPipeline>> graphics_pipelines;
+    // Declared after the pipeline maps so pending builds finish before pipelines are destroyed.
+    std::unique_ptr<Common::ThreadWorker> compile_worker;
+    // Held while a pipeline is created, so shutdown never races a build or its submission.
+    std::mutex compile_mutex;
+    bool is_shut_down{};
     std::array<Shader::RuntimeInfo, MaxShaderStages> runtime_infos{};
     std::array<const Shader::Info*, MaxShaderStages> infos{};
     std::array<vk::ShaderModule, MaxShaderStages> modules{};
@@ -105,6 +130,16 @@ private:
     GraphicsPipelineKey graphics_key{};
     ComputePipelineKey compute_key{};
 
+    // Register groups of the graphics key left to rebuild, kept until a refresh completes.
+    u32 graphics_key_dirty{Liverpool::DirtyAll};
+    // Color targets as set in registers, and after masking with the fragment shader outputs.
+    std::array<Shader::PsColorBuffer, Liverpool::NumColorBuffers> color_targets{};
+    std::array<Shader::PsColorBuffer, Liverpool::NumColorBuffers> masked_color_targets{};
+    u32 masked_mrt_mask{};
+    // Consecutive draws mostly share a pipeline, so keep it around without hashing the key.
+    GraphicsPipelineKey last_graphics_key{};
+    const GraphicsPipeline* last_graphics_pipeline{};
+
     // Only if Config::collectShadersForDebug()
     tsl::robin_map<vk::ShaderModule,
                    std::vector<std::variant<GraphicsPipelineKey, ComputePipelineKey>>>
@@ -1,8 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
-#include <boost/container/static_vector.hpp>
+#include <xxhash.h>
 
+#include "common/assert.h"
 #include "shader_recompiler/info.h"
 #include "video_core/buffer_cache/buffer_cache.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
@@ -21,7 +22,8 @@ Pipeline::Pipeline(const Instance& instance_, Scheduler& scheduler_, DescriptorH
 
 Pipeline::~Pipeline() = default;
 
-void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers& buffer_barriers,
+void Pipeline::BindResources(const DescriptorData& descriptors,
+                             const BufferBarriers& buffer_barriers,
                              const Shader::PushData& push_data) const {
     const auto cmdbuf = scheduler.CommandBuffer();
     const auto bind_point =
@@ -41,23 +43,85 @@ void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers&
     cmdbuf.pushConstants(*pipeline_layout, stage_flags, 0u, sizeof(push_data), &push_data);
 
     // Bind descriptor set.
-    if (set_writes.empty()) {
+    if (descriptors.empty()) {
         return;
     }
 
     if (uses_push_descriptors) {
-        cmdbuf.pushDescriptorSetKHR(bind_point, *pipeline_layout, 0, set_writes);
+        cmdbuf.pushDescriptorSetWithTemplateKHR(*desc_template, *pipeline_layout, 0,
+                                                static_cast<const void*>(descriptors.data()));
         return;
     }
 
-    const auto desc_set = desc_heap.Commit(*desc_layout);
-    for (auto& set_write : set_writes) {
-        set_write.dstSet = desc_set;
+    // Consecutive draws often bind the exact same resources, reuse the set written for them.
+    if (const u64 tick = scheduler.CurrentTick(); desc_set_cache_tick != tick) {
+        desc_set_cache.clear();
+        desc_set_cache_data.clear();
+        desc_set_cache_tick = tick;
+    }
+    const u32 num_descriptors = static_cast<u32>(descriptors.size());
+    const size_t data_size = descriptors.size() * sizeof(DescriptorInfo);
+    const u64 hash = XXH3_64bits(descriptors.data(), data_size);
+    const auto [it, is_new] = desc_set_cache.try_emplace(hash);
+    if (!is_new) {
+        // The hash only narrows the search, a colliding entry is replaced below.
+        const CachedDescriptorSet& cached = it->second;
+        if (cached.num_descriptors == num_descriptors &&
+            std::memcmp(desc_set_cache_data.data() + cached.data_offset, descriptors.data(),
+                        data_size) == 0) {
+            cmdbuf.bindDescriptorSets(bind_point, *pipeline_layout, 0, cached.set, {});
+            return;
+        }
     }
-    instance.GetDevice().updateDescriptorSets(set_writes, {});
+
+    // A freshly allocated set has undefined contents, so a miss writes every binding with a
+    // single template update instead of patching only the bindings that differ.
+    const auto desc_set = desc_heap.Commit(*desc_layout);
+    instance.GetDevice().updateDescriptorSetWithTemplate(
+        desc_set, *desc_template, static_cast<const void*>(descriptors.data()));
+    it.value() = {
+        .set = desc_set,
+        .data_offset = static_cast<u32>(desc_set_cache_data.size()),
+        .num_descriptors = num_descriptors,
+    };
+    desc_set_cache_data.insert(desc_set_cache_data.end(), descriptors.begin(), descriptors.end());
     cmdbuf.bindDescriptorSets(bind_point, *pipeline_layout, 0, desc_set, {});
 }
 
+void Pipeline::CreateDescriptorTemplate(const DescriptorBindings& bindings) {
+    if (bindings.empty()) {
+        return;
+    }
+    boost::container::small_vector<vk::DescriptorUpdateTemplateEntry, 32> entries;
+    for (const auto& binding : bindings) {
+        entries.push_back({
+            .dstBinding = binding.binding,
+            .dstArrayElement = 0,
+            .descriptorCount = binding.descriptorCount,
+            .descriptorType = binding.descriptorType,
+            .offset = binding.binding * sizeof(DescriptorInfo),
+            .stride = sizeof(DescriptorInfo),
+        });
+    }
+    const vk::DescriptorUpdateTemplateCreateInfo template_ci = {
+        .descriptorUpdateEntryCount = static_cast<u32>(entries.size()),
+        .pDescriptorUpdateEntries = entries.data(),
+        .templateType = uses_push_descriptors
+                            ? vk::DescriptorUpdateTemplateType::ePushDescriptorsKHR
+                            : vk::DescriptorUpdateTemplateType::eDescriptorSet,
+        .descriptorSetLayout = *desc_layout,
+        .pipelineBindPoint =
+            IsCompute() ? vk::PipelineBindPoint::eCompute : vk::PipelineBindPoint::eGraphics,
+        .pipelineLayout = *pipeline_layout,
+        .set = 0,
+    };
+    auto [template_result, update_template] =
+        instance.GetDevice().createDescriptorUpdateTemplateUnique(template_ci);
+    ASSERT_MSG(template_result == vk::Result::eSuccess,
+               "Failed to create descriptor update template: {}", vk::to_string(template_result));
+    desc_template = std::move(update_template);
+}
+
 std::string Pipeline::GetDebugString() const {
     std::string stage_desc;
     for (const auto& stage : stages) {
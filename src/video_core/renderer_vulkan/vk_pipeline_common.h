@@ -3,6 +3,11 @@
 
 #pragma once
 
+#include <cstring>
+#include <boost/container/small_vector.hpp>
+#include <boost/container/static_vector.hpp>
+#include <tsl/robin_map.h>
+
 #include "shader_recompiler/backend/bindings.h"
 #include "shader_recompiler/info.h"
 #include "shader_recompiler/profile.h"
@@ -56,15 +61,38 @@ public:
         return is_compute;
     }
 
-    using DescriptorWrites = boost::container::small_vector<vk::WriteDescriptorSet, 16>;
+    /// Contents of a single binding, laid out the way the descriptor update template reads them.
+    /// Padding stays zeroed so equal bindings hash equally.
+    struct DescriptorInfo {
+        DescriptorInfo(const vk::DescriptorBufferInfo& buffer) {
+            std::memcpy(raw.data(), &buffer, sizeof(buffer));
+        }
+        DescriptorInfo(const vk::DescriptorImageInfo& image) {
+            std::memcpy(raw.data(), &image,
+                        offsetof(vk::DescriptorImageInfo, imageLayout) + sizeof(vk::ImageLayout));
+        }
+
+        std::array<u64, 3> raw{};
+    };
+    static_assert(sizeof(DescriptorInfo) == sizeof(vk::DescriptorBufferInfo) &&
+                  sizeof(DescriptorInfo) == sizeof(vk::DescriptorImageInfo));
+
+    /// Descriptors of every binding of the set, indexed by binding number.
+    using DescriptorData =
+        boost::container::static_vector<DescriptorInfo, Shader::NumBuffers + Shader::NumImages +
+                                                            Shader::NumSamplers>;
+    using DescriptorBindings = boost::container::small_vector<vk::DescriptorSetLayoutBinding, 32>;
     using BufferBarriers = boost::container::small_vector<vk::BufferMemoryBarrier2, 16>;
 
-    void BindResources(DescriptorWrites& set_writes, const BufferBarriers& buffer_barriers,
+    void BindResources(const DescriptorData& descriptors, const BufferBarriers& buffer_barriers,
                        const Shader::PushData& push_data) const;
 
 protected:
     [[nodiscard]] std::string GetDebugString() const;
 
+    /// Creates the update template for the descriptor set layout, after the pipeline layout.
+    void CreateDescriptorTemplate(const DescriptorBindings& bindings);
+
     const Instance& instance;
     Scheduler& scheduler;
     DescriptorHeap& desc_heap;
@@ -72,9 +100,23 @@ protected:
     vk::UniquePipeline pipeline;
     vk::UniquePipelineLayout pipeline_layout;
     vk::UniqueDescriptorSetLayout desc_layout;
+    vk::UniqueDescriptorUpdateTemplate desc_template;
     std::array<const Shader::Info*, Shader::MaxStageTypes> stages{};
     bool uses_push_descriptors{};
     const bool is_compute;
+
+    struct CachedDescriptorSet {
+        vk::DescriptorSet set;
+        u32 data_offset; ///< First descriptor of the set contents in desc_set_cache_data.
+        u32 num_descriptors;
+    };
+
+    // Descriptor sets written during the current scheduler tick, keyed by the hash of their
+    // contents. Resources are only destroyed once their tick completes, so reusing a set within
+    // the tick never references a freed handle.
+    mutable tsl::robin_map<u64, CachedDescriptorSet> desc_set_cache;
+    mutable std::vector<DescriptorInfo> desc_set_cache_data;
+    mutable u64 desc_set_cache_tick{};
 };
 
 } // namespace Vulkan
@@ -21,6 +21,9 @@
 
 namespace Vulkan {
 
+// Number of frames in flight when running headless, matching a triple buffered swapchain.
+constexpr u32 HeadlessFrameCount = 3;
+
 bool CanBlitToSwapchain(const vk::PhysicalDevice physical_device, vk::Format format) {
     const vk::FormatProperties props{physical_device.getFormatProperties(format)};
     return static_cast<bool>(props.optimalTilingFeatures & vk::FormatFeatureFlagBits::eBlitDst);
@@ -107,11 +110,18 @@ Presenter::Presenter(Frontend::WindowSDL& window_, AmdGpu::Liverpool* liverpool_
       instance{window, Config::getGpuId(), Config::vkValidationEnabled(),
                Config::getVkCrashDiagnosticEnabled()},
       draw_scheduler{instance}, present_scheduler{instance}, flip_scheduler{instance},
-      swapchain{instance, window},
+      swapchain{Config::getIsHeadless()
+                    ? std::nullopt
+                    : std::optional<Swapchain>{std::in_place, instance, window}},
       rasterizer{std::make_unique<Rasterizer>(instance, draw_scheduler, liverpool)},
       texture_cache{rasterizer->GetTextureCache()} {
-    const u32 num_images = swapchain.GetImageCount();
+    const u32 num_images = swapchain ? swapchain->GetImageCount() : HeadlessFrameCount;
     const vk::Device device = instance.GetDevice();
+    if (!swapchain) {
+        // The swapchain sets up ImGui otherwise, devtools and frame textures still rely on it.
+        ImGui::Core::Initialize(instance, window, num_images, GetFrameFormat());
+        frame_capture = std::make_unique<FrameCapture>(instance, num_images);
+    }
 
     // Create presentation frames.
     present_frames.resize(num_images);
@@ -129,7 +139,7 @@ Presenter::Presenter(Frontend::WindowSDL& window_, AmdGpu::Liverpool* liverpool_
     fsr_settings.rcas_attenuation = static_cast<float>(Config::getRcasAttenuation() / 1000.f);
 
     fsr_pass.Create(device, instance.GetAllocator(), num_images);
-    pp_pass.Create(device, swapchain.GetSurfaceFormat().format);
+    pp_pass.Create(device, GetFrameFormat());
 
     ImGui::Layer::AddLayer(Common::Singleton<Core::Devtools::Layer>::Instance());
 }
@@ -137,6 +147,7 @@ Presenter::Presenter(Frontend::WindowSDL& window_, AmdGpu::Liverpool* liverpool_
 Presenter::~Presenter() {
     ImGui::Layer::RemoveLayer(Common::Singleton<Core::Devtools::Layer>::Instance());
     draw_scheduler.Finish();
+    ResolveCapturedFrame();
     const vk::Device device = instance.GetDevice();
     for (auto& frame : present_frames) {
         vmaDestroyImage(instance.GetAllocator(), frame.image, frame.allocation);
@@ -158,7 +169,7 @@ void Presenter::RecreateFrame(Frame* frame, u32 width, u32 height) {
         vmaDestroyImage(instance.GetAllocator(), frame->image, frame->allocation);
     }
 
-    const vk::Format format = swapchain.GetSurfaceFormat().format;
+    const vk::Format format = GetFrameFormat();
     const vk::ImageCreateInfo image_info = {
         .flags = vk::ImageCreateFlagBits::eMutableFormat,
         .imageType = vk::ImageType::e2D,
@@ -211,7 +222,7 @@ void Presenter::RecreateFrame(Frame* frame, u32 width, u32 height) {
     frame->height = height;
 
     frame->imgui_texture = ImGui::Vulkan::AddTexture(view, vk::ImageLayout::eShaderReadOnlyOptimal);
-    frame->is_hdr = swapchain.GetHDR();
+    frame->is_hdr = GetHDR();
 }
 
 Frame* Presenter::PrepareLastFrame() {
@@ -431,14 +442,24 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
         }
     };
 
+    if (!swapchain) {
+        PresentHeadless(frame, is_reusing_frame);
+        free_frame();
+        if (!is_reusing_frame) {
+            DebugState.IncFlipFrameNum();
+        }
+        return;
+    }
+
     // Recreate the swapchain if the window was resized.
-    if (window.GetWidth() != swapchain.GetWidth() || window.GetHeight() != swapchain.GetHeight()) {
-        swapchain.Recreate(window.GetWidth(), window.GetHeight());
+    if (window.GetWidth() != swapchain->GetWidth() ||
+        window.GetHeight() != swapchain->GetHeight()) {
+        swapchain->Recreate(window.GetWidth(), window.GetHeight());
     }
 
-    if (!swapchain.AcquireNextImage()) {
-        swapchain.Recreate(window.GetWidth(), window.GetHeight());
-        if (!swapchain.AcquireNextImage()) {
+    if (!swapchain->AcquireNextImage()) {
+        swapchain->Recreate(window.GetWidth(), window.GetHeight());
+        if (!swapchain->AcquireNextImage()) {
             // User resizes the window too fast and GPU can't keep up. Skip this frame.
             LOG_WARNING(Render_Vulkan, "Skipping frame!");
             free_frame();
@@ -455,8 +476,8 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
 
     ImGuiID dockId = ImGui::Core::NewFrame(is_reusing_frame);
 
-    const vk::Image swapchain_image = swapchain.Image();
-    const vk::ImageView swapchain_image_view = swapchain.ImageView();
+    const vk::Image swapchain_image = swapchain->Image();
+    const vk::ImageView swapchain_image_view = swapchain->ImageView();
 
     auto& scheduler = present_scheduler;
     const auto cmdbuf = scheduler.CommandBuffer();
@@ -472,7 +493,7 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
         TracyVkNamedZoneC(profiler_ctx, renderer_gpu_zone, cmdbuf, "Host frame",
                           MarkersPalette::GpuMarkerColor, profiler_ctx != nullptr);
 
-        const vk::Extent2D extent = swapchain.GetExtent();
+        const vk::Extent2D extent = swapchain->GetExtent();
         const std::array pre_barriers{
             vk::ImageMemoryBarrier{
                 .srcAccessMask = vk::AccessFlagBits::eNone,
@@ -578,7 +599,7 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
             ImGui::PopStyleVar(3);
             ImGui::PopStyleColor();
         }
-        ImGui::Core::Render(cmdbuf, swapchain_image_view, swapchain.GetExtent());
+        ImGui::Core::Render(cmdbuf, swapchain_image_view, swapchain->GetExtent());
 
         cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
                                vk::PipelineStageFlagBits::eAllCommands,
@@ -595,16 +616,16 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
 
     // Flush vulkan commands.
     SubmitInfo info{};
-    info.AddWait(swapchain.GetImageAcquiredSemaphore());
+    info.AddWait(swapchain->GetImageAcquiredSemaphore());
     info.AddWait(frame->ready_semaphore, frame->ready_tick);
-    info.AddSignal(swapchain.GetPresentReadySemaphore());
+    info.AddSignal(swapchain->GetPresentReadySemaphore());
     info.AddSignal(frame->present_done);
     scheduler.Flush(info);
 
     // Present to swapchain.
     std::scoped_lock submit_lock{Scheduler::submit_mutex};
-    if (!swapchain.Present()) {
-        swapchain.Recreate(window.GetWidth(), window.GetHeight());
+    if (!swapchain->Present()) {
+        swapchain->Recreate(window.GetWidth(), window.GetHeight());
     }
 
     free_frame();
@@ -613,6 +634,44 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
     }
 }
 
+void Presenter::PresentHeadless(Frame* frame, bool is_reusing_frame) {
+    // Frames are captured one flip late, so reading them back never stalls the GPU.
+    ResolveCapturedFrame();
+
+    // Without an ImGui viewport, render at the configured window size.
+    SetExpectedGameSize(window.GetWidth(), window.GetHeight());
+
+    const auto reset_result = instance.GetDevice().resetFences(frame->present_done);
+    ASSERT_MSG(reset_result == vk::Result::eSuccess,
+               "Unexpected error resetting present done fence: {}", vk::to_string(reset_result));
+
+    auto& scheduler = present_scheduler;
+    const auto cmdbuf = scheduler.CommandBuffer();
+    const bool measure = !is_reusing_frame;
+    frame_capture->Record(cmdbuf, *frame, measure);
+
+    SubmitInfo info{};
+    info.AddWait(frame->ready_semaphore, frame->ready_tick);
+    info.AddSignal(frame->present_done);
+    scheduler.Flush(info);
+
+    if (measure) {
+        captured_frame = frame;
+    }
+}
+
+void Presenter::ResolveCapturedFrame() {
+    if (captured_frame == nullptr) {
+        return;
+    }
+    Frame* frame = std::exchange(captured_frame, nullptr);
+    const vk::Result result = instance.GetDevice().waitForFences(frame->present_done, false,
+                                                                 std::numeric_limits<u64>::max());
+    ASSERT_MSG(result == vk::Result::eSuccess, "Failed waiting for a captured frame: {}",
+               vk::to_string(result));
+    frame_capture->Resolve(*frame);
+}
+
 Frame* Presenter::GetRenderFrame() {
     // Wait for free presentation frames
     Frame* frame;
@@ -645,7 +704,7 @@ Frame* Presenter::GetRenderFrame() {
     }
 
     if (frame->width != expected_frame_width || frame->height != expected_frame_height ||
-        frame->is_hdr != swapchain.GetHDR()) {
+        frame->is_hdr != GetHDR()) {
         RecreateFrame(frame, expected_frame_width, expected_frame_height);
     }
 
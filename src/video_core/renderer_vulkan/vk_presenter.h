@@ -11,6 +11,7 @@
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/renderer_vulkan/host_passes/fsr_pass.h"
 #include "video_core/renderer_vulkan/host_passes/pp_pass.h"
+#include "video_core/renderer_vulkan/vk_frame_capture.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_swapchain.h"
@@ -71,14 +72,14 @@ public:
     }
 
     bool IsHDRSupported() const {
-        return swapchain.HasHDR();
+        return swapchain && swapchain->HasHDR();
     }
 
     void SetHDR(bool enable) {
         if (!IsHDRSupported()) {
             return;
         }
-        swapchain.SetHDR(enable);
+        swapchain->SetHDR(enable);
         pp_settings.hdr = enable ? 1 : 0;
     }
 
@@ -109,6 +110,18 @@ private:
 
     void RecreateFrame(Frame* frame, u32 width, u32 height);
 
+    void PresentHeadless(Frame* frame, bool is_reusing_frame);
+
+    void ResolveCapturedFrame();
+
+    vk::Format GetFrameFormat() const {
+        return swapchain ? swapchain->GetSurfaceFormat().format : FrameCapture::FrameFormat;
+    }
+
+    bool GetHDR() const {
+        return swapchain && swapchain->GetHDR();
+    }
+
     void SetExpectedGameSize(s32 width, s32 height);
 
 private:
@@ -126,8 +139,10 @@ private:
     Scheduler draw_scheduler;
     Scheduler present_scheduler;
     Scheduler flip_scheduler;
-    Swapchain swapchain;
+    std::optional<Swapchain> swapchain;
     std::unique_ptr<Rasterizer> rasterizer;
+    std::unique_ptr<FrameCapture> frame_capture;
+    Frame* captured_frame{};
     VideoCore::TextureCache& texture_cache;
     vk::UniqueCommandPool command_pool;
     std::vector<Frame> present_frames;
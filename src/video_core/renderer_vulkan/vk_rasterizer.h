@@ -131,11 +131,9 @@ private:
         std::pair<VideoCore::ImageId, VideoCore::TextureCache::RenderTargetDesc>;
     std::array<RenderTargetInfo, Liverpool::NumColorBuffers> cb_descs;
     std::pair<VideoCore::ImageId, VideoCore::TextureCache::DepthTargetDesc> db_desc;
-    boost::container::static_vector<vk::DescriptorImageInfo, Shader::NumImages> image_infos;
-    boost::container::static_vector<vk::DescriptorBufferInfo, Shader::NumBuffers> buffer_infos;
     boost::container::static_vector<VideoCore::ImageId, Shader::NumImages> bound_images;
 
-    Pipeline::DescriptorWrites set_writes;
+    Pipeline::DescriptorData descriptors;
     Pipeline::BufferBarriers buffer_barriers;
     Shader::PushData push_data;
 
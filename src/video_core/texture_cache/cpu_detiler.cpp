@@ -0,0 +1,606 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "common/assert.h"
+#include "video_core/amdgpu/tiling.h"
+#include "video_core/texture_cache/cpu_detiler.h"
+#include "video_core/texture_cache/image_info.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace VideoCore {
+
+// The address calculations below mirror host_shaders/tiling.comp so both paths produce
+// identical results. Keep them in sync when changing either one.
+
+static constexpr u32 MicroTileWidth = 8;
+static constexpr u32 MicroTileHeight = 8;
+static constexpr u32 MicroTilePixels = MicroTileWidth * MicroTileHeight;
+static constexpr u32 MaxMicroTileThickness = 8;
+static constexpr u32 NumPipeInterleaveBits = 8;
+// A 128bpp thin micro tile is 1KB and the smallest tile split is 64 bytes.
+static constexpr u32 MaxTileSplits = 16;
+
+namespace {
+
+struct TilingParams {
+    u32 bpp;
+    u32 bytes_per_pixel;
+    AmdGpu::ArrayMode array_mode;
+    AmdGpu::MicroTileMode micro_tile_mode;
+    AmdGpu::PipeConfig pipe_config;
+    u32 thickness;
+    u32 micro_tile_bytes;
+    bool is_macro_tiled;
+    u32 num_pipes;
+    u32 num_pipe_bits;
+    u32 bank_width;
+    u32 bank_height;
+    u32 num_banks;
+    u32 num_bank_bits;
+    u32 tile_split_bytes;
+    u32 macro_tile_aspect;
+    u32 bank_swizzle;
+};
+
+/// Per image lookup of every pixel of a micro tile to its tile split and its byte offset
+/// relative to the address of that split.
+struct MicroTileLayout {
+    u32 num_splits;
+    u32 max_offset;
+    std::array<u8, MicroTilePixels * MaxMicroTileThickness> split;
+    std::array<u32, MicroTilePixels * MaxMicroTileThickness> offset;
+};
+
+constexpr u32 Bit(u32 value, u32 bit) {
+    return (value >> bit) & 1;
+}
+
+bool Is3DTiled(AmdGpu::ArrayMode array_mode) {
+    return array_mode == AmdGpu::ArrayMode::Array3DTiledThin1 ||
+           array_mode == AmdGpu::ArrayMode::Array3DTiledThick ||
+           array_mode == AmdGpu::ArrayMode::Array3DTiledXThick;
+}
+
+bool Is2DTiled(AmdGpu::ArrayMode array_mode) {
+    return array_mode == AmdGpu::ArrayMode::Array2DTiledThin1 ||
+           array_mode == AmdGpu::ArrayMode::Array2DTiledThick ||
+           array_mode == AmdGpu::ArrayMode::Array2DTiledXThick;
+}
+
+bool IsPrtTiled(AmdGpu::ArrayMode array_mode) {
+    return array_mode == AmdGpu::ArrayMode::ArrayPrtTiledThin1 ||
+           array_mode == AmdGpu::ArrayMode::ArrayPrtTiledThick ||
+           array_mode == AmdGpu::ArrayMode::ArrayPrt2DTiledThin1 ||
+           array_mode == AmdGpu::ArrayMode::ArrayPrt2DTiledThick ||
+           array_mode == AmdGpu::ArrayMode::ArrayPrt3DTiledThin1 ||
+           array_mode == AmdGpu::ArrayMode::ArrayPrt3DTiledThick;
+}
+
+bool HasTileSplitRotation(AmdGpu::ArrayMode array_mode) {
+    return array_mode == AmdGpu::ArrayMode::Array2DTiledThin1 ||
+           array_mode == AmdGpu::ArrayMode::Array3DTiledThin1 ||
+           array_mode == AmdGpu::ArrayMode::ArrayPrt2DTiledThin1 ||
+           array_mode == AmdGpu::ArrayMode::ArrayPrt3DTiledThin1;
+}
+
+TilingParams MakeTilingParams(const ImageInfo& info) {
+    TilingParams p{};
+    p.bpp = info.num_bits;
+    p.bytes_per_pixel = info.num_bits / 8;
+    p.array_mode = info.array_mode;
+    p.micro_tile_mode = AmdGpu::GetMicroTileMode(info.tile_mode);
+    p.thickness = AmdGpu::GetMicroTileThickness(info.array_mode);
+    p.micro_tile_bytes = MicroTilePixels * p.thickness * p.bpp * info.num_samples / 8;
+    p.is_macro_tiled = AmdGpu::IsMacroTiled(info.array_mode);
+    p.bank_swizzle = info.bank_swizzle;
+    if (!p.is_macro_tiled) {
+        return p;
+    }
+    const auto macro_tile_mode =
+        AmdGpu::CalculateMacrotileMode(info.tile_mode, info.num_bits, info.num_samples);
+    p.pipe_config = AmdGpu::GetPipeConfig(info.tile_mode);
+    p.num_pipes = p.pipe_config == AmdGpu::PipeConfig::P2 ? 2 : 8;
+    p.num_pipe_bits = p.pipe_config == AmdGpu::PipeConfig::P2 ? 1 : 3;
+    p.bank_width = AmdGpu::GetBankWidth(macro_tile_mode);
+    p.bank_height = AmdGpu::GetBankHeight(macro_tile_mode);
+    p.num_banks = AmdGpu::GetNumBanks(macro_tile_mode);
+    p.num_bank_bits = std::bit_width(p.num_banks) - 1;
+    p.tile_split_bytes = AmdGpu::CalculateTileSplit(info.tile_mode, info.array_mode,
+                                                    p.micro_tile_mode, info.num_bits);
+    p.macro_tile_aspect = AmdGpu::GetMacrotileAspect(macro_tile_mode);
+    return p;
+}
+
+u32 ComputePixelIndexWithinMicroTile(const TilingParams& p, u32 x, u32 y, u32 z) {
+    const u32 x0 = Bit(x, 0), x1 = Bit(x, 1), x2 = Bit(x, 2);
+    const u32 y0 = Bit(y, 0), y1 = Bit(y, 1), y2 = Bit(y, 2);
+    const u32 z0 = Bit(z, 0), z1 = Bit(z, 1), z2 = Bit(z, 2);
+    std::array<u32, 9> bits{};
+
+    switch (p.micro_tile_mode) {
+    case AmdGpu::MicroTileMode::Display:
+        switch (p.bpp) {
+        case 8:
+            bits = {x0, x1, x2, y1, y0, y2};
+            break;
+        case 16:
+            bits = {x0, x1, x2, y0, y1, y2};
+            break;
+        case 32:
+            bits = {x0, x1, y0, x2, y1, y2};
+            break;
+        case 64:
+            bits = {x0, y0, x1, x2, y1, y2};
+            break;
+        case 128:
+            bits = {y0, x0, x1, x2, y1, y2};
+            break;
+        }
+        break;
+    case AmdGpu::MicroTileMode::Thin:
+    case AmdGpu::MicroTileMode::Depth:
+        bits = {x0, y0, x1, y1, x2, y2};
+        break;
+    default:
+        switch (p.bpp) {
+        case 8:
+        case 16:
+            bits = {x0, y0, x1, y1, z0, z1};
+            break;
+        case 32:
+            bits = {x0, y0, x1, z0, y1, z1};
+            break;
+        case 64:
+        case 128:
+            bits = {x0, y0, z0, x1, y1, z1};
+            break;
+        }
+        bits[6] = x2;
+        bits[7] = y2;
+        if (p.thickness == 8) {
+            bits[8] = z2;
+        }
+        break;
+    }
+
+    u32 pixel_number = 0;
+    for (u32 i = 0; i < bits.size(); ++i) {
+        pixel_number |= bits[i] << i;
+    }
+    return pixel_number;
+}
+
+u32 ComputeElementOffset(const TilingParams& p, u32 x, u32 y, u32 z) {
+    // Only sample 0 is detiled, which places every pixel at the same offset for all modes.
+    return ComputePixelIndexWithinMicroTile(p, x, y, z) * p.bpp / 8;
+}
+
+u32 ComputeSurfaceAddrMicroTiled(const TilingParams& p, u32 x, u32 y, u32 slice, u32 pitch,
+                                 u32 height, u32 element_offset) {
+    const u32 slice_bytes = (pitch * height * p.thickness * p.bpp + 7) / 8;
+    const u32 micro_tiles_per_row = pitch / MicroTileWidth;
+    const u32 micro_tile_index_x = x / MicroTileWidth;
+    const u32 micro_tile_index_y = y / MicroTileHeight;
+    const u32 micro_tile_index_z = slice / p.thickness;
+
+    const u32 slice_offset = micro_tile_index_z * slice_bytes;
+    const u32 micro_tile_offset =
+        (micro_tile_index_y * micro_tiles_per_row + micro_tile_index_x) * p.micro_tile_bytes;
+    return slice_offset + micro_tile_offset + element_offset;
+}
+
+u32 ComputePipeFromCoord(const TilingParams& p, u32 x, u32 y, u32 slice) {
+    const u32 tx = x / MicroTileWidth;
+    const u32 ty = y / MicroTileHeight;
+    const u32 x3 = Bit(tx, 0), x4 = Bit(tx, 1), x5 = Bit(tx, 2);
+    const u32 y3 = Bit(ty, 0), y4 = Bit(ty, 1), y5 = Bit(ty, 2);
+
+    u32 p0 = 0, p1 = 0, p2 = 0;
+    switch (p.pipe_config) {
+    case AmdGpu::PipeConfig::P2:
+        p0 = x3 ^ y3;
+        break;
+    case AmdGpu::PipeConfig::P8_32x32_8x16:
+        p0 = x4 ^ y3 ^ x5;
+        p1 = x3 ^ y4;
+        p2 = x5 ^ y5;
+        break;
+    case AmdGpu::PipeConfig::P8_32x32_16x16:
+        p0 = x3 ^ y3 ^ x4;
+        p1 = x4 ^ y4;
+        p2 = x5 ^ y5;
+        break;
+    default:
+        break;
+    }
+    const u32 pipe = p0 | (p1 << 1) | (p2 << 2);
+
+    u32 pipe_swizzle = 0;
+    if (Is3DTiled(p.array_mode)) {
+        pipe_swizzle += std::max(1U, p.num_pipes / 2 - 1) * (slice / p.thickness);
+    }
+    pipe_swizzle &= p.num_pipes - 1;
+    return pipe ^ pipe_swizzle;
+}
+
+u32 ComputeBankFromCoord(const TilingParams& p, u32 x, u32 y, u32 slice, u32 tile_split_slice) {
+    const u32 tx = x / MicroTileWidth / (p.bank_width * p.num_pipes);
+    const u32 ty = y / MicroTileHeight / p.bank_height;
+    const u32 x3 = Bit(tx, 0), x4 = Bit(tx, 1), x5 = Bit(tx, 2), x6 = Bit(tx, 3);
+    const u32 y3 = Bit(ty, 0), y4 = Bit(ty, 1), y5 = Bit(ty, 2), y6 = Bit(ty, 3);
+
+    u32 b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+    switch (p.num_banks) {
+    case 16:
+        b0 = x3 ^ y6;
+        b1 = x4 ^ y5 ^ y6;
+        b2 = x5 ^ y4;
+        b3 = x6 ^ y3;
+        break;
+    case 8:
+        b0 = x3 ^ y5;
+        b1 = x4 ^ y4 ^ y5;
+        b2 = x5 ^ y3;
+        break;
+    case 4:
+        b0 = x3 ^ y4;
+        b1 = x4 ^ y3;
+        break;
+    case 2:
+        b0 = x3 ^ y3;
+        break;
+    }
+    u32 bank = b0 | (b1 << 1) | (b2 << 2) | (b3 << 3);
+
+    u32 slice_rotation = 0;
+    if (Is2DTiled(p.array_mode)) {
+        slice_rotation = (p.num_banks / 2 - 1) * (slice / p.thickness);
+    } else if (Is3DTiled(p.array_mode)) {
+        slice_rotation =
+            std::max(1U, p.num_pipes / 2 - 1) * (slice / p.thickness) / p.num_pipes;
+    }
+    u32 tile_split_rotation = 0;
+    if (HasTileSplitRotation(p.array_mode)) {
+        tile_split_rotation = (p.num_banks / 2 + 1) * tile_split_slice;
+    }
+
+    bank ^= p.bank_swizzle + slice_rotation;
+    bank ^= tile_split_rotation;
+    bank &= p.num_banks - 1;
+    return bank;
+}
+
+u32 ComputeSurfaceAddrMacroTiled(const TilingParams& p, u32 x, u32 y, u32 slice, u32 pitch,
+                                 u32 height, u32 element_offset) {
+    u32 micro_tile_bytes = p.micro_tile_bytes;
+    u32 slices_per_tile = 1;
+    u32 tile_split_slice = 0;
+    if (p.micro_tile_bytes > p.tile_split_bytes && p.thickness == 1) {
+        slices_per_tile = p.micro_tile_bytes / p.tile_split_bytes;
+        tile_split_slice = element_offset / p.tile_split_bytes;
+        element_offset %= p.tile_split_bytes;
+        micro_tile_bytes = p.tile_split_bytes;
+    }
+
+    const u32 macro_tile_pitch =
+        (MicroTileWidth * p.bank_width * p.num_pipes) * p.macro_tile_aspect;
+    const u32 macro_tile_height =
+        (MicroTileHeight * p.bank_height * p.num_banks) / p.macro_tile_aspect;
+    const u32 macro_tile_bytes = micro_tile_bytes * (macro_tile_pitch / MicroTileWidth) *
+                                 (macro_tile_height / MicroTileHeight) /
+                                 (p.num_pipes * p.num_banks);
+
+    const u32 macro_tiles_per_row = pitch / macro_tile_pitch;
+    const u32 macro_tile_index_x = x / macro_tile_pitch;
+    const u32 macro_tile_index_y = y / macro_tile_height;
+    const u32 macro_tile_offset =
+        (macro_tile_index_y * macro_tiles_per_row + macro_tile_index_x) * macro_tile_bytes;
+    const u32 macro_tiles_per_slice = macro_tiles_per_row * (height / macro_tile_height);
+
+    const u32 slice_bytes = macro_tiles_per_slice * macro_tile_bytes;
+    const u32 slice_offset =
+        slice_bytes * (tile_split_slice + slices_per_tile * (slice / p.thickness));
+
+    const u32 tile_row_index = (y / MicroTileHeight) % p.bank_height;
+    const u32 tile_column_index = ((x / MicroTileWidth) / p.num_pipes) % p.bank_width;
+    const u32 tile_index = tile_row_index * p.bank_width + tile_column_index;
+    const u32 tile_offset = tile_index * micro_tile_bytes;
+
+    const u32 total_offset = slice_offset + macro_tile_offset + element_offset + tile_offset;
+
+    if (IsPrtTiled(p.array_mode)) {
+        x %= macro_tile_pitch;
+        y %= macro_tile_height;
+    }
+
+    const u32 pipe = ComputePipeFromCoord(p, x, y, slice);
+    const u32 bank = ComputeBankFromCoord(p, x, y, slice, tile_split_slice);
+
+    const u32 pipe_interleave_mask = (1U << NumPipeInterleaveBits) - 1;
+    const u32 pipe_interleave_offset = total_offset & pipe_interleave_mask;
+    const u32 offset = total_offset >> NumPipeInterleaveBits;
+
+    return pipe_interleave_offset | (pipe << NumPipeInterleaveBits) |
+           (bank << (NumPipeInterleaveBits + p.num_pipe_bits)) |
+           (offset << (NumPipeInterleaveBits + p.num_pipe_bits + p.num_bank_bits));
+}
+
+u32 ComputeSurfaceAddr(const TilingParams& p, u32 x, u32 y, u32 slice, u32 pitch, u32 height,
+                       u32 element_offset) {
+    if (p.is_macro_tiled) {
+        return ComputeSurfaceAddrMacroTiled(p, x, y, slice, pitch, height, element_offset);
+    }
+    return ComputeSurfaceAddrMicroTiled(p, x, y, slice, pitch, height, element_offset);
+}
+
+MicroTileLayout BuildMicroTileLayout(const TilingParams& p) {
+    MicroTileLayout layout{};
+    const bool has_split =
+        p.is_macro_tiled && p.micro_tile_bytes > p.tile_split_bytes && p.thickness == 1;
+    layout.num_splits = has_split ? p.micro_tile_bytes / p.tile_split_bytes : 1;
+
+    // Within one split of a micro tile the element offset only ever lands in the pipe
+    // interleave bits or above the pipe/bank bits without carrying between them, so the
+    // address of a pixel is the split's base address plus a fixed per-pixel delta.
+    const u32 high_shift = p.is_macro_tiled ? p.num_pipe_bits + p.num_bank_bits : 0;
+    for (u32 z = 0; z < p.thickness; ++z) {
+        for (u32 y = 0; y < MicroTileHeight; ++y) {
+            for (u32 x = 0; x < MicroTileWidth; ++x) {
+                const u32 index = (z * MicroTileHeight + y) * MicroTileWidth + x;
+                u32 element_offset = ComputeElementOffset(p, x, y, z);
+                u32 split = 0;
+                if (has_split) {
+                    split = element_offset / p.tile_split_bytes;
+                    element_offset %= p.tile_split_bytes;
+                }
+                const u32 low = element_offset & ((1U << NumPipeInterleaveBits) - 1);
+                const u32 high = element_offset >> NumPipeInterleaveBits;
+                layout.split[index] = static_cast<u8>(split);
+                layout.offset[index] = low | (high << (NumPipeInterleaveBits + high_shift));
+                layout.max_offset = std::max(layout.max_offset, layout.offset[index]);
+            }
+        }
+    }
+    return layout;
+}
+
+template <u32 BytesPerPixel, CpuDetileVariant Variant>
+void CopyMicroTileRow(u8* dst, const u8* src, const u32* offsets) {
+#ifdef __AVX2__
+    if constexpr (Variant == CpuDetileVariant::Avx2 && BytesPerPixel == 4) {
+        const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets));
+        const __m256i texels = _mm256_i32gather_epi32(reinterpret_cast<const int*>(src), index, 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), texels);
+        return;
+    } else if constexpr (Variant == CpuDetileVariant::Avx2 && BytesPerPixel == 8) {
+        const auto* gather_src = reinterpret_cast<const long long*>(src);
+        const __m128i index_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets));
+        const __m128i index_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets + 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                            _mm256_i32gather_epi64(gather_src, index_lo, 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32),
+                            _mm256_i32gather_epi64(gather_src, index_hi, 1));
+        return;
+    }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+    // Without gathers texels are moved one at a time, AVX2 also does this for 128bpp.
+    if constexpr (Variant != CpuDetileVariant::Scalar && BytesPerPixel == 8) {
+        for (u32 i = 0; i < MicroTileWidth; ++i) {
+            const auto* texel_src = reinterpret_cast<const __m128i*>(src + offsets[i]);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 8), _mm_loadl_epi64(texel_src));
+        }
+        return;
+    } else if constexpr (Variant != CpuDetileVariant::Scalar && BytesPerPixel == 16) {
+        for (u32 i = 0; i < MicroTileWidth; ++i) {
+            const auto* texel_src = reinterpret_cast<const __m128i*>(src + offsets[i]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 16), _mm_loadu_si128(texel_src));
+        }
+        return;
+    }
+#endif
+    for (u32 i = 0; i < MicroTileWidth; ++i) {
+        std::memcpy(dst + i * BytesPerPixel, src + offsets[i], BytesPerPixel);
+    }
+}
+
+/// Detiles one mip texel by texel, used for layouts not aligned to whole micro tiles.
+void DetileMipGeneric(const TilingParams& p, const u8* tiled, u32 tiled_size, u8* linear,
+                      const ImageInfo::MipInfo& mip, u32 num_texels) {
+    const u32 bpp = p.bytes_per_pixel;
+    for (u32 texel = 0; texel < num_texels; ++texel) {
+        const u32 x = texel % mip.pitch;
+        const u32 y = (texel / mip.pitch) % mip.height;
+        const u32 slice = texel / (mip.pitch * mip.height);
+        const u32 addr = mip.offset + ComputeSurfaceAddr(p, x, y, slice, mip.pitch, mip.height,
+                                                         ComputeElementOffset(p, x, y, slice));
+        if (addr + bpp <= tiled_size) {
+            std::memcpy(linear + texel * bpp, tiled + addr, bpp);
+        } else {
+            std::memset(linear + texel * bpp, 0, bpp);
+        }
+    }
+}
+
+template <u32 BytesPerPixel, CpuDetileVariant Variant>
+void DetileMip(const TilingParams& p, const MicroTileLayout& layout, const u8* tiled,
+               u32 tiled_size, u8* linear, const ImageInfo::MipInfo& mip, u32 num_texels) {
+    const u32 pitch = mip.pitch;
+    const u32 height = mip.height;
+    const u32 slice_texels = pitch * height;
+    if (pitch % MicroTileWidth != 0 || height % MicroTileHeight != 0) {
+        DetileMipGeneric(p, tiled, tiled_size, linear, mip, num_texels);
+        return;
+    }
+
+    const u8* mip_src = tiled + mip.offset;
+    const u32 num_slices = num_texels / slice_texels;
+    std::array<u32, MaxTileSplits> split_bases{};
+    std::array<u32, MicroTileWidth> offsets{};
+    for (u32 slice = 0; slice < num_slices; ++slice) {
+        const u32 z = slice % p.thickness;
+        for (u32 tile_y = 0; tile_y < height; tile_y += MicroTileHeight) {
+            for (u32 tile_x = 0; tile_x < pitch; tile_x += MicroTileWidth) {
+                u32 max_base = 0;
+                for (u32 s = 0; s < layout.num_splits; ++s) {
+                    split_bases[s] = ComputeSurfaceAddr(p, tile_x, tile_y, slice, pitch, height,
+                                                        s * p.tile_split_bytes);
+                    max_base = std::max(max_base, split_bases[s]);
+                }
+                u8* dst = linear + ((slice * height + tile_y) * pitch + tile_x) * BytesPerPixel;
+                if (u64(mip.offset) + max_base + layout.max_offset + BytesPerPixel >
+                    tiled_size) {
+                    // Tile reaches past the end of the guest image, take the checked path.
+                    for (u32 y = 0; y < MicroTileHeight; ++y) {
+                        for (u32 x = 0; x < MicroTileWidth; ++x) {
+                            const u32 index = (z * MicroTileHeight + y) * MicroTileWidth + x;
+                            const u32 addr = mip.offset + split_bases[layout.split[index]] +
+                                             layout.offset[index];
+                            u8* out = dst + (y * pitch + x) * BytesPerPixel;
+                            if (addr + BytesPerPixel <= tiled_size) {
+                                std::memcpy(out, tiled + addr, BytesPerPixel);
+                            } else {
+                                std::memset(out, 0, BytesPerPixel);
+                            }
+                        }
+                    }
+                    continue;
+                }
+                for (u32 y = 0; y < MicroTileHeight; ++y) {
+                    const u32 row = (z * MicroTileHeight + y) * MicroTileWidth;
+                    if (layout.num_splits == 1) {
+                        for (u32 x = 0; x < MicroTileWidth; ++x) {
+                            offsets[x] = split_bases[0] + layout.offset[row + x];
+                        }
+                    } else {
+                        for (u32 x = 0; x < MicroTileWidth; ++x) {
+                            offsets[x] =
+                                split_bases[layout.split[row + x]] + layout.offset[row + x];
+                        }
+                    }
+                    CopyMicroTileRow<BytesPerPixel, Variant>(dst + y * pitch * BytesPerPixel,
+                                                             mip_src, offsets.data());
+                }
+            }
+        }
+    }
+
+    // A trailing partial slice can only happen with unusual mip sizes, handle it per texel.
+    const u32 done_texels = num_slices * slice_texels;
+    for (u32 texel = done_texels; texel < num_texels; ++texel) {
+        const u32 x = texel % pitch;
+        const u32 y = (texel / pitch) % height;
+        const u32 slice = texel / slice_texels;
+        const u32 addr = mip.offset + ComputeSurfaceAddr(p, x, y, slice, pitch, height,
+                                                         ComputeElementOffset(p, x, y, slice));
+        if (addr + BytesPerPixel <= tiled_size) {
+            std::memcpy(linear + texel * BytesPerPixel, tiled + addr, BytesPerPixel);
+        } else {
+            std::memset(linear + texel * BytesPerPixel, 0, BytesPerPixel);
+        }
+    }
+}
+
+/// Calls func with every mip of the image and where its texels go in the linear buffer.
+template <typename Func>
+void ForEachMip(const ImageInfo& info, const TilingParams& params, u8* linear, Func&& func) {
+    u64 linear_offset = 0;
+    for (u32 m = 0; m < info.resources.levels; ++m) {
+        auto mip = info.mips_layout[m];
+        if (info.props.is_block) {
+            mip.pitch = std::max((mip.pitch + 3) / 4, 1U);
+            mip.height = std::max((mip.height + 3) / 4, 1U);
+        }
+        const u32 num_texels = mip.size / params.bytes_per_pixel;
+        func(mip, linear + linear_offset, num_texels);
+        linear_offset += u64(num_texels) * params.bytes_per_pixel;
+    }
+}
+
+template <CpuDetileVariant Variant>
+void DetileImage(const ImageInfo& info, const u8* tiled, u8* linear) {
+    const auto params = MakeTilingParams(info);
+    const auto layout = BuildMicroTileLayout(params);
+    const u32 tiled_size = info.guest_size;
+    ForEachMip(info, params, linear, [&](const ImageInfo::MipInfo& mip, u8* mip_linear,
+                                         u32 num_texels) {
+        switch (params.bytes_per_pixel) {
+        case 1:
+            DetileMip<1, Variant>(params, layout, tiled, tiled_size, mip_linear, mip, num_texels);
+            break;
+        case 2:
+            DetileMip<2, Variant>(params, layout, tiled, tiled_size, mip_linear, mip, num_texels);
+            break;
+        case 4:
+            DetileMip<4, Variant>(params, layout, tiled, tiled_size, mip_linear, mip, num_texels);
+            break;
+        case 8:
+            DetileMip<8, Variant>(params, layout, tiled, tiled_size, mip_linear, mip, num_texels);
+            break;
+        case 16:
+            DetileMip<16, Variant>(params, layout, tiled, tiled_size, mip_linear, mip, num_texels);
+            break;
+        }
+    });
+}
+
+} // Anonymous namespace
+
+bool IsCpuDetileSupported(const ImageInfo& info) {
+    if (!info.props.is_tiled || info.num_samples != 1) {
+        return false;
+    }
+    switch (info.num_bits) {
+    case 8:
+    case 16:
+    case 32:
+    case 64:
+    case 128:
+        break;
+    default:
+        return false;
+    }
+    if (info.array_mode == AmdGpu::ArrayMode::ArrayLinearGeneral ||
+        info.array_mode == AmdGpu::ArrayMode::ArrayLinearAligned) {
+        return false;
+    }
+    return info.resources.levels <= info.mips_layout.size();
+}
+
+void DetileImageCpu(const ImageInfo& info, const u8* tiled, u8* linear, CpuDetileVariant variant) {
+    switch (variant) {
+    case CpuDetileVariant::Scalar:
+        DetileImage<CpuDetileVariant::Scalar>(info, tiled, linear);
+        break;
+#if defined(__AVX2__) || defined(__SSE2__)
+    case CpuDetileVariant::Sse:
+        DetileImage<CpuDetileVariant::Sse>(info, tiled, linear);
+        break;
+#endif
+#ifdef __AVX2__
+    case CpuDetileVariant::Avx2:
+        DetileImage<CpuDetileVariant::Avx2>(info, tiled, linear);
+        break;
+#endif
+    default:
+        UNREACHABLE_MSG("CPU detiler variant {} is not built", static_cast<u32>(variant));
+    }
+}
+
+void DetileImageCpuReference(const ImageInfo& info, const u8* tiled, u8* linear) {
+    const auto params = MakeTilingParams(info);
+    ForEachMip(info, params, linear, [&](const ImageInfo::MipInfo& mip, u8* mip_linear,
+                                         u32 num_texels) {
+        DetileMipGeneric(params, tiled, info.guest_size, mip_linear, mip, num_texels);
+    });
+}
+
+} // namespace VideoCore
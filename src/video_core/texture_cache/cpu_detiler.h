@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/types.h"
+
+namespace VideoCore {
+
+struct ImageInfo;
+
+/// How the CPU detiler copies the rows of a micro tile.
+enum class CpuDetileVariant : u32 {
+    Scalar, ///< Plain memcpy per texel.
+    Sse,    ///< One SSE load and store per 64bpp and 128bpp texel.
+    Avx2,   ///< Gathers whole rows of 32bpp and 64bpp texels.
+};
+
+/// The fastest variant the build targets, used unless one is requested explicitly.
+#if defined(__AVX2__)
+constexpr CpuDetileVariant DefaultCpuDetileVariant = CpuDetileVariant::Avx2;
+#elif defined(__SSE2__)
+constexpr CpuDetileVariant DefaultCpuDetileVariant = CpuDetileVariant::Sse;
+#else
+constexpr CpuDetileVariant DefaultCpuDetileVariant = CpuDetileVariant::Scalar;
+#endif
+
+/// Returns true when the CPU detiler can handle the tiling layout of the image.
+bool IsCpuDetileSupported(const ImageInfo& info);
+
+/// Detiles all mips and slices of the image into a linear buffer of guest_size bytes.
+/// The output layout matches the one produced by the compute detiler in tiling.comp.
+/// Only variants up to DefaultCpuDetileVariant are built.
+void DetileImageCpu(const ImageInfo& info, const u8* tiled, u8* linear,
+                    CpuDetileVariant variant = DefaultCpuDetileVariant);
+
+/// Detiles texel by texel with the full address calculation. Much slower, it is the reference
+/// the other variants are checked against.
+void DetileImageCpuReference(const ImageInfo& info, const u8* tiled, u8* linear);
+
+} // namespace VideoCore
@@ -2,7 +2,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <ranges>
+#include <xxhash.h>
 #include "common/assert.h"
+#include "common/div_ceil.h"
 #include "video_core/renderer_vulkan/liverpool_to_vk.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
@@ -111,7 +113,10 @@ Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
     if (info.pixel_format == vk::Format::eUndefined) {
         return;
     }
-    mip_hashes.resize(info.resources.levels);
+    const u64 num_hash_pages = Common::DivCeil<u64>(info.guest_size, HashPageSize);
+    page_hashes.resize(num_hash_pages);
+    cpu_dirty_pages.resize(num_hash_pages);
+    changed_pages.resize(num_hash_pages);
     // Here we force `eExtendedUsage` as don't know all image usage cases beforehand. In normal case
     // the texture cache should re-create the resource with the usage requested
     vk::ImageCreateFlags flags{vk::ImageCreateFlagBits::eMutableFormat |
@@ -775,4 +780,40 @@ void Image::SetBackingSamples(u32 num_samples, bool copy_backing) {
     backing = new_backing;
 }
 
+void Image::MarkPagesCpuDirty(VAddr addr, size_t size) {
+    const VAddr begin = std::max(addr, info.guest_address);
+    const VAddr end = std::min(addr + size, info.guest_address + info.guest_size);
+    if (begin >= end) {
+        return;
+    }
+    const u64 first_page = (begin - info.guest_address) / HashPageSize;
+    const u64 end_page = Common::DivCeil(end - info.guest_address, HashPageSize);
+    std::fill(cpu_dirty_pages.begin() + first_page, cpu_dirty_pages.begin() + end_page, true);
+}
+
+void Image::ClearPagesCpuDirty() {
+    std::fill(cpu_dirty_pages.begin(), cpu_dirty_pages.end(), false);
+}
+
+bool Image::UpdatePageHashes() {
+    const u8* addr = std::bit_cast<u8*>(info.guest_address);
+    std::fill(changed_pages.begin(), changed_pages.end(), false);
+    bool any_changed = false;
+    for (size_t page = 0; page < page_hashes.size(); ++page) {
+        if (!cpu_dirty_pages[page]) {
+            continue;
+        }
+        cpu_dirty_pages[page] = false;
+        const u64 offset = page * HashPageSize;
+        const u64 size = std::min<u64>(HashPageSize, info.guest_size - offset);
+        const u64 hash = XXH3_64bits(addr + offset, size);
+        if (page_hashes[page] != hash) {
+            page_hashes[page] = hash;
+            changed_pages[page] = true;
+            any_changed = true;
+        }
+    }
+    return any_changed;
+}
+
 } // namespace VideoCore
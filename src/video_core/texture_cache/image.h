@@ -133,7 +133,20 @@ struct Image {
 
     void SetBackingSamples(u32 num_samples, bool copy_backing = true);
 
+    /// Flags the hash pages overlapping the range as possibly written by the CPU. Called for
+    /// every range that stops being write protected.
+    void MarkPagesCpuDirty(VAddr addr, size_t size);
+
+    /// Drops the CPU dirty flags, once the whole image is uploaded again.
+    void ClearPagesCpuDirty();
+
+    /// Rehashes the pages flagged as CPU dirty and clears their flags. Pages whose contents
+    /// changed since they were last hashed are flagged in `changed_pages`. Returns true if any did.
+    bool UpdatePageHashes();
+
 public:
+    static constexpr u64 HashPageSize = 4_KB;
+
     const Vulkan::Instance* instance;
     Vulkan::Scheduler* scheduler;
     BlitHelper* blit_helper;
@@ -164,7 +177,9 @@ public:
     };
     std::deque<BackingImage> backing_images;
     BackingImage* backing{};
-    boost::container::static_vector<u64, 16> mip_hashes{};
+    std::vector<u64> page_hashes;
+    std::vector<bool> cpu_dirty_pages;
+    std::vector<bool> changed_pages;
     u64 lru_id{};
     u64 tick_accessed_last{};
     u64 hash{};
@@ -6,6 +6,7 @@
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/debug.h"
+#include "common/div_ceil.h"
 #include "common/polyfill_thread.h"
 #include "common/scope_exit.h"
 #include "core/memory.h"
@@ -13,6 +14,7 @@
 #include "video_core/page_manager.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/texture_cache/cpu_detiler.h"
 #include "video_core/texture_cache/host_compatibility.h"
 #include "video_core/texture_cache/texture_cache.h"
 #include "video_core/texture_cache/tile_manager.h"
@@ -21,6 +23,7 @@ namespace VideoCore {
 
 static constexpr u64 PageShift = 12;
 static constexpr u64 NumFramesBeforeRemoval = 32;
+static constexpr u32 MaxCpuDetileSize = 1_MB;
 
 TextureCache::TextureCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                            AmdGpu::Liverpool* liverpool_, BufferCache& buffer_cache_,
@@ -669,6 +672,24 @@ void TextureCache::RefreshImage(Image& image) {
     const bool is_gpu_modified = True(image.flags & ImageFlagBits::GpuModified);
     const bool is_gpu_dirty = True(image.flags & ImageFlagBits::GpuDirty);
 
+    // Protect GPU modified resources from accidental CPU reuploads.
+    const bool check_hashes = is_gpu_modified && !is_gpu_dirty;
+    if (check_hashes) {
+        if (!image.UpdatePageHashes()) {
+            image.flags &= ~ImageFlagBits::Dirty;
+            return;
+        }
+    } else {
+        image.ClearPagesCpuDirty();
+    }
+    const auto& changed_pages = image.changed_pages;
+
+    // Linear single layer images map each guest page to a band of rows, so only the bands
+    // that changed have to be uploaded again.
+    const bool can_upload_rows = check_hashes && !image.info.props.is_tiled &&
+                                 !image.info.props.is_block && !image.info.props.is_volume &&
+                                 num_layers == 1;
+
     boost::container::small_vector<vk::BufferImageCopy, 14> image_copies;
     for (u32 m = 0; m < num_mips; m++) {
         const u32 width = std::max(image.info.size.width >> m, 1u);
@@ -677,20 +698,42 @@ void TextureCache::RefreshImage(Image& image) {
             image.info.props.is_volume ? std::max(image.info.size.depth >> m, 1u) : 1u;
         const auto [mip_size, mip_pitch, mip_height, mip_offset] = image.info.mips_layout[m];
 
-        // Protect GPU modified resources from accidental CPU reuploads.
-        if (is_gpu_modified && !is_gpu_dirty) {
-            const u8* addr = std::bit_cast<u8*>(image.info.guest_address);
-            const u64 hash = XXH3_64bits(addr + mip_offset, mip_size);
-            if (image.mip_hashes[m] == hash) {
+        const u32 extent_width = mip_pitch ? std::min(mip_pitch, width) : width;
+        const u32 extent_height = mip_height ? std::min(mip_height, height) : height;
+        u32 first_row = 0;
+        u32 end_row = extent_height;
+
+        if (check_hashes) {
+            const u64 first_page = mip_offset / Image::HashPageSize;
+            const u64 end_page = Common::DivCeil(mip_offset + mip_size, Image::HashPageSize);
+            u64 first_changed = end_page;
+            u64 last_changed = end_page;
+            for (u64 page = first_page; page < end_page; ++page) {
+                if (changed_pages[page]) {
+                    first_changed = std::min(first_changed, page);
+                    last_changed = page;
+                }
+            }
+            if (first_changed == end_page) {
                 continue;
             }
-            image.mip_hashes[m] = hash;
+            const u64 row_bytes = u64(mip_pitch) * image.info.num_bits / 8;
+            if (can_upload_rows && row_bytes != 0) {
+                const u64 begin = first_changed * Image::HashPageSize;
+                const u64 end = (last_changed + 1) * Image::HashPageSize;
+                first_row = u32(
+                    std::min<u64>((std::max(begin, mip_offset) - mip_offset) / row_bytes, end_row));
+                end_row = u32(std::min<u64>(
+                    Common::DivCeil(std::min(end, mip_offset + mip_size) - mip_offset, row_bytes),
+                    end_row));
+                if (first_row == end_row) {
+                    continue;
+                }
+            }
         }
 
-        const u32 extent_width = mip_pitch ? std::min(mip_pitch, width) : width;
-        const u32 extent_height = mip_height ? std::min(mip_height, height) : height;
         image_copies.push_back({
-            .bufferOffset = mip_offset,
+            .bufferOffset = mip_offset + first_row * u64(mip_pitch) * image.info.num_bits / 8,
             .bufferRowLength = mip_pitch,
             .bufferImageHeight = mip_height,
             .imageSubresource{
@@ -699,8 +742,8 @@ void TextureCache::RefreshImage(Image& image) {
                 .baseArrayLayer = 0,
                 .layerCount = num_layers,
             },
-            .imageOffset = {0, 0, 0},
-            .imageExtent = {extent_width, extent_height, depth},
+            .imageOffset = {0, s32(first_row), 0},
+            .imageExtent = {extent_width, end_row - first_row, depth},
         });
     }
 
@@ -711,6 +754,19 @@ void TextureCache::RefreshImage(Image& image) {
 
     scheduler.EndRendering();
 
+    // Small tiled images are cheaper to detile on the CPU than to stage, dispatch and barrier
+    // around a compute pass. Memory written by the GPU has to go through the buffer cache.
+    if (image.info.props.is_tiled && image.info.guest_size <= MaxCpuDetileSize &&
+        IsCpuDetileSupported(image.info) &&
+        !buffer_cache.IsRegionGpuModified(image.info.guest_address, image.info.guest_size)) {
+        const auto [buffer, offset] = tile_manager.DetileImageCpu(image.info);
+        for (auto& copy : image_copies) {
+            copy.bufferOffset += offset;
+        }
+        image.Upload(image_copies, buffer, offset);
+        return;
+    }
+
     const auto [in_buffer, in_offset] =
         buffer_cache.ObtainBufferForImage(image.info.guest_address, image.info.guest_size);
     if (auto barrier = in_buffer->GetBarrier(vk::AccessFlagBits2::eTransferRead,
@@ -840,6 +896,7 @@ void TextureCache::UntrackImage(ImageId image_id) {
     image.track_addr = 0;
     image.track_addr_end = 0;
     if (size != 0) {
+        image.MarkPagesCpuDirty(addr, size);
         tracker.UpdatePageWatchers<false>(addr, size);
     }
 }
@@ -859,6 +916,7 @@ void TextureCache::UntrackImageHead(ImageId image_id) {
         // Cehck its hash later.
         MarkAsMaybeDirty(image_id, image);
     }
+    image.MarkPagesCpuDirty(image_begin, size);
     tracker.UpdatePageWatchers<false>(image_begin, size);
 }
 
@@ -878,6 +936,7 @@ void TextureCache::UntrackImageTail(ImageId image_id) {
         // Cehck its hash later.
         MarkAsMaybeDirty(image_id, image);
     }
+    image.MarkPagesCpuDirty(addr, size);
     tracker.UpdatePageWatchers<false>(addr, size);
 }
 
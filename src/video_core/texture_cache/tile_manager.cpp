@@ -1,10 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "core/memory.h"
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
+#include "video_core/texture_cache/cpu_detiler.h"
 #include "video_core/texture_cache/image.h"
 #include "video_core/texture_cache/image_info.h"
 #include "video_core/texture_cache/image_view.h"
@@ -241,6 +243,18 @@ TileManager::Result TileManager::DetileImage(vk::Buffer in_buffer, u32 in_offset
     return {out_buffer, 0};
 }
 
+TileManager::Result TileManager::DetileImageCpu(const ImageInfo& info) {
+    // Fetch through the memory manager so unmapped pages of sparse images read as zero.
+    cpu_detile_scratch.resize(info.guest_size);
+    Core::Memory::Instance()->CopySparseMemory(info.guest_address, cpu_detile_scratch.data(),
+                                               info.guest_size);
+
+    const auto [data, offset] = stream_buffer.Map(info.guest_size, 16);
+    VideoCore::DetileImageCpu(info, cpu_detile_scratch.data(), data);
+    stream_buffer.Commit();
+    return {stream_buffer.Handle(), static_cast<u32>(offset)};
+}
+
 void TileManager::TileImage(Image& in_image, std::span<vk::BufferImageCopy> buffer_copies,
                             vk::Buffer out_buffer, u32 out_offset, u32 copy_size) {
     const auto& info = in_image.info;
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/types.h"
 #include "video_core/amdgpu/tiling.h"
 #include "video_core/buffer_cache/buffer.h"
@@ -29,6 +31,9 @@ public:
 
     Result DetileImage(vk::Buffer in_buffer, u32 in_offset, const ImageInfo& info);
 
+    /// Detiles the guest memory of the image on the CPU straight into the stream buffer.
+    Result DetileImageCpu(const ImageInfo& info);
+
 private:
     vk::Pipeline GetTilingPipeline(const ImageInfo& info, bool is_tiler);
     ScratchBuffer GetScratchBuffer(u32 size);
@@ -41,6 +46,7 @@ private:
     vk::UniquePipelineLayout pl_layout;
     std::array<vk::UniquePipeline, AmdGpu::NUM_TILE_MODES * NUM_BPPS> detilers{};
     std::array<vk::UniquePipeline, AmdGpu::NUM_TILE_MODES * NUM_BPPS> tilers{};
+    std::vector<u8> cpu_detile_scratch;
 };
 
 } // namespace VideoCore
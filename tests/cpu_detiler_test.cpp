@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "video_core/amdgpu/tiling.h"
+#include "video_core/texture_cache/cpu_detiler.h"
+#include "video_core/texture_cache/image_info.h"
+
+// Checks that every CPU detiler variant produces the same linear image as the per texel
+// reference for all tiled modes and bit depths it accepts.
+
+using namespace VideoCore;
+
+namespace {
+
+constexpr std::array Variants = {
+    CpuDetileVariant::Scalar,
+    CpuDetileVariant::Sse,
+    CpuDetileVariant::Avx2,
+};
+
+constexpr std::array<const char*, 3> VariantNames = {"scalar", "sse", "avx2"};
+
+struct MipExtent {
+    u32 pitch;
+    u32 height;
+};
+
+/// Whole micro tiles for the tiled fast path, then a mip that is not a multiple of a micro
+/// tile and a mip with a trailing partial slice to hit the per texel fallbacks.
+constexpr std::array<MipExtent, 3> Mips = {{{256, 128}, {128, 64}, {12, 4}}};
+constexpr u32 NumSlices = 8;
+
+ImageInfo MakeImageInfo(AmdGpu::TileMode tile_mode, u32 num_bits, u8 bank_swizzle,
+                        bool truncate) {
+    ImageInfo info{};
+    info.props.is_tiled = 1;
+    info.num_bits = num_bits;
+    info.tile_mode = tile_mode;
+    info.array_mode = AmdGpu::GetArrayMode(tile_mode);
+    info.bank_swizzle = bank_swizzle;
+    info.resources.levels = Mips.size();
+    const u32 bytes_per_pixel = num_bits / 8;
+    u32 offset = 0;
+    for (u32 m = 0; m < Mips.size(); ++m) {
+        const auto [pitch, height] = Mips[m];
+        u32 size = pitch * height * NumSlices * bytes_per_pixel;
+        if (m == 1) {
+            size += 3 * bytes_per_pixel;
+        }
+        info.mips_layout.push_back({size, pitch, height, offset});
+        offset += size;
+    }
+    // A short guest image makes the last tiles read past its end, which must come out as zero.
+    info.guest_size = truncate ? offset - offset / 8 : offset;
+    return info;
+}
+
+} // Anonymous namespace
+
+int main() {
+    std::mt19937 rng{0x5ad};
+    u32 num_checks = 0;
+    u32 num_failures = 0;
+    for (u32 mode = 0; mode < AmdGpu::NUM_TILE_MODES; ++mode) {
+        const auto tile_mode = static_cast<AmdGpu::TileMode>(mode);
+        if (AmdGpu::NameOf(tile_mode).empty()) {
+            continue;
+        }
+        for (const u32 num_bits : {8U, 16U, 32U, 64U, 128U}) {
+            for (const bool truncate : {false, true}) {
+                const auto info = MakeImageInfo(tile_mode, num_bits, rng() & 3, truncate);
+                if (!IsCpuDetileSupported(info)) {
+                    continue;
+                }
+                u32 linear_size = 0;
+                for (const auto& mip : info.mips_layout) {
+                    linear_size += mip.size;
+                }
+                std::vector<u8> tiled(info.guest_size);
+                for (auto& byte : tiled) {
+                    byte = static_cast<u8>(rng());
+                }
+                std::vector<u8> expected(linear_size, 0xCD);
+                DetileImageCpuReference(info, tiled.data(), expected.data());
+
+                for (u32 v = 0; v < Variants.size(); ++v) {
+                    if (Variants[v] > DefaultCpuDetileVariant) {
+                        continue;
+                    }
+                    std::vector<u8> linear(linear_size, 0xCD);
+                    DetileImageCpu(info, tiled.data(), linear.data(), Variants[v]);
+                    ++num_checks;
+                    if (linear != expected) {
+                        ++num_failures;
+                        std::fprintf(stderr, "%s mismatch: %s, %ubpp%s\n", VariantNames[v],
+                                     AmdGpu::NameOf(tile_mode).data(), num_bits,
+                                     truncate ? ", truncated" : "");
+                    }
+                }
+            }
+        }
+    }
+    std::printf("%u of %u detiles matched the reference\n", num_checks - num_failures,
+                num_checks);
+    return num_failures == 0 && num_checks != 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/io_file.h"
+#include "core/file_sys/fs.h"
+
+// Measures open/read/close throughput across threads the way the kernel file calls drive the
+// handle table, once for descriptors alone and once with small host files behind them.
+//
+// Usage: file_handle_bench [num_threads] [ops_per_thread]
+
+using namespace Core::FileSys;
+
+namespace {
+
+constexpr u32 NumFiles = 64;
+constexpr u32 FileSize = 4096;
+
+/// Descriptor allocation, lookup and release without any host I/O.
+void RunHandles(HandleTable& table, u32 num_ops) {
+    for (u32 i = 0; i < num_ops; ++i) {
+        const int fd = table.CreateHandle();
+        table.GetFile(fd)->is_opened = true;
+        table.GetFile(fd)->is_opened = false;
+        table.DeleteHandle(fd);
+    }
+}
+
+/// Opens a mounted guest path, reads it whole and closes it.
+void RunFiles(HandleTable& table, MntPoints& mnt, u32 thread_idx, u32 num_ops) {
+    std::array<u8, FileSize> buffer;
+    for (u32 i = 0; i < num_ops; ++i) {
+        const int fd = table.CreateHandle();
+        {
+            auto file = table.GetFile(fd);
+            file->m_guest_name = fmt::format("/app0/file_{}.bin", (thread_idx + i) % NumFiles);
+            file->m_host_name = mnt.GetHostPath(file->m_guest_name);
+            file->f.Open(file->m_host_name, Common::FS::FileAccessMode::Read);
+            file->is_opened = true;
+        }
+        {
+            auto file = table.GetFile(fd);
+            std::scoped_lock lk{file->m_mutex};
+            if (file->f.ReadRaw<u8>(buffer.data(), buffer.size()) != buffer.size()) {
+                std::fprintf(stderr, "Short read of %s\n", file->m_guest_name.c_str());
+                std::abort();
+            }
+        }
+        {
+            auto file = table.GetFile(fd);
+            file->f.Close();
+            file->is_opened = false;
+        }
+        table.DeleteHandle(fd);
+    }
+}
+
+template <typename Func>
+double Measure(u32 num_threads, u32 num_ops, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        for (u32 t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&func, t] { func(t); });
+        }
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return num_threads * num_ops / seconds;
+}
+
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+    const u32 max_threads =
+        argc > 1 ? std::atoi(argv[1]) : std::max(std::thread::hardware_concurrency(), 1U);
+    const u32 num_ops = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    const auto dir = std::filesystem::temp_directory_path() / "file_handle_bench";
+    std::filesystem::create_directories(dir);
+    const std::vector<u8> contents(FileSize, 0x5a);
+    for (u32 i = 0; i < NumFiles; ++i) {
+        const Common::FS::IOFile file{dir / fmt::format("file_{}.bin", i),
+                                      Common::FS::FileAccessMode::Write};
+        file.WriteSpan(std::span{contents});
+    }
+    MntPoints mnt;
+    mnt.Mount(dir, "/app0", true);
+
+    for (u32 num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        HandleTable table;
+        const double handles = Measure(num_threads, num_ops, [&](u32) {
+            RunHandles(table, num_ops);
+        });
+        const double files = Measure(num_threads, num_ops, [&](u32 t) {
+            RunFiles(table, mnt, t, num_ops);
+        });
+        std::printf("%2u threads: %10.0f handle open/close/s %10.0f file open/read/close/s\n",
+                    num_threads, handles, files);
+    }
+
+    mnt.UnmountAll();
+    std::filesystem::remove_all(dir);
+    return 0;
+}
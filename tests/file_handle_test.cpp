@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "core/file_sys/fs.h"
+
+// Checks that a file returned by HandleTable::GetFile is never recycled while it is held, even
+// when its descriptor is closed and handed out again by other threads at the same time.
+
+using namespace Core::FileSys;
+
+namespace {
+
+u32 num_failures = 0;
+
+void Check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "%s\n", what);
+        ++num_failures;
+    }
+}
+
+/// Closing a descriptor that is still referenced must give the next open a different file.
+void TestCloseWhileHeld() {
+    HandleTable table;
+    const int first = table.CreateHandle();
+    const int fd = table.CreateHandle();
+    auto held = table.GetFile(fd);
+    held->m_guest_name = "/app0/held";
+    table.DeleteHandle(fd);
+    Check(table.GetFile(fd) == nullptr, "Closed descriptor still resolves");
+
+    const int reused = table.CreateHandle();
+    Check(reused == fd, "Closed descriptor was not reused first");
+    auto reopened = table.GetFile(reused);
+    Check(reopened.get() != held.get(), "Reused descriptor got a file that is still held");
+    Check(reopened->m_guest_name.empty(), "Reused descriptor got a file that was not cleared");
+    Check(held->m_guest_name == "/app0/held", "Held file was cleared while referenced");
+    Check(table.GetFileDescriptor(held) == fd, "Held file lost its descriptor");
+    table.DeleteHandle(reused);
+    table.DeleteHandle(first);
+}
+
+/// Readers keep looking up one descriptor while a writer closes and reopens it.
+void TestLookupRacingReuse() {
+    constexpr u32 NumReaders = 4;
+    constexpr u32 NumReopens = 200000;
+
+    HandleTable table;
+    // Keep the raced descriptor away from zero, which GetFileDescriptor also uses for errors.
+    const int padding = table.CreateHandle();
+    const int fd = table.CreateHandle();
+    table.DeleteHandle(fd);
+
+    std::atomic_bool done{};
+    std::atomic<u32> num_stale{};
+    std::atomic<u64> num_hits{};
+    std::vector<std::jthread> readers;
+    for (u32 i = 0; i < NumReaders; ++i) {
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                auto file = table.GetFile(fd);
+                if (file == nullptr) {
+                    continue;
+                }
+                num_hits.fetch_add(1, std::memory_order_relaxed);
+                // A recycled file would have dropped its descriptor.
+                for (u32 j = 0; j < 16; ++j) {
+                    if (table.GetFileDescriptor(file) != fd) {
+                        num_stale.fetch_add(1, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    u32 num_moved = 0;
+    for (u32 i = 0; i < NumReopens; ++i) {
+        const int reopened = table.CreateHandle();
+        num_moved += reopened != fd;
+        table.GetFile(reopened)->is_opened = true;
+        table.DeleteHandle(reopened);
+    }
+    done = true;
+    readers.clear();
+
+    Check(num_moved == 0, "Reopen did not reuse the descriptor just closed");
+    Check(num_stale == 0, "A held file was recycled under its reader");
+    Check(table.GetFile(fd) == nullptr, "Descriptor resolves after its last close");
+    std::printf("%llu lookups hit the raced descriptor\n",
+                static_cast<unsigned long long>(num_hits.load()));
+    table.DeleteHandle(padding);
+}
+
+} // Anonymous namespace
+
+int main() {
+    TestCloseWhileHeld();
+    TestLookupRacingReuse();
+    return num_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "core/libraries/kernel/process.h"
+#include "core/memory.h"
+#include "video_core/renderer_vulkan/vk_rasterizer.h"
+
+// Replays a map/unmap trace against the memory manager and reports the cost of each kind of
+// call. Without a trace file a synthetic one is generated, a pool of direct and flexible
+// mappings that keeps being unmapped, remapped, protected and queried.
+//
+// Usage: memory_trace_bench [trace_file | num_ops]
+//
+// Trace lines, ids name mappings and may be reused once unmapped:
+//   map <id> direct|flexible <size>
+//   protect <id> <prot>
+//   query <id>
+//   unmap <id>
+
+using namespace Core;
+
+namespace Config {
+
+bool isDevKitConsole() {
+    return false;
+}
+
+int getExtraDmemInMbytes() {
+    return 0;
+}
+
+} // namespace Config
+
+namespace Libraries::Kernel {
+
+s32 PS4_SYSV_ABI sceKernelIsNeoMode() {
+    return 0;
+}
+
+} // namespace Libraries::Kernel
+
+namespace {
+
+enum class OpType : u32 {
+    MapDirect,
+    MapFlexible,
+    Protect,
+    Query,
+    Unmap,
+    Count,
+};
+
+constexpr std::array<const char*, static_cast<u32>(OpType::Count)> OpNames = {
+    "map direct", "map flexible", "protect", "query", "unmap",
+};
+
+struct Op {
+    OpType type;
+    u32 id;
+    u64 value;
+};
+
+struct Mapping {
+    VAddr addr = 0;
+    u64 size = 0;
+    PAddr phys_addr = -1;
+};
+
+bool ParseTrace(const char* path, std::vector<Op>& ops) {
+    std::ifstream file{path};
+    if (!file) {
+        std::fprintf(stderr, "Unable to open trace %s\n", path);
+        return false;
+    }
+    std::string line;
+    for (u32 line_num = 1; std::getline(file, line); ++line_num) {
+        std::istringstream stream{line};
+        std::string command;
+        if (!(stream >> command) || command.starts_with('#')) {
+            continue;
+        }
+        Op op{};
+        bool ok = static_cast<bool>(stream >> op.id);
+        if (command == "map") {
+            std::string kind;
+            ok = ok && stream >> kind >> std::hex >> op.value;
+            op.type = kind == "direct" ? OpType::MapDirect : OpType::MapFlexible;
+        } else if (command == "protect") {
+            op.type = OpType::Protect;
+            ok = ok && stream >> std::hex >> op.value;
+        } else if (command == "query") {
+            op.type = OpType::Query;
+        } else if (command == "unmap") {
+            op.type = OpType::Unmap;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "%s:%u: invalid trace line\n", path, line_num);
+            return false;
+        }
+        ops.push_back(op);
+    }
+    return true;
+}
+
+/// Keeps a pool of live mappings of mixed sizes, most operations touch an existing mapping.
+void GenerateTrace(u32 num_ops, std::vector<Op>& ops) {
+    constexpr u32 NumIds = 4096;
+    std::mt19937 rng{0x5ad};
+    std::vector<bool> live(NumIds);
+    while (ops.size() < num_ops) {
+        const u32 id = rng() % NumIds;
+        if (!live[id]) {
+            const bool direct = rng() % 4 != 0;
+            const u64 size = (direct ? 64_KB : 16_KB) << (rng() % 4);
+            ops.push_back({direct ? OpType::MapDirect : OpType::MapFlexible, id, size});
+            live[id] = true;
+            continue;
+        }
+        switch (rng() % 8) {
+        case 0:
+            ops.push_back({OpType::Unmap, id, 0});
+            live[id] = false;
+            break;
+        case 1:
+        case 2:
+            ops.push_back({OpType::Protect, id, rng() % 2 ? 0x3U : 0x1U});
+            break;
+        default:
+            ops.push_back({OpType::Query, id, 0});
+            break;
+        }
+    }
+}
+
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+    std::vector<Op> ops;
+    if (argc > 1 && !std::isdigit(static_cast<unsigned char>(argv[1][0]))) {
+        if (!ParseTrace(argv[1], ops)) {
+            return 1;
+        }
+    } else {
+        GenerateTrace(argc > 1 ? std::atoi(argv[1]) : 200000, ops);
+    }
+
+    auto* memory = Memory::Instance();
+    Vulkan::Rasterizer rasterizer;
+    memory->SetRasterizer(&rasterizer);
+    memory->SetupMemoryRegions(ORBIS_FLEXIBLE_MEMORY_SIZE, false, false);
+
+    std::vector<Mapping> mappings;
+    std::array<std::chrono::steady_clock::duration, OpNames.size()> times{};
+    std::array<u64, OpNames.size()> counts{};
+    u32 num_failures = 0;
+    for (const auto& op : ops) {
+        if (op.id >= mappings.size()) {
+            mappings.resize(op.id + 1);
+        }
+        auto& mapping = mappings[op.id];
+        const bool is_map = op.type == OpType::MapDirect || op.type == OpType::MapFlexible;
+        if (is_map == (mapping.size != 0)) {
+            // The trace reuses an id that is live or touches one that is not, skip it.
+            ++num_failures;
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        s32 result = 0;
+        switch (op.type) {
+        case OpType::MapDirect: {
+            mapping.phys_addr = memory->Allocate(0, memory->GetTotalDirectSize(), op.value,
+                                                 64_KB, 0);
+            if (mapping.phys_addr == -1) {
+                result = -1;
+                break;
+            }
+            void* addr{};
+            result = memory->MapMemory(&addr, 0, op.value, MemoryProt::CpuReadWrite,
+                                       MemoryMapFlags::NoFlags, VMAType::Direct, "direct",
+                                       false, mapping.phys_addr, 64_KB);
+            mapping.addr = std::bit_cast<VAddr>(addr);
+            break;
+        }
+        case OpType::MapFlexible: {
+            void* addr{};
+            result = memory->MapMemory(&addr, 0, op.value, MemoryProt::CpuReadWrite,
+                                       MemoryMapFlags::NoFlags, VMAType::Flexible, "flexible");
+            mapping.addr = std::bit_cast<VAddr>(addr);
+            break;
+        }
+        case OpType::Protect:
+            result =
+                memory->Protect(mapping.addr, mapping.size, static_cast<MemoryProt>(op.value));
+            break;
+        case OpType::Query: {
+            ::Libraries::Kernel::OrbisVirtualQueryInfo info{};
+            result = memory->VirtualQuery(mapping.addr, 0, &info);
+            break;
+        }
+        case OpType::Unmap:
+            result = memory->UnmapMemory(mapping.addr, mapping.size);
+            if (mapping.phys_addr != -1) {
+                memory->Free(mapping.phys_addr, mapping.size);
+            }
+            break;
+        default:
+            break;
+        }
+        const u32 type = static_cast<u32>(op.type);
+        times[type] += std::chrono::steady_clock::now() - start;
+        ++counts[type];
+
+        if (result < 0) {
+            std::fprintf(stderr, "%s of id %u failed: %#x\n", OpNames[type], op.id,
+                         static_cast<u32>(result));
+            ++num_failures;
+            mapping = {};
+        } else if (is_map) {
+            mapping.size = op.value;
+        } else if (op.type == OpType::Unmap) {
+            mapping = {};
+        }
+    }
+
+    for (u32 type = 0; type < OpNames.size(); ++type) {
+        if (counts[type] == 0) {
+            continue;
+        }
+        const double total_us = std::chrono::duration<double, std::micro>(times[type]).count();
+        std::printf("%-13s %8llu calls, %8.3f us per call\n", OpNames[type],
+                    static_cast<unsigned long long>(counts[type]), total_us / counts[type]);
+    }
+    std::printf("%zu ops replayed, %u skipped or failed\n", ops.size(), num_failures);
+    return num_failures == 0 ? 0 : 1;
+}
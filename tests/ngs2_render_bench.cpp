@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numbers>
+#include <vector>
+
+#include "core/libraries/ngs2/ngs2.h"
+#include "core/libraries/ngs2/ngs2_impl.h"
+#include "core/libraries/ngs2/ngs2_mastering.h"
+#include "core/libraries/ngs2/ngs2_sampler.h"
+
+// Renders grains offline with many sampler voices looping a host PCM buffer into a mastering
+// voice, and reports the render cost per grain against the grain's playback time.
+//
+// Usage: ngs2_render_bench [num_voices] [num_grains]
+
+using namespace Libraries::Ngs2;
+
+namespace Core {
+
+// Voice callbacks are never set here, so no guest thread state is needed.
+void EnsureThreadInitialized() {}
+
+} // namespace Core
+
+namespace {
+
+constexpr u32 SampleRate = 48000;
+constexpr u32 NumGrainSamples = 256;
+constexpr u32 NumChannels = 2;
+constexpr u32 NumWaveformFrames = 4800;
+
+template <typename T>
+T MakeParam(u32 id) {
+    T param{};
+    param.header.size = sizeof(T);
+    param.header.id = id;
+    return param;
+}
+
+bool Check(s32 result, const char* what) {
+    if (result < 0) {
+        std::fprintf(stderr, "%s failed: %#x\n", what, static_cast<u32>(result));
+        return false;
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+    const u32 num_voices = argc > 1 ? std::atoi(argv[1]) : 512;
+    const u32 num_grains = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    OrbisNgs2SystemOption system_option{};
+    system_option.size = sizeof(system_option);
+    system_option.maxGrainSamples = NumGrainSamples;
+    system_option.numGrainSamples = NumGrainSamples;
+    system_option.sampleRate = SampleRate;
+    std::vector<u8> system_buffer(0x10000);
+    OrbisNgs2ContextBufferInfo buffer_info{system_buffer.data(), system_buffer.size()};
+    OrbisNgs2Handle system_handle{};
+    if (!Check(SystemSetup(&system_option, &buffer_info, nullptr, &system_handle),
+               "SystemSetup")) {
+        return 1;
+    }
+    auto system = HandleOwner(system_handle, OrbisNgs2HandleType::System);
+
+    OrbisNgs2RackOption mastering_option{};
+    mastering_option.size = sizeof(mastering_option);
+    mastering_option.maxVoices = 1;
+    Ngs2Rack* mastering = nullptr;
+    OrbisNgs2RackOption sampler_option{};
+    sampler_option.size = sizeof(sampler_option);
+    sampler_option.maxVoices = num_voices;
+    sampler_option.maxPorts = 1;
+    Ngs2Rack* sampler = nullptr;
+    if (!Check(RackCreate(*system, ORBIS_NGS2_RACK_ID_MASTERING, &mastering_option, buffer_info,
+                          &mastering),
+               "Mastering RackCreate") ||
+        !Check(RackCreate(*system, ORBIS_NGS2_RACK_ID_SAMPLER, &sampler_option, buffer_info,
+                          &sampler),
+               "Sampler RackCreate")) {
+        return 1;
+    }
+
+    auto master_setup = MakeParam<OrbisNgs2MasteringVoiceSetupParam>(
+        ORBIS_NGS2_MASTERING_VOICE_PARAM_SETUP);
+    master_setup.numInputChannels = NumChannels;
+    auto play = MakeParam<OrbisNgs2VoiceEventParam>(ORBIS_NGS2_VOICE_PARAM_EVENT);
+    play.eventId = ORBIS_NGS2_VOICE_EVENT_PLAY;
+    auto& master_voice = *mastering->voices[0];
+    if (!Check(master_voice.Control(&master_setup.header), "Mastering setup") ||
+        !Check(master_voice.Control(&play.header), "Mastering play")) {
+        return 1;
+    }
+
+    // A 100 ms stereo tone, looped for the whole run.
+    std::vector<s16> waveform(NumWaveformFrames * NumChannels);
+    for (u32 frame = 0; frame < NumWaveformFrames; ++frame) {
+        const float phase = 2.0f * std::numbers::pi_v<float> * 440.0f * frame / SampleRate;
+        waveform[frame * NumChannels] = static_cast<s16>(std::sin(phase) * 8192.0f);
+        waveform[frame * NumChannels + 1] = static_cast<s16>(std::cos(phase) * 8192.0f);
+    }
+    OrbisNgs2WaveformBlock block{};
+    block.dataSize = waveform.size() * sizeof(s16);
+    block.numRepeats = ~0U;
+    block.numSamples = NumWaveformFrames;
+
+    auto setup = MakeParam<OrbisNgs2SamplerVoiceSetupParam>(ORBIS_NGS2_SAMPLER_VOICE_PARAM_SETUP);
+    setup.format.waveformType = ORBIS_NGS2_WAVEFORM_TYPE_PCM_I16L;
+    setup.format.numChannels = NumChannels;
+    setup.format.sampleRate = SampleRate;
+    auto blocks = MakeParam<OrbisNgs2SamplerVoiceWaveformBlocksParam>(
+        ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_BLOCKS);
+    blocks.data = waveform.data();
+    blocks.numBlocks = 1;
+    blocks.aBlock = &block;
+    auto pitch = MakeParam<OrbisNgs2SamplerVoicePitchParam>(ORBIS_NGS2_SAMPLER_VOICE_PARAM_PITCH);
+    auto patch = MakeParam<OrbisNgs2VoicePatchParam>(ORBIS_NGS2_VOICE_PARAM_PATCH);
+    patch.destHandle = master_voice.Handle();
+    for (u32 i = 0; i < num_voices; ++i) {
+        auto& voice = *sampler->voices[i];
+        // Spread the pitches so the voices resample at different steps.
+        pitch.ratio = 0.5f + static_cast<float>(i % 64) / 64.0f;
+        if (!Check(voice.Control(&setup.header), "Sampler setup") ||
+            !Check(voice.Control(&blocks.header), "Sampler blocks") ||
+            !Check(voice.Control(&pitch.header), "Sampler pitch") ||
+            !Check(voice.Control(&patch.header), "Sampler patch") ||
+            !Check(voice.Control(&play.header), "Sampler play")) {
+            return 1;
+        }
+    }
+
+    std::vector<float> output(NumGrainSamples * NumChannels);
+    const OrbisNgs2RenderBufferInfo render_buffer{
+        output.data(), output.size() * sizeof(float), ORBIS_NGS2_WAVEFORM_TYPE_PCM_F32L,
+        NumChannels};
+    // The first grains sort the voices and start the workers, keep them out of the timing.
+    for (u32 i = 0; i < 16; ++i) {
+        system->Render(&render_buffer, 1);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < num_grains; ++i) {
+        if (!Check(system->Render(&render_buffer, 1), "Render")) {
+            return 1;
+        }
+    }
+    const double elapsed_us =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+            .count();
+
+    const double grain_us = NumGrainSamples * 1'000'000.0 / SampleRate;
+    const double render_us = elapsed_us / num_grains;
+    std::printf("%u voices, %u grains: %.1f us per grain, %.1fx realtime\n", num_voices,
+                num_grains, render_us, grain_us / render_us);
+
+    system.reset();
+    return Check(SystemCleanup(system_handle, nullptr), "SystemCleanup") ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/io_file.h"
+#include "common/thread_worker.h"
+#include "shader_recompiler/backend/spirv/emit_spirv.h"
+#include "shader_recompiler/recompiler.h"
+#include "shader_recompiler/shader_dump.h"
+
+// Translates every shader of a dump directory again and reports the cost of each pass and the
+// size of the SPIR-V it produced, to compare recompiler changes on a fixed corpus. Dumps are
+// written by the emulator with shader dumping enabled, each <name>.bin with its <name>.ctx.
+// Tessellation shaders read their constants from guest memory the dump does not keep and are
+// skipped. When spirv-val was found at configure time every module is also validated.
+//
+// The corpus is then translated again on a pool of worker threads without statistics, the way
+// a cache rebuild would, and the throughput is reported for one thread and for num_threads.
+//
+// Usage: shader_corpus <dump_dir> [num_runs] [num_threads]
+
+namespace Config {
+
+// Shaders translated at once may have been dumped with different settings.
+static thread_local bool direct_memory_access = false;
+
+bool dumpShaders() {
+    return false;
+}
+
+bool directMemoryAccess() {
+    return direct_memory_access;
+}
+
+} // namespace Config
+
+namespace {
+
+using namespace Shader;
+
+struct DumpedShader {
+    std::string name;
+    ShaderDumpContext context;
+    std::vector<u32> code;
+};
+
+struct PassTotal {
+    std::string_view name;
+    u64 us;
+};
+
+struct ShaderResult {
+    u64 translate_us{};
+    u64 emit_us{};
+    u32 num_gcn_insts{};
+    u32 num_ir_insts{};
+    size_t spirv_size{};
+};
+
+bool LoadShader(const std::filesystem::path& context_path, DumpedShader& shader) {
+    shader.name = context_path.stem().string();
+    const Common::FS::IOFile code_file{context_path.parent_path() / (shader.name + ".bin"),
+                                       Common::FS::FileAccessMode::Read};
+    if (!shader.context.Load(context_path) || !code_file.IsOpen()) {
+        return false;
+    }
+    shader.code.resize(code_file.GetSize() / sizeof(u32));
+    return code_file.ReadSpan(std::span{shader.code}) == shader.code.size();
+}
+
+/// Translates and emits a shader, per pass timings are added to pass_totals when it is given.
+ShaderResult Translate(const DumpedShader& shader, std::vector<PassTotal>* pass_totals,
+                       std::vector<u32>& spv) {
+    const auto& context = shader.context;
+    const auto& header = context.header;
+    Config::direct_memory_access = header.direct_memory_access;
+
+    // The vertex shader calls its fetch shader through a pointer in user data, point it at
+    // the copy the dump kept.
+    auto user_data = header.user_data;
+    if (!context.fetch_code.empty()) {
+        const u32* fetch_code = context.fetch_code.data();
+        std::memcpy(&user_data[header.fetch_shader_sgpr_base], &fetch_code, sizeof(fetch_code));
+    }
+    const ShaderParams params{user_data, shader.code, header.hash};
+    Info info{header.stage, header.l_stage, params};
+    info.recorded_flat_buf = context.flat_buf;
+    RuntimeInfo runtime_info = header.runtime_info;
+    if (header.stage == Stage::Geometry) {
+        runtime_info.gs_info.vs_copy = context.copy_code;
+    }
+
+    TranslateStats stats;
+    const auto program = TranslateProgram(shader.code, GetThreadPools(), info, runtime_info,
+                                          header.profile, pass_totals ? &stats : nullptr);
+    const auto emit_start = std::chrono::steady_clock::now();
+    Backend::Bindings binding{};
+    spv = Backend::SPIRV::EmitSPIRV(header.profile, runtime_info, program, binding);
+    const auto emit_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - emit_start)
+                             .count();
+
+    if (!pass_totals) {
+        return {};
+    }
+    for (const auto& [step, us] : stats.step_us) {
+        const auto it = std::ranges::find(*pass_totals, step, &PassTotal::name);
+        if (it == pass_totals->end()) {
+            pass_totals->push_back({step, us});
+        } else {
+            it->us += us;
+        }
+    }
+    return {stats.TotalUs(), static_cast<u64>(emit_us), stats.num_gcn_insts, stats.num_ir_insts,
+            spv.size() * sizeof(u32)};
+}
+
+#ifdef SPIRV_VAL
+bool Validate(const std::vector<u32>& spv, u32 spirv_version, const std::string& name) {
+    const auto path = std::filesystem::temp_directory_path() / fmt::format("{}.spv", name);
+    {
+        const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write};
+        file.WriteSpan(std::span<const u32>{spv});
+    }
+    const auto command = fmt::format("\"{}\" --target-env spv{}.{} \"{}\"", SPIRV_VAL,
+                                     (spirv_version >> 16) & 0xff, (spirv_version >> 8) & 0xff,
+                                     path.string());
+    const bool valid = std::system(command.c_str()) == 0;
+    std::filesystem::remove(path);
+    return valid;
+}
+#endif
+
+/// Returns how many shaders per second the pool translates and emits.
+double MeasureThroughput(const std::vector<const DumpedShader*>& shaders, u32 num_threads,
+                         u32 num_runs) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        Common::ThreadWorker worker{num_threads, "ShaderCorpus"};
+        for (u32 run = 0; run < num_runs; ++run) {
+            for (const auto* shader : shaders) {
+                worker.QueueWork([shader] {
+                    std::vector<u32> spv;
+                    Translate(*shader, nullptr, spv);
+                });
+            }
+        }
+        worker.WaitForRequests();
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return shaders.size() * num_runs / seconds;
+}
+
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <dump_dir> [num_runs] [num_threads]\n", argv[0]);
+        return 1;
+    }
+    const std::filesystem::path dump_dir{argv[1]};
+    const u32 num_runs = std::max(argc > 2 ? std::atoi(argv[2]) : 1, 1);
+    const u32 num_threads = argc > 3 ? std::max(std::atoi(argv[3]), 1)
+                                     : std::max(std::thread::hardware_concurrency(), 1U);
+
+    std::vector<std::filesystem::path> contexts;
+    for (const auto& entry : std::filesystem::directory_iterator{dump_dir}) {
+        if (entry.path().extension() == ".ctx") {
+            contexts.push_back(entry.path());
+        }
+    }
+    std::ranges::sort(contexts);
+
+    std::vector<DumpedShader> shaders(contexts.size());
+    std::vector<const DumpedShader*> translated;
+    std::vector<PassTotal> pass_totals;
+    ShaderResult total{};
+    u32 num_skipped = 0;
+    u32 num_failures = 0;
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        auto& shader = shaders[i];
+        if (!LoadShader(contexts[i], shader)) {
+            std::fprintf(stderr, "%s: unreadable dump\n", contexts[i].string().c_str());
+            ++num_failures;
+            continue;
+        }
+        const auto l_stage = shader.context.header.l_stage;
+        if (l_stage == LogicalStage::TessellationControl ||
+            l_stage == LogicalStage::TessellationEval) {
+            ++num_skipped;
+            continue;
+        }
+
+        std::vector<u32> spv;
+        ShaderResult result{};
+        try {
+            for (u32 run = 0; run < num_runs; ++run) {
+                result = Translate(shader, &pass_totals, spv);
+                total.translate_us += result.translate_us;
+                total.emit_us += result.emit_us;
+            }
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s: %s\n", shader.name.c_str(), e.what());
+            ++num_failures;
+            continue;
+        }
+        total.num_gcn_insts += result.num_gcn_insts;
+        total.num_ir_insts += result.num_ir_insts;
+        total.spirv_size += result.spirv_size;
+        translated.push_back(&shader);
+        std::printf("%-48s %6u GCN %7u IR %8zu SPIR-V bytes %8llu us\n", shader.name.c_str(),
+                    result.num_gcn_insts, result.num_ir_insts, result.spirv_size,
+                    static_cast<unsigned long long>(result.translate_us + result.emit_us));
+#ifdef SPIRV_VAL
+        if (!Validate(spv, shader.context.header.profile.supported_spirv, shader.name)) {
+            std::fprintf(stderr, "%s: spirv-val failed\n", shader.name.c_str());
+            ++num_failures;
+        }
+#endif
+    }
+
+    const double runs = num_runs;
+    std::printf("\nPer pass, summed over the corpus and averaged over %u runs:\n", num_runs);
+    for (const auto& [name, us] : pass_totals) {
+        std::printf("  %-32s %10.0f us\n", std::string{name}.c_str(), us / runs);
+    }
+    std::printf("  %-32s %10.0f us\n", "EmitSPIRV", total.emit_us / runs);
+    std::printf("%zu shaders translated, %u skipped, %u failed: %u GCN -> %u IR instructions -> "
+                "%zu SPIR-V bytes in %.0f us\n",
+                translated.size(), num_skipped, num_failures, total.num_gcn_insts,
+                total.num_ir_insts, total.spirv_size,
+                (total.translate_us + total.emit_us) / runs);
+
+    // Only shaders that translated above go through the pool, a failure there would be fatal.
+    if (!translated.empty()) {
+        const double single = MeasureThroughput(translated, 1, num_runs);
+        std::printf("\nThroughput: %.1f shaders/s on 1 thread", single);
+        if (num_threads > 1) {
+            const double parallel = MeasureThroughput(translated, num_threads, num_runs);
+            std::printf(", %.1f shaders/s on %u threads (%.2fx)", parallel, num_threads,
+                        parallel / single);
+        }
+        std::printf("\n");
+    }
+    return num_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/types.h"
+
+// Stands in for the Vulkan rasterizer in tests that link the memory manager without a GPU.
+
+namespace Vulkan {
+
+class Rasterizer {
+public:
+    bool InvalidateMemory(VAddr addr, u64 size) {
+        return false;
+    }
+
+    void MapMemory(VAddr addr, u64 size) {}
+
+    void UnmapMemory(VAddr addr, u64 size) {}
+};
+
+} // namespace Vulkan
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "common/assert.h"
+
+// The tests link single modules without the logging backend. Messages go straight to stderr
+// and failed asserts abort, which is all ctest needs to report them.
+
+namespace Common::Log {
+
+bool CanLog(Class log_class, Level log_level) {
+    return log_level >= Level::Warning;
+}
+
+void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                       unsigned int line_num, const char* function, const char* format,
+                       const fmt::format_args& args) {
+    std::fprintf(stderr, "%s:%u %s: %s\n", filename, line_num, function,
+                 fmt::vformat(format, args).c_str());
+}
+
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            std::span<const LogArg> args) {
+    std::fprintf(stderr, "%s:%u %s: %s\n", filename, line_num, function, format);
+}
+
+} // namespace Common::Log
+
+void assert_fail_impl() {
+    std::abort();
+}
+
+[[noreturn]] void unreachable_impl() {
+    std::abort();
+}